@@ -191,6 +191,34 @@ static inline void Name##_set_##Field(uint8_t *p, Type##_t v)               \
     BITSTREAM_GET(Name, Field, Type, Position, Bits)                        \
     BITSTREAM_SET(Name, Field, Type, Position, Bits)
 
+/*
+ * Extension of wrapping counters (sequence numbers, time stamps) to 64 bits
+ */
+
+/* returns the value of the counter i_value, modulo i_wrap, which is the
+ * closest to the extended value i_last, or 0 if it would be negative */
+static inline uint64_t bitstream_extend(uint64_t i_last, uint64_t i_value,
+                                        uint64_t i_wrap)
+{
+    uint64_t i_delta = (i_value % i_wrap + i_wrap - i_last % i_wrap) % i_wrap;
+
+    if (i_delta < i_wrap / 2)
+        return i_last + i_delta;
+    i_delta = i_wrap - i_delta;
+    return i_last > i_delta ? i_last - i_delta : 0;
+}
+
+/* same for sequence numbers, where i_last == 0 stands for the first packet:
+ * extended values then start at i_wrap + i_value, so that the packets
+ * preceding the first one, if it was reordered, are never clamped */
+static inline uint64_t bitstream_extend_seq(uint64_t i_last, uint64_t i_value,
+                                            uint64_t i_wrap)
+{
+    if (!i_last)
+        return i_wrap + i_value % i_wrap;
+    return bitstream_extend(i_last, i_value, i_wrap);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,8 @@
 #include <bitstream/scte/35.h>
 #include <bitstream/scte/35_print.h>
 
+#include "ts_input.h"
+
 /*****************************************************************************
  * Local declarations
  *****************************************************************************/
@@ -1277,44 +1279,40 @@ int main(int i_argc, char **ppsz_argv)
         break;
     }
 
-    bool b_is_last_invalid = false;
-    while (!feof(stdin) && !ferror(stdin)) {
-        uint8_t p_ts[TS_SIZE];
-        size_t i_ret = fread(p_ts, sizeof(p_ts), 1, stdin);
-        if (i_ret != 1) continue;
-        if (!ts_validate(p_ts)) {
-            if (!b_is_last_invalid) {
-                switch (i_print_type) {
-                case PRINT_XML:
-                    printf("<ERROR type=\"invalid_ts\"/>\n");
-                    break;
-                default:
-                    printf("invalid TS packet\n");
-                }
-                b_is_last_invalid = true;
-            }
+    ts_input_t input;
+    if (!ts_input_open(&input, STDIN_FILENO)) {
+        fprintf(stderr, "couldn't open input\n");
+        exit(EXIT_FAILURE);
+    }
 
-            int i;
-            for (i = 1; i < TS_SIZE; i++) {
-                if (ts_validate(p_ts + i)) {
-                    memmove(p_ts, p_ts + i, TS_SIZE - i);
-                    i_ret = fread(p_ts + TS_SIZE - i, i, 1, stdin);
-                    if (i_ret != 1) continue;
-                    break;
-                }
+    uint8_t *p_packets;
+    size_t i_nb_packets, i_skipped;
+    while ((p_packets = ts_input_read(&input, &i_nb_packets, &i_skipped))
+            != NULL) {
+        size_t n;
+
+        if (i_skipped) {
+            switch (i_print_type) {
+            case PRINT_XML:
+                printf("<ERROR type=\"invalid_ts\"/>\n");
+                break;
+            default:
+                printf("invalid TS packet\n");
             }
-            if (i == TS_SIZE)
-                continue;
         }
 
-        uint16_t i_pid = ts_get_pid(p_ts);
-        ts_pid_t *p_pid = &p_pids[i_pid];
-        if (p_pid->i_psi_refcount)
-            handle_psi_packet(p_ts);
-        p_pid->i_last_cc = ts_get_cc(p_ts);
-        b_is_last_invalid = false;
+        for (n = 0; n < i_nb_packets; n++) {
+            uint8_t *p_ts = p_packets + n * TS_SIZE;
+            uint16_t i_pid = ts_get_pid(p_ts);
+            ts_pid_t *p_pid = &p_pids[i_pid];
+            if (p_pid->i_psi_refcount)
+                handle_psi_packet(p_ts);
+            p_pid->i_last_cc = ts_get_cc(p_ts);
+        }
     }
 
+    ts_input_close(&input);
+
     switch (i_print_type) {
     case PRINT_XML:
         printf("</TS>\n");
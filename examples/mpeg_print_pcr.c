@@ -31,10 +31,13 @@
 #include <inttypes.h>
 #include <string.h>
 #include <stdio.h>
+#include <arpa/inet.h>
 
 #include <bitstream/mpeg/ts.h>
 #include <bitstream/mpeg/psi.h>
 
+#include "ts_input.h"
+
 /*****************************************************************************
  * Local declarations
  *****************************************************************************/
@@ -283,18 +286,36 @@ static void handle_psi_packet(uint8_t *p_ts)
  *****************************************************************************/
 static void usage(const char *psz)
 {
-    fprintf(stderr, "usage: %s < <input file> [> <output>]\n", psz);
+    fprintf(stderr, "usage: %s [<dst addr>][:<dst port>] < <input file> [> <output>]\n", psz);
+    fprintf(stderr, "    (the filter applies to pcap and pcapng captures)\n");
     exit(EXIT_FAILURE);
 }
 
 int main(int i_argc, char **ppsz_argv)
 {
+    uint32_t i_dstaddr = 0;
+    uint16_t i_dstport = 0;
     int i;
 
     if (ppsz_argv[1] != NULL &&
         (!strcmp(ppsz_argv[1], "-h") || !strcmp(ppsz_argv[1], "--help")))
         usage(ppsz_argv[0]);
 
+    if (ppsz_argv[1] != NULL) {
+        char *psz_port = strrchr(ppsz_argv[1], ':');
+        struct in_addr addr;
+
+        if (psz_port != NULL) {
+            *psz_port++ = '\0';
+            i_dstport = strtoul(psz_port, NULL, 0);
+        }
+        if (*ppsz_argv[1]) {
+            if (inet_pton(AF_INET, ppsz_argv[1], &addr) != 1)
+                usage(ppsz_argv[0]);
+            i_dstaddr = ntohl(addr.s_addr);
+        }
+    }
+
     setvbuf(stdout, NULL, _IOLBF, 0);
 
     memset(p_pids, 0, sizeof(p_pids));
@@ -307,11 +328,20 @@ int main(int i_argc, char **ppsz_argv)
 
     p_pids[PAT_PID].i_psi_refcount++;
 
-    while (!feof(stdin) && !ferror(stdin)) {
-        uint8_t p_ts[TS_SIZE];
-        size_t i_ret = fread(p_ts, sizeof(p_ts), 1, stdin);
-        if (i_ret != 1) continue;
-        if (ts_validate(p_ts)) {
+    ts_input_t input;
+    if (!ts_input_open(&input, STDIN_FILENO)) {
+        fprintf(stderr, "couldn't open input\n");
+        exit(EXIT_FAILURE);
+    }
+    ts_input_set_filter(&input, i_dstaddr, i_dstport);
+
+    uint8_t *p_packets;
+    size_t i_nb_packets, i_skipped;
+    while ((p_packets = ts_input_read(&input, &i_nb_packets, &i_skipped))
+            != NULL) {
+        size_t n;
+        for (n = 0; n < i_nb_packets; n++) {
+            uint8_t *p_ts = p_packets + n * TS_SIZE;
             uint16_t i_pid = ts_get_pid(p_ts);
             ts_pid_t *p_pid = &p_pids[i_pid];
             if (p_pid->i_psi_refcount)
@@ -320,5 +350,6 @@ int main(int i_argc, char **ppsz_argv)
         }
     }
 
+    ts_input_close(&input);
     return EXIT_FAILURE;
 }
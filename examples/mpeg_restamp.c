@@ -28,6 +28,8 @@
 /* Limitation: this supposes the PES header is not fragmented over several
  * TS packets, and that the stream is not scrambled. */
 
+#define _GNU_SOURCE
+
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -37,10 +39,13 @@
 #include <stdio.h>
 #include <errno.h>
 #include <time.h>
+#include <sys/uio.h>
 
 #include <bitstream/mpeg/ts.h>
 #include <bitstream/mpeg/pes.h>
 
+#include "udp_input.h"
+
 #define UINT33_MAX UINT64_C(8589934592)
 #define TS_CLOCK_MAX UINT33_MAX
 #define CLOCK_FREQ UINT64_C(90000)
@@ -114,23 +119,103 @@ static uint64_t handle_ts(uint64_t i_ts)
     return i_ts;
 }
 
+/*****************************************************************************
+ * handle_packets:
+ *****************************************************************************/
+static void handle_packets(uint8_t *p_buffer, size_t i_size, uint64_t i_date)
+{
+    uint8_t *p_ts = p_buffer;
+    while (p_ts + TS_SIZE <= p_buffer + i_size && ts_validate(p_ts)) {
+        if (ts_has_adaptation(p_ts) && ts_get_adaptation(p_ts) &&
+            tsaf_has_pcr(p_ts))
+            handle_pcr(p_ts, i_date);
+
+        uint16_t header_size = TS_HEADER_SIZE +
+                               (ts_has_adaptation(p_ts) ? 1 : 0) +
+                               ts_get_adaptation(p_ts);
+        if (ts_get_unitstart(p_ts) && ts_has_payload(p_ts) &&
+            header_size + PES_HEADER_SIZE_PTS <= TS_SIZE &&
+            pes_validate(p_ts + header_size) &&
+            pes_get_streamid(p_ts + header_size) !=
+                PES_STREAM_ID_PRIVATE_2 &&
+            pes_validate_header(p_ts + header_size) &&
+            pes_has_pts(p_ts + header_size) &&
+            pes_validate_pts(p_ts + header_size)) {
+            pes_set_pts(p_ts + header_size,
+                        handle_ts(pes_get_pts(p_ts + header_size)));
+
+            if (header_size + PES_HEADER_SIZE_PTSDTS <= TS_SIZE &&
+                pes_has_dts(p_ts + header_size) &&
+                pes_validate_dts(p_ts + header_size))
+                pes_set_dts(p_ts + header_size,
+                            handle_ts(pes_get_dts(p_ts + header_size)));
+        }
+
+        p_ts += TS_SIZE;
+    }
+}
+
+/*****************************************************************************
+ * Network input
+ *****************************************************************************/
+static void udp_loop(const char *psz_addr)
+{
+    udp_input_t input;
+    struct iovec p_iovecs[UDP_INPUT_BATCH];
+
+    if (!udp_input_open(&input, psz_addr)) {
+        fprintf(stderr, "couldn't open %s\n", psz_addr);
+        exit(EXIT_FAILURE);
+    }
+
+    for ( ; ; ) {
+        udp_datagram_t *p_datagrams;
+        int i, i_iovecs = 0;
+        int i_nb = udp_input_read(&input, &p_datagrams);
+        if (i_nb == -1)
+            exit(EXIT_FAILURE);
+
+        for (i = 0; i < i_nb; i++) {
+            udp_datagram_t *p_datagram = &p_datagrams[i];
+            size_t i_size = p_datagram->i_nb_ts * TS_SIZE;
+            if (!i_size)
+                continue;
+
+            handle_packets(p_datagram->p_ts, i_size,
+                           p_datagram->i_date / 1000 * (CLOCK_FREQ / 10000) / 100);
+            p_iovecs[i_iovecs].iov_base = p_datagram->p_ts;
+            p_iovecs[i_iovecs].iov_len = i_size;
+            i_iovecs++;
+        }
+
+        if (i_iovecs && writev(STDOUT_FILENO, p_iovecs, i_iovecs) == -1 &&
+            errno != EAGAIN && errno != EWOULDBLOCK)
+            exit(EXIT_FAILURE);
+    }
+}
+
 /*****************************************************************************
  * Main loop
  *****************************************************************************/
 static void usage(const char *psz)
 {
     fprintf(stderr, "usage: %s [<mtu>] < <input file> [> <output>]\n", psz);
+    fprintf(stderr, "       %s @<addr>:<port> [> <output>]\n", psz);
     exit(EXIT_FAILURE);
 }
 
 int main(int i_argc, char **ppsz_argv)
 {
     if (i_argc > 2 || i_argc < 1 ||
-        (!strcmp(ppsz_argv[1], "-h") || !strcmp(ppsz_argv[1], "--help")))
+        (ppsz_argv[1] != NULL &&
+         (!strcmp(ppsz_argv[1], "-h") || !strcmp(ppsz_argv[1], "--help"))))
         usage(ppsz_argv[0]);
 
     unsigned int i_mtu = TS_SIZE;
     if (i_argc == 2) {
+        if (ppsz_argv[1][0] == '@')
+            udp_loop(ppsz_argv[1]);
+
         i_mtu = strtoul(ppsz_argv[1], NULL, 0);
         if (!i_mtu)
             usage(ppsz_argv[0]);
@@ -149,35 +234,7 @@ int main(int i_argc, char **ppsz_argv)
         if (!i_read)
             exit(EXIT_SUCCESS);
 
-        uint8_t *p_ts = p_buffer;
-        while (p_ts < p_buffer + i_mtu && ts_validate(p_ts)) {
-            if (ts_has_adaptation(p_ts) && ts_get_adaptation(p_ts) &&
-                tsaf_has_pcr(p_ts))
-                handle_pcr(p_ts, date);
-
-            uint16_t header_size = TS_HEADER_SIZE +
-                                   (ts_has_adaptation(p_ts) ? 1 : 0) +
-                                   ts_get_adaptation(p_ts);
-            if (ts_get_unitstart(p_ts) && ts_has_payload(p_ts) &&
-                header_size + PES_HEADER_SIZE_PTS <= TS_SIZE &&
-                pes_validate(p_ts + header_size) &&
-                pes_get_streamid(p_ts + header_size) !=
-                    PES_STREAM_ID_PRIVATE_2 &&
-                pes_validate_header(p_ts + header_size) &&
-                pes_has_pts(p_ts + header_size) &&
-                pes_validate_pts(p_ts + header_size)) {
-                pes_set_pts(p_ts + header_size,
-                            handle_ts(pes_get_pts(p_ts + header_size)));
-
-                if (header_size + PES_HEADER_SIZE_PTSDTS <= TS_SIZE &&
-                    pes_has_dts(p_ts + header_size) &&
-                    pes_validate_dts(p_ts + header_size))
-                    pes_set_dts(p_ts + header_size,
-                                handle_ts(pes_get_dts(p_ts + header_size)));
-            }
-
-            p_ts += TS_SIZE;
-        }
+        handle_packets(p_buffer, i_mtu, date);
 
         ssize_t i_written = write(STDOUT_FILENO, p_buffer, i_mtu);
         if (i_written == -1) {
@@ -25,6 +25,8 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  *****************************************************************************/
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -34,17 +36,64 @@
 
 #include <bitstream/ietf/rtp.h>
 
+#include "udp_input.h"
+
 /*****************************************************************************
  * Local declarations
  *****************************************************************************/
 #define DEFAULT_PACKET_SIZE 1328
 
+/*****************************************************************************
+ * check_seqnum
+ *****************************************************************************/
+static void check_seqnum(const uint8_t *p_rtp, uint16_t *pi_seqnum)
+{
+    uint16_t i_new_seqnum = rtp_get_seqnum(p_rtp);
+    if (i_new_seqnum != *pi_seqnum)
+        fprintf(stderr, "received packet %hu while expecting %hu\n",
+                i_new_seqnum, *pi_seqnum);
+    *pi_seqnum = (i_new_seqnum + 1) % 65536;
+}
+
+/*****************************************************************************
+ * Network input
+ *****************************************************************************/
+static void udp_loop(const char *psz_addr)
+{
+    udp_input_t input;
+    uint16_t i_seqnum = 0;
+
+    if (!udp_input_open(&input, psz_addr)) {
+        fprintf(stderr, "couldn't open %s\n", psz_addr);
+        exit(EXIT_FAILURE);
+    }
+
+    for ( ; ; ) {
+        udp_datagram_t *p_datagrams;
+        int i;
+        int i_nb = udp_input_read(&input, &p_datagrams);
+        if (i_nb == -1) {
+            fprintf(stderr, "couldn't read\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for (i = 0; i < i_nb; i++) {
+            if (!p_datagrams[i].b_rtp) {
+                fprintf(stderr, "invalid RTP header\n");
+                continue;
+            }
+            check_seqnum(p_datagrams[i].p_buffer, &i_seqnum);
+        }
+    }
+}
+
 /*****************************************************************************
  * Main loop
  *****************************************************************************/
 static void usage(const char *psz)
 {
     fprintf(stderr, "usage: multicat -u -m <packet size> @<addr>:<port> | %s [<packet size>]\n", psz);
+    fprintf(stderr, "       %s @<addr>:<port>\n", psz);
     exit(EXIT_FAILURE);
 }
 
@@ -56,6 +105,9 @@ int main(int i_argc, char **ppsz_argv)
         (!strcmp(ppsz_argv[1], "-h") || !strcmp(ppsz_argv[1], "--help")))
         usage(ppsz_argv[0]);
 
+    if (ppsz_argv[1] != NULL && ppsz_argv[1][0] == '@')
+        udp_loop(ppsz_argv[1]);
+
     if (ppsz_argv[1] != NULL)
         i_packet_size = atoi(ppsz_argv[1]);
     if (i_packet_size > 65535 || i_packet_size < RTP_HEADER_SIZE)
@@ -76,10 +128,6 @@ int main(int i_argc, char **ppsz_argv)
             continue;
         }
 
-        uint16_t i_new_seqnum = rtp_get_seqnum(p_buffer);
-        if (i_new_seqnum != i_seqnum)
-            fprintf(stderr, "received packet %hu while expecting %hu\n",
-                    i_new_seqnum, i_seqnum);
-        i_seqnum = (i_new_seqnum + 1) % 65536;
+        check_seqnum(p_buffer, &i_seqnum);
     }
 }
@@ -0,0 +1,233 @@
+/*****************************************************************************
+ * smpte_291_bench.c: Benchmarks SMPTE 291 parity and checksum computation
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Checks that the table-driven parity, the lane-parallel checksum and
+ * s291_finalize() of smpte/291.h give the same results as a straightforward
+ * bit-by-bit parity and word-by-word checksum, then times both.
+ *
+ * usage: smpte_291_bench [<iterations>]
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <bitstream/smpte/291.h>
+
+/*****************************************************************************
+ * Local declarations
+ *****************************************************************************/
+#define DEFAULT_ITERATIONS  1000000
+#define BENCH_DC            200
+#define CHECK_ROUNDS        16
+#define PACKET_SIZE         (S291_HEADER_SIZE + 255 + S291_FOOTER_SIZE)
+
+static volatile uint32_t i_sink;
+
+/*****************************************************************************
+ * Reference implementation
+ *****************************************************************************/
+static uint16_t ref_parity(uint8_t i_val)
+{
+    uint16_t i_parity = 0;
+    int i;
+    for (i = 0; i < 8; i++)
+        i_parity ^= (i_val >> i) & 1;
+    return i_parity << 8 | (i_parity ^ 1) << 9;
+}
+
+static uint16_t ref_compute_cs(const uint16_t *p_s291)
+{
+    uint16_t i_cs = 0;
+    uint8_t i_dc = p_s291[5] & 0xff;
+    unsigned int i;
+    for (i = 3; i < i_dc + S291_HEADER_SIZE; i++) {
+        i_cs += p_s291[i] & 0x1ff;
+        i_cs &= 0x1ff;
+    }
+    return i_cs | (~i_cs & 0x100) << 1;
+}
+
+static void ref_finalize(uint16_t *p_s291)
+{
+    uint8_t i_dc = p_s291[5] & 0xff;
+    unsigned int i;
+
+    p_s291[0] = S291_ADF1;
+    p_s291[1] = S291_ADF2;
+    p_s291[2] = S291_ADF3;
+    for (i = 3; i < i_dc + S291_HEADER_SIZE; i++)
+        p_s291[i] = (p_s291[i] & 0xff) | ref_parity(p_s291[i] & 0xff);
+    p_s291[i] = ref_compute_cs(p_s291);
+}
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+static uint64_t now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void fill_packet(uint16_t *p_s291, uint8_t i_dc, uint16_t i_mask)
+{
+    unsigned int i;
+    for (i = 3; i < S291_HEADER_SIZE + i_dc; i++)
+        p_s291[i] = rand() & i_mask;
+    p_s291[5] = (p_s291[5] & ~0xff) | i_dc;
+}
+
+static void print_result(const char *psz_name, uint64_t i_ref,
+                         uint64_t i_new, unsigned long i_iterations)
+{
+    printf("%-10s reference %8.1f ns  new %8.1f ns  speedup %.2fx\n",
+           psz_name, (double)i_ref / i_iterations,
+           (double)i_new / i_iterations,
+           i_new ? (double)i_ref / i_new : 0.);
+}
+
+/*****************************************************************************
+ * check
+ *****************************************************************************/
+static bool check(void)
+{
+    uint16_t p_ref[PACKET_SIZE], p_new[PACKET_SIZE];
+    unsigned int i_dc, i;
+    bool b_ok = true;
+
+    for (i = 0; i < 256; i++) {
+        if (s291_parity(i) != ref_parity(i)) {
+            fprintf(stderr, "parity mismatch for 0x%02x\n", i);
+            b_ok = false;
+        }
+    }
+
+    for (i_dc = 0; i_dc < 256; i_dc++) {
+        for (i = 0; i < CHECK_ROUNDS; i++) {
+            fill_packet(p_new, i_dc, 0x3ff);
+            if (s291_compute_cs(p_new) != ref_compute_cs(p_new)) {
+                fprintf(stderr, "checksum mismatch for DC %u\n", i_dc);
+                b_ok = false;
+            }
+
+            fill_packet(p_new, i_dc, 0x3ff);
+            memcpy(p_ref, p_new, sizeof(p_ref));
+            s291_finalize(p_new);
+            ref_finalize(p_ref);
+            if (memcmp(p_new, p_ref, (S291_HEADER_SIZE + i_dc +
+                                      S291_FOOTER_SIZE) * sizeof(uint16_t))) {
+                fprintf(stderr, "finalize mismatch for DC %u\n", i_dc);
+                b_ok = false;
+            }
+        }
+    }
+    return b_ok;
+}
+
+/*****************************************************************************
+ * bench
+ *****************************************************************************/
+static void bench(unsigned long i_iterations)
+{
+    uint16_t p_s291[PACKET_SIZE];
+    uint64_t i_start, i_ref, i_new;
+    unsigned long i;
+
+    i_start = now();
+    for (i = 0; i < i_iterations; i++)
+        i_sink += ref_parity(i);
+    i_ref = now() - i_start;
+    i_start = now();
+    for (i = 0; i < i_iterations; i++)
+        i_sink += s291_parity(i);
+    i_new = now() - i_start;
+    print_result("parity", i_ref, i_new, i_iterations);
+
+    fill_packet(p_s291, BENCH_DC, 0x3ff);
+    i_start = now();
+    for (i = 0; i < i_iterations; i++) {
+        p_s291[6] = i & 0x3ff;
+        i_sink += ref_compute_cs(p_s291);
+    }
+    i_ref = now() - i_start;
+    i_start = now();
+    for (i = 0; i < i_iterations; i++) {
+        p_s291[6] = i & 0x3ff;
+        i_sink += s291_compute_cs(p_s291);
+    }
+    i_new = now() - i_start;
+    print_result("checksum", i_ref, i_new, i_iterations);
+
+    fill_packet(p_s291, BENCH_DC, 0xff);
+    i_start = now();
+    for (i = 0; i < i_iterations; i++) {
+        p_s291[6] = i & 0xff;
+        ref_finalize(p_s291);
+        i_sink += p_s291[S291_HEADER_SIZE + BENCH_DC];
+    }
+    i_ref = now() - i_start;
+    i_start = now();
+    for (i = 0; i < i_iterations; i++) {
+        p_s291[6] = i & 0xff;
+        s291_finalize(p_s291);
+        i_sink += p_s291[S291_HEADER_SIZE + BENCH_DC];
+    }
+    i_new = now() - i_start;
+    print_result("finalize", i_ref, i_new, i_iterations);
+}
+
+/*****************************************************************************
+ * Main loop
+ *****************************************************************************/
+int main(int i_argc, char **ppsz_argv)
+{
+    unsigned long i_iterations = DEFAULT_ITERATIONS;
+
+    if (i_argc > 2) {
+        fprintf(stderr, "usage: %s [<iterations>]\n", ppsz_argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (i_argc == 2)
+        i_iterations = strtoul(ppsz_argv[1], NULL, 0);
+    if (!i_iterations)
+        i_iterations = 1;
+
+    if (!check()) {
+        fprintf(stderr, "results differ from the reference implementation\n");
+        return EXIT_FAILURE;
+    }
+    printf("results identical to the reference implementation\n");
+
+    bench(i_iterations);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,330 @@
+/*****************************************************************************
+ * srt_loopback.c: Exchanges SRT data over loopback with simulated losses
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * A sender (srt_tx.h) and a receiver (srt_rx.h) exchange data, ACK, ACKACK
+ * and NAK packets over two UDP sockets on 127.0.0.1. The sender skips the
+ * first transmission of some packets, including a burst of isolated losses
+ * whose NAKs are ignored, so that it overflows the receiver's loss list,
+ * and the receiver checks that every packet is eventually delivered, in
+ * order and intact.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <bitstream/haivision/srt.h>
+#include <bitstream/haivision/srt_tx.h>
+#include <bitstream/haivision/srt_rx.h>
+
+/*****************************************************************************
+ * Local declarations
+ *****************************************************************************/
+#define DEFAULT_PACKETS     20000
+#define PAYLOAD_SIZE        (7 * 188)
+#define NB_SLOTS            1024
+#define BURST               32
+#define TIMEOUT             20000000 /* us */
+#define ISN                 (0x7fffffff - 5000) /* wraps during the test */
+#define TX_SOCKET_ID        0x1234
+#define RX_SOCKET_ID        0x5678
+
+static uint64_t i_start;
+static srttx_t tx;
+static srttx_slot_t p_tx_slots[NB_SLOTS];
+static srtrx_t rx;
+static srtrx_slot_t p_rx_slots[NB_SLOTS];
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+static uint64_t now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int open_socket(struct sockaddr_in *p_addr)
+{
+    socklen_t i_len = sizeof(struct sockaddr_in);
+    int i_bufsize = 4 * 1024 * 1024;
+    int i_fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (i_fd == -1) {
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+    setsockopt(i_fd, SOL_SOCKET, SO_RCVBUF, &i_bufsize, sizeof(i_bufsize));
+    memset(p_addr, 0, sizeof(struct sockaddr_in));
+    p_addr->sin_family = AF_INET;
+    p_addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(i_fd, (struct sockaddr *)p_addr, i_len) == -1 ||
+        getsockname(i_fd, (struct sockaddr *)p_addr, &i_len) == -1) {
+        perror("bind");
+        exit(EXIT_FAILURE);
+    }
+    return i_fd;
+}
+
+/* isolated losses, plus a burst of more ranges than SRTRX_LOSS_MAX */
+static bool is_lost(uint64_t i_counter)
+{
+    return i_counter % 101 == 7 ||
+           (i_counter >= 5000 && i_counter < 5600 && (i_counter & 1));
+}
+
+/* NAKs are lost during the burst, so that the loss list fills up */
+static bool is_nak_lost(uint64_t i_counter)
+{
+    return i_counter >= 5000 && i_counter < 5800;
+}
+
+/*****************************************************************************
+ * Sender
+ *****************************************************************************/
+static void tx_send(int i_fd, uint64_t *pi_counter, uint64_t i_packets)
+{
+    unsigned int i;
+
+    for (i = 0; i < BURST && *pi_counter < i_packets; i++) {
+        uint8_t *p_packet = malloc(SRT_HEADER_SIZE + PAYLOAD_SIZE);
+        uint8_t *p_payload = p_packet + SRT_HEADER_SIZE;
+
+        memset(p_payload, *pi_counter & 0xff, PAYLOAD_SIZE);
+        memcpy(p_payload, pi_counter, sizeof(uint64_t));
+        if (srttx_output(&tx, p_packet, SRT_HEADER_SIZE + PAYLOAD_SIZE,
+                         now()) != SRTTX_OK) {
+            free(p_packet);
+            return;
+        }
+        if (!is_lost(*pi_counter))
+            send(i_fd, p_packet, SRT_HEADER_SIZE + PAYLOAD_SIZE, 0);
+        (*pi_counter)++;
+    }
+}
+
+static void tx_control(int i_fd, uint64_t i_counter)
+{
+    uint8_t p_buffer[1500];
+    uint8_t *pp_packets[NB_SLOTS];
+    size_t pi_sizes[NB_SLOTS];
+    uint8_t *p_packet;
+    ssize_t i_size;
+    size_t i_psize;
+
+    while ((i_size = recv(i_fd, p_buffer, sizeof(p_buffer),
+                          MSG_DONTWAIT)) > 0) {
+        const uint8_t *p_cif = srt_get_control_packet_cif(p_buffer);
+        size_t i_cif_size = i_size - SRT_HEADER_SIZE;
+        unsigned int i, i_nb;
+
+        if (i_size < SRT_HEADER_SIZE || !srt_get_packet_control(p_buffer))
+            continue;
+        switch (srt_get_control_packet_type(p_buffer)) {
+        case SRT_CONTROL_TYPE_ACK:
+            if (i_cif_size < SRT_ACK_CIF_SIZE_1)
+                break;
+            srttx_ack(&tx, srt_get_ack_last_ack_seq(p_cif));
+            /* answer with an ACKACK carrying the same ACK number */
+            srt_set_control_packet_type(p_buffer, SRT_CONTROL_TYPE_ACKACK);
+            srt_set_packet_timestamp(p_buffer, now() - i_start);
+            srt_set_packet_dst_socket_id(p_buffer, RX_SOCKET_ID);
+            send(i_fd, p_buffer, SRT_HEADER_SIZE, 0);
+            break;
+
+        case SRT_CONTROL_TYPE_NAK:
+            if (is_nak_lost(i_counter))
+                break;
+            i_nb = srttx_nak(&tx, p_cif, i_cif_size, now(), pp_packets,
+                             pi_sizes, NB_SLOTS);
+            /* reorder retransmissions so that ranges get split */
+            for (i = 0; i < i_nb; i += 2)
+                send(i_fd, pp_packets[i], pi_sizes[i], 0);
+            for (i = 1; i < i_nb; i += 2)
+                send(i_fd, pp_packets[i], pi_sizes[i], 0);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    while ((p_packet = srttx_pop(&tx, &i_psize)) != NULL)
+        free(p_packet);
+    if ((i_size = srttx_drop(&tx, now(), p_buffer, sizeof(p_buffer))))
+        send(i_fd, p_buffer, i_size, 0);
+}
+
+/*****************************************************************************
+ * Receiver
+ *****************************************************************************/
+static bool rx_input(int i_fd, uint64_t *pi_delivered)
+{
+    uint8_t p_buffer[1500];
+    uint8_t *p_packet;
+    ssize_t i_size;
+    size_t i_psize;
+
+    for ( ; ; ) {
+        p_packet = malloc(sizeof(p_buffer));
+        i_size = recv(i_fd, p_packet, sizeof(p_buffer), MSG_DONTWAIT);
+        if (i_size <= 0) {
+            free(p_packet);
+            break;
+        }
+
+        if (i_size >= SRT_HEADER_SIZE && srt_get_packet_control(p_packet)) {
+            switch (srt_get_control_packet_type(p_packet)) {
+            case SRT_CONTROL_TYPE_ACKACK:
+                srtrx_ackack(&rx,
+                             srt_get_control_packet_type_specific(p_packet),
+                             now());
+                break;
+            case SRT_CONTROL_TYPE_DROPREQ:
+                srtrx_dropreq(&rx, srt_get_control_packet_cif(p_packet),
+                              i_size - SRT_HEADER_SIZE);
+                break;
+            default:
+                break;
+            }
+            free(p_packet);
+            continue;
+        }
+
+        if (srtrx_input(&rx, p_packet, i_size, now()) != SRTRX_OK)
+            free(p_packet);
+    }
+
+    if ((i_size = srtrx_nak(&rx, now(), p_buffer, sizeof(p_buffer))))
+        send(i_fd, p_buffer, i_size, 0);
+    if ((i_size = srtrx_ack(&rx, now(), p_buffer, sizeof(p_buffer))))
+        send(i_fd, p_buffer, i_size, 0);
+
+    while ((p_packet = srtrx_pop(&rx, &i_psize)) != NULL) {
+        const uint8_t *p_payload = p_packet + SRT_HEADER_SIZE;
+        uint64_t i_counter;
+        unsigned int i;
+        bool b_ok = i_psize == SRT_HEADER_SIZE + PAYLOAD_SIZE;
+
+        if (b_ok) {
+            memcpy(&i_counter, p_payload, sizeof(uint64_t));
+            b_ok = i_counter == *pi_delivered;
+            for (i = sizeof(uint64_t); b_ok && i < PAYLOAD_SIZE; i++)
+                b_ok = p_payload[i] == (i_counter & 0xff);
+        }
+        free(p_packet);
+        if (!b_ok) {
+            fprintf(stderr, "packet %"PRIu64" is corrupted or out of order\n",
+                    *pi_delivered);
+            return false;
+        }
+        (*pi_delivered)++;
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * Main loop
+ *****************************************************************************/
+static void usage(const char *psz)
+{
+    fprintf(stderr, "usage: %s [<number of packets>]\n", psz);
+    exit(EXIT_FAILURE);
+}
+
+int main(int i_argc, char **ppsz_argv)
+{
+    struct sockaddr_in tx_addr, rx_addr;
+    struct pollfd pfd[2];
+    uint64_t i_packets = DEFAULT_PACKETS;
+    uint64_t i_counter = 0, i_delivered = 0;
+    uint8_t *p_packet;
+    size_t i_psize;
+    int i_tx_fd, i_rx_fd;
+
+    if (i_argc > 2)
+        usage(ppsz_argv[0]);
+    if (i_argc == 2 && !(i_packets = strtoull(ppsz_argv[1], NULL, 0)))
+        usage(ppsz_argv[0]);
+
+    i_tx_fd = open_socket(&tx_addr);
+    i_rx_fd = open_socket(&rx_addr);
+    if (connect(i_tx_fd, (struct sockaddr *)&rx_addr, sizeof(rx_addr)) ||
+        connect(i_rx_fd, (struct sockaddr *)&tx_addr, sizeof(tx_addr))) {
+        perror("connect");
+        exit(EXIT_FAILURE);
+    }
+
+    i_start = now();
+    /* nothing is given up: every loss must be recovered */
+    srttx_init(&tx, p_tx_slots, NB_SLOTS, ISN, RX_SOCKET_ID, i_start,
+               TIMEOUT);
+    srtrx_init(&rx, p_rx_slots, NB_SLOTS, ISN, TX_SOCKET_ID, i_start);
+
+    pfd[0].fd = i_tx_fd;
+    pfd[1].fd = i_rx_fd;
+    pfd[0].events = pfd[1].events = POLLIN;
+
+    while (i_delivered < i_packets) {
+        if (now() - i_start > TIMEOUT) {
+            fprintf(stderr, "timeout, %"PRIu64" packets delivered\n",
+                    i_delivered);
+            exit(EXIT_FAILURE);
+        }
+        tx_send(i_tx_fd, &i_counter, i_packets);
+        if (!rx_input(i_rx_fd, &i_delivered))
+            exit(EXIT_FAILURE);
+        tx_control(i_tx_fd, i_counter);
+        poll(pfd, 2, 1);
+    }
+
+    printf("sent %"PRIu64" retransmitted %"PRIu64" lost %"PRIu64
+           " recovered %"PRIu64" duplicate %"PRIu64" skipped %"PRIu64"\n",
+           tx.i_sent, tx.i_retransmitted, rx.i_lost, rx.i_recovered,
+           rx.i_duplicate, rx.i_skipped);
+    if (rx.i_skipped) {
+        fprintf(stderr, "packets were skipped\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while ((p_packet = srttx_pop(&tx, &i_psize)) != NULL)
+        free(p_packet);
+    close(i_tx_fd);
+    close(i_rx_fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,14 @@
+#!/bin/sh
+# Script to test the SRT sender and receiver against each other on loopback
+#
+# License: MIT
+#
+
+make srt_loopback || exit 1
+
+if ./srt_loopback ${1:-20000}; then
+    echo "PASS"
+else
+    echo "FAIL"
+    exit 1
+fi
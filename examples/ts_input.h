@@ -0,0 +1,248 @@
+/*****************************************************************************
+ * ts_input.h: Bulk TS packet input for the examples
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Regular files are mapped in memory and read sequentially, with the kernel
+ * read-ahead hinted a window in advance. Pipes and other descriptors are
+ * read in large blocks. In both cases the caller is handed arrays of
+ * contiguous TS packets, and the input resynchronizes on its own when the
+ * sync byte is lost. Mapped PCAP and PCAPNG captures are recognized, and
+ * the TS packets carried by their UDP or RTP datagrams are handed in place,
+ * optionally filtered on the destination address and port.
+ */
+
+#ifndef __BITSTREAM_EXAMPLES_TS_INPUT_H__
+#define __BITSTREAM_EXAMPLES_TS_INPUT_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <bitstream/mpeg/ts.h>
+#include <bitstream/ietf/pcap.h>
+
+/*****************************************************************************
+ * Local declarations
+ *****************************************************************************/
+#define TS_INPUT_BATCH      1024 /* packets */
+#define TS_INPUT_READAHEAD  (32 * 1024 * 1024)
+
+typedef struct ts_input_t {
+    int i_fd;
+
+    /* regular files */
+    uint8_t *p_map;
+    size_t i_map_size;
+    size_t i_readahead;
+
+    /* captures */
+    bool b_pcap;
+    pcap_reader_t pcap;
+    uint32_t i_dstaddr;
+    uint16_t i_dstport;
+
+    /* pipes */
+    uint8_t *p_buffer;
+    bool b_eof;
+
+    /* current window, either in the map or in the buffer */
+    size_t i_pos, i_end;
+} ts_input_t;
+
+/*****************************************************************************
+ * ts_input_open
+ *****************************************************************************/
+static inline bool ts_input_open(ts_input_t *p_input, int i_fd)
+{
+    struct stat st;
+    off_t i_offset;
+
+    memset(p_input, 0, sizeof(ts_input_t));
+    p_input->i_fd = i_fd;
+
+    if (fstat(i_fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+        (i_offset = lseek(i_fd, 0, SEEK_CUR)) != -1) {
+        /* private writable mapping, so that packets may be altered in place
+         * by the caller without touching the file */
+        void *p_map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE, i_fd, 0);
+        if (p_map != MAP_FAILED) {
+            p_input->p_map = (uint8_t *)p_map;
+            p_input->i_map_size = p_input->i_end = st.st_size;
+            p_input->i_pos = i_offset < st.st_size ? i_offset : st.st_size;
+            p_input->b_pcap = pcap_open(&p_input->pcap, p_input->p_map,
+                                        p_input->i_map_size);
+            madvise(p_map, st.st_size, MADV_SEQUENTIAL);
+#ifdef POSIX_FADV_SEQUENTIAL
+            posix_fadvise(i_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+            return true;
+        }
+    }
+
+    p_input->p_buffer = (uint8_t *)malloc(TS_INPUT_BATCH * TS_SIZE);
+    return p_input->p_buffer != NULL;
+}
+
+/*****************************************************************************
+ * ts_input_set_filter: only keeps datagrams sent to the given address
+ * and port (0 for any) when reading a capture
+ *****************************************************************************/
+static inline void ts_input_set_filter(ts_input_t *p_input,
+                                       uint32_t i_dstaddr, uint16_t i_dstport)
+{
+    p_input->i_dstaddr = i_dstaddr;
+    p_input->i_dstport = i_dstport;
+}
+
+/*****************************************************************************
+ * ts_input_read_pcap: returns the TS packets of the next datagram
+ *****************************************************************************/
+static inline uint8_t *ts_input_read_pcap(ts_input_t *p_input,
+                                          size_t *pi_nb_packets)
+{
+    pcap_packet_t packet;
+    pcap_udp_t udp;
+
+    while (pcap_next(&p_input->pcap, &packet)) {
+        if (pcap_dissect(&packet, &udp) && udp.i_nb_ts &&
+            pcap_filter(&udp, p_input->i_dstaddr, p_input->i_dstport)) {
+            *pi_nb_packets = udp.i_nb_ts;
+            return udp.p_ts;
+        }
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * ts_input_close
+ *****************************************************************************/
+static inline void ts_input_close(ts_input_t *p_input)
+{
+    if (p_input->p_map != NULL)
+        munmap(p_input->p_map, p_input->i_map_size);
+    free(p_input->p_buffer);
+}
+
+/*****************************************************************************
+ * ts_input_fill: refills the pipe buffer, keeping unread data
+ *****************************************************************************/
+static inline void ts_input_fill(ts_input_t *p_input)
+{
+    size_t i_size = TS_INPUT_BATCH * TS_SIZE;
+
+    memmove(p_input->p_buffer, p_input->p_buffer + p_input->i_pos,
+            p_input->i_end - p_input->i_pos);
+    p_input->i_end -= p_input->i_pos;
+    p_input->i_pos = 0;
+
+    while (!p_input->b_eof && p_input->i_end < i_size) {
+        ssize_t i_ret = read(p_input->i_fd, p_input->p_buffer + p_input->i_end,
+                             i_size - p_input->i_end);
+        if (i_ret < 0 && errno == EINTR)
+            continue;
+        if (i_ret <= 0)
+            p_input->b_eof = true;
+        else
+            p_input->i_end += i_ret;
+    }
+}
+
+/*****************************************************************************
+ * ts_input_read
+ *****************************************************************************
+ * Returns an array of *pi_nb_packets TS packets, or NULL at the end of the
+ * input. *pi_skipped is set to the number of bytes skipped to resynchronize
+ * before the returned packets.
+ *****************************************************************************/
+static inline uint8_t *ts_input_read(ts_input_t *p_input,
+                                     size_t *pi_nb_packets, size_t *pi_skipped)
+{
+    uint8_t *p_base;
+    size_t i_pos, i_nb;
+
+    *pi_skipped = 0;
+    if (p_input->b_pcap)
+        return ts_input_read_pcap(p_input, pi_nb_packets);
+
+    for ( ; ; ) {
+        if (p_input->p_map == NULL &&
+            p_input->i_end - p_input->i_pos < TS_INPUT_BATCH * TS_SIZE)
+            ts_input_fill(p_input);
+        p_base = p_input->p_map != NULL ? p_input->p_map : p_input->p_buffer;
+
+        if (p_input->i_end - p_input->i_pos < TS_SIZE) {
+            /* trailing partial packet */
+            p_input->i_pos = p_input->i_end;
+            return NULL;
+        }
+
+        if (ts_validate(p_base + p_input->i_pos))
+            break;
+
+        /* lost sync, look for the next sync byte */
+        uint8_t *p_sync = (uint8_t *)memchr(p_base + p_input->i_pos + 1, TS_SYNC,
+                                            p_input->i_end - p_input->i_pos - 1);
+        size_t i_skip = p_sync != NULL ? (size_t)(p_sync - p_base) - p_input->i_pos :
+                        p_input->i_end - p_input->i_pos;
+        *pi_skipped += i_skip;
+        p_input->i_pos += i_skip;
+    }
+
+    i_pos = p_input->i_pos;
+    for (i_nb = 1; i_nb < TS_INPUT_BATCH; i_nb++) {
+        size_t i_next = i_pos + i_nb * TS_SIZE;
+        if (i_next + TS_SIZE > p_input->i_end ||
+            !ts_validate(p_base + i_next))
+            break;
+    }
+    p_input->i_pos += i_nb * TS_SIZE;
+
+    if (p_input->p_map != NULL && p_input->i_readahead < p_input->i_map_size &&
+        p_input->i_pos + TS_INPUT_READAHEAD > p_input->i_readahead) {
+        /* hint the kernel one window ahead, and drop what is well behind */
+        size_t i_start = p_input->i_readahead;
+        size_t i_size = TS_INPUT_READAHEAD;
+        if (i_start + i_size > p_input->i_map_size)
+            i_size = p_input->i_map_size - i_start;
+        madvise(p_input->p_map + i_start, i_size, MADV_WILLNEED);
+        if (i_start >= 2 * TS_INPUT_READAHEAD)
+            madvise(p_input->p_map + i_start - 2 * TS_INPUT_READAHEAD,
+                    TS_INPUT_READAHEAD, MADV_DONTNEED);
+        p_input->i_readahead = i_start + i_size;
+    }
+
+    *pi_nb_packets = i_nb;
+    return p_base + i_pos;
+}
+
+#endif
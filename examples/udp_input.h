@@ -0,0 +1,295 @@
+/*****************************************************************************
+ * udp_input.h: Batched UDP/RTP input for the examples
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Receives up to UDP_INPUT_BATCH datagrams per system call with recvmmsg(),
+ * each of them time stamped by the kernel (SO_TIMESTAMPNS). Datagrams
+ * carrying RTP are detected and their TS payload is located with
+ * rtp_payload()/rtp_payload_size(), so that the caller is handed arrays of
+ * TS packets whatever the encapsulation. Where recvmmsg() is not available
+ * (or _GNU_SOURCE is not defined), the batch is filled with non-blocking
+ * recvmsg() calls instead.
+ */
+
+#ifndef __BITSTREAM_EXAMPLES_UDP_INPUT_H__
+#define __BITSTREAM_EXAMPLES_UDP_INPUT_H__
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <bitstream/mpeg/ts.h>
+#include <bitstream/ietf/rtp.h>
+
+#if defined(__linux__) && defined(_GNU_SOURCE) && defined(MSG_WAITFORONE)
+#   define UDP_INPUT_MMSG
+#endif
+
+/*****************************************************************************
+ * Local declarations
+ *****************************************************************************/
+#define UDP_INPUT_BATCH     64 /* datagrams */
+#define UDP_INPUT_MTU       2048
+#define UDP_INPUT_RCVBUF    (8 * 1024 * 1024)
+
+typedef struct udp_datagram_t {
+    /* whole datagram */
+    uint8_t *p_buffer;
+    size_t i_size;
+    /* TS packets, after the RTP header if any */
+    uint8_t *p_ts;
+    size_t i_nb_ts;
+    bool b_rtp;
+    bool b_truncated;
+    /* kernel reception date, in nanoseconds (CLOCK_REALTIME) */
+    uint64_t i_date;
+} udp_datagram_t;
+
+typedef struct udp_input_t {
+    int i_fd;
+    uint8_t *p_buffers;
+#ifdef UDP_INPUT_MMSG
+    struct mmsghdr p_msgs[UDP_INPUT_BATCH];
+#else
+    struct msghdr p_msgs[UDP_INPUT_BATCH];
+    size_t pi_sizes[UDP_INPUT_BATCH];
+#endif
+    struct iovec p_iovecs[UDP_INPUT_BATCH];
+    union {
+        size_t align; /* as struct cmsghdr, which C++ forbids here */
+        uint8_t p_buf[CMSG_SPACE(sizeof(struct timespec))];
+    } p_controls[UDP_INPUT_BATCH];
+    udp_datagram_t p_datagrams[UDP_INPUT_BATCH];
+} udp_input_t;
+
+/*****************************************************************************
+ * udp_input_open: opens [@]<addr>:<port>, joining multicast groups
+ *****************************************************************************/
+static inline bool udp_input_open(udp_input_t *p_input, const char *psz_addr)
+{
+    struct sockaddr_in sin;
+    char psz_host[256];
+    const char *psz_port;
+    int i_opt;
+
+    memset(p_input, 0, sizeof(udp_input_t));
+    p_input->i_fd = -1;
+
+    if (*psz_addr == '@')
+        psz_addr++;
+    psz_port = strrchr(psz_addr, ':');
+    if (psz_port == NULL || psz_port - psz_addr >= (ptrdiff_t)sizeof(psz_host))
+        return false;
+    memcpy(psz_host, psz_addr, psz_port - psz_addr);
+    psz_host[psz_port - psz_addr] = '\0';
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(strtoul(psz_port + 1, NULL, 10));
+    if (!*psz_host)
+        sin.sin_addr.s_addr = htonl(INADDR_ANY);
+    else if (inet_pton(AF_INET, psz_host, &sin.sin_addr) != 1)
+        return false;
+
+    if ((p_input->i_fd = socket(AF_INET, SOCK_DGRAM, 0)) == -1)
+        return false;
+
+    i_opt = 1;
+    setsockopt(p_input->i_fd, SOL_SOCKET, SO_REUSEADDR, &i_opt, sizeof(i_opt));
+    setsockopt(p_input->i_fd, SOL_SOCKET, SO_TIMESTAMPNS, &i_opt,
+               sizeof(i_opt));
+    i_opt = UDP_INPUT_RCVBUF;
+    setsockopt(p_input->i_fd, SOL_SOCKET, SO_RCVBUF, &i_opt, sizeof(i_opt));
+
+    if (bind(p_input->i_fd, (struct sockaddr *)&sin, sizeof(sin)) == -1)
+        goto error;
+
+    if (IN_MULTICAST(ntohl(sin.sin_addr.s_addr))) {
+        struct ip_mreq mreq;
+        memset(&mreq, 0, sizeof(mreq));
+        mreq.imr_multiaddr = sin.sin_addr;
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(p_input->i_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                       &mreq, sizeof(mreq)) == -1)
+            goto error;
+    }
+
+    p_input->p_buffers = (uint8_t *)malloc(UDP_INPUT_BATCH * UDP_INPUT_MTU);
+    if (p_input->p_buffers == NULL)
+        goto error;
+    return true;
+
+error:
+    close(p_input->i_fd);
+    p_input->i_fd = -1;
+    return false;
+}
+
+/*****************************************************************************
+ * udp_input_close
+ *****************************************************************************/
+static inline void udp_input_close(udp_input_t *p_input)
+{
+    if (p_input->i_fd != -1)
+        close(p_input->i_fd);
+    free(p_input->p_buffers);
+}
+
+/*****************************************************************************
+ * udp_input_parse: locates TS packets in a datagram
+ *****************************************************************************/
+static inline void udp_input_parse(udp_datagram_t *p_datagram)
+{
+    uint8_t *p_buffer = p_datagram->p_buffer;
+    size_t i_size = p_datagram->i_size;
+
+    p_datagram->b_rtp = false;
+    p_datagram->p_ts = p_buffer;
+    p_datagram->i_nb_ts = 0;
+
+    if (i_size >= TS_SIZE && ts_validate(p_buffer)) {
+        p_datagram->i_nb_ts = i_size / TS_SIZE;
+        return;
+    }
+
+    if (rtp_check_size(p_buffer, i_size) && rtp_check_hdr(p_buffer)) {
+        p_datagram->b_rtp = true;
+        p_datagram->p_ts = rtp_payload(p_buffer);
+        if (rtp_get_type(p_buffer) == RTP_TYPE_TS)
+            p_datagram->i_nb_ts = rtp_payload_size(p_buffer, i_size) / TS_SIZE;
+    }
+}
+
+static inline struct msghdr *udp_input_hdr(udp_input_t *p_input, int i)
+{
+#ifdef UDP_INPUT_MMSG
+    return &p_input->p_msgs[i].msg_hdr;
+#else
+    return &p_input->p_msgs[i];
+#endif
+}
+
+/*****************************************************************************
+ * udp_input_recv: receives a batch of datagrams
+ *****************************************************************************/
+static inline int udp_input_recv(udp_input_t *p_input)
+{
+    int i_nb;
+
+#ifdef UDP_INPUT_MMSG
+    do
+        i_nb = recvmmsg(p_input->i_fd, p_input->p_msgs, UDP_INPUT_BATCH,
+                        MSG_WAITFORONE, NULL);
+    while (i_nb == -1 && errno == EINTR);
+#else
+    for (i_nb = 0; i_nb < UDP_INPUT_BATCH; i_nb++) {
+        ssize_t i_ret;
+        do
+            i_ret = recvmsg(p_input->i_fd, &p_input->p_msgs[i_nb],
+                            i_nb ? MSG_DONTWAIT : 0);
+        while (i_ret == -1 && errno == EINTR);
+        if (i_ret == -1)
+            break;
+        p_input->pi_sizes[i_nb] = i_ret;
+    }
+#endif
+    return i_nb;
+}
+
+/*****************************************************************************
+ * udp_input_read
+ *****************************************************************************
+ * Blocks until at least one datagram is received, and returns the number of
+ * datagrams stored in *pp_datagrams (at most UDP_INPUT_BATCH), or -1 on
+ * error.
+ *****************************************************************************/
+static inline int udp_input_read(udp_input_t *p_input,
+                                 udp_datagram_t **pp_datagrams)
+{
+    int i, i_nb;
+
+    for (i = 0; i < UDP_INPUT_BATCH; i++) {
+        struct msghdr *p_hdr = udp_input_hdr(p_input, i);
+        p_input->p_iovecs[i].iov_base = p_input->p_buffers + i * UDP_INPUT_MTU;
+        p_input->p_iovecs[i].iov_len = UDP_INPUT_MTU;
+        memset(p_hdr, 0, sizeof(struct msghdr));
+        p_hdr->msg_iov = &p_input->p_iovecs[i];
+        p_hdr->msg_iovlen = 1;
+        p_hdr->msg_control = p_input->p_controls[i].p_buf;
+        p_hdr->msg_controllen = sizeof(p_input->p_controls[i].p_buf);
+    }
+
+    i_nb = udp_input_recv(p_input);
+    if (i_nb <= 0)
+        return -1;
+
+    for (i = 0; i < i_nb; i++) {
+        struct msghdr *p_hdr = udp_input_hdr(p_input, i);
+        udp_datagram_t *p_datagram = &p_input->p_datagrams[i];
+        struct cmsghdr *p_cmsg;
+
+        p_datagram->p_buffer = (uint8_t *)p_input->p_iovecs[i].iov_base;
+#ifdef UDP_INPUT_MMSG
+        p_datagram->i_size = p_input->p_msgs[i].msg_len;
+#else
+        p_datagram->i_size = p_input->pi_sizes[i];
+#endif
+        p_datagram->b_truncated = !!(p_hdr->msg_flags & MSG_TRUNC);
+        p_datagram->i_date = 0;
+
+        for (p_cmsg = CMSG_FIRSTHDR(p_hdr); p_cmsg != NULL;
+             p_cmsg = CMSG_NXTHDR(p_hdr, p_cmsg)) {
+            if (p_cmsg->cmsg_level == SOL_SOCKET &&
+                p_cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec ts;
+                memcpy(&ts, CMSG_DATA(p_cmsg), sizeof(ts));
+                p_datagram->i_date = (uint64_t)ts.tv_sec * UINT64_C(1000000000)
+                                      + ts.tv_nsec;
+            }
+        }
+        if (!p_datagram->i_date) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            p_datagram->i_date = (uint64_t)ts.tv_sec * UINT64_C(1000000000)
+                                  + ts.tv_nsec;
+        }
+
+        udp_input_parse(p_datagram);
+    }
+
+    *pp_datagrams = p_input->p_datagrams;
+    return i_nb;
+}
+
+#endif
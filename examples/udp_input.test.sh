@@ -0,0 +1,57 @@
+#!/bin/sh
+# Script to test the batched UDP/RTP input on loopback multicast
+#
+# License: MIT
+#
+
+GROUP=${GROUP:-239.255.42.42}
+PORT=${PORT:-5004}
+NB=1000
+LOST=500
+
+make rtp_check_seqnum mpeg_restamp || exit 1
+
+# sends $NB RTP datagrams of 7 TS packets, sequence number $LOST missing
+send()
+{
+    python3 - "$GROUP" "$PORT" "$NB" "$LOST" <<'PY'
+import socket, struct, sys, time
+group, port, nb, lost = sys.argv[1], int(sys.argv[2]), int(sys.argv[3]), int(sys.argv[4])
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+s.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 0)
+ts = (bytes([0x47, 0x1f, 0xff, 0x10]) + bytes(184)) * 7
+for i in range(nb):
+    if i != lost:
+        s.sendto(struct.pack('>BBHII', 0x80, 33, i, i * 3000, 0x1234) + ts,
+                 (group, port))
+    if i % 32 == 31:
+        time.sleep(0.001)
+PY
+}
+
+ERR=0
+TMP=$(mktemp -d) || exit 1
+
+./rtp_check_seqnum @$GROUP:$PORT 2> $TMP/seqnum &
+PID=$!
+./mpeg_restamp @$GROUP:$PORT > $TMP/restamp &
+PID2=$!
+sleep 1
+send
+sleep 1
+kill $PID $PID2
+
+if [ "$(cat $TMP/seqnum)" != "received packet $((LOST + 1)) while expecting $LOST" ]; then
+    echo "FAIL: rtp_check_seqnum"
+    cat $TMP/seqnum
+    ERR=1
+fi
+if [ "$(wc -c < $TMP/restamp)" -ne $(((NB - 1) * 7 * 188)) ]; then
+    echo "FAIL: mpeg_restamp output is $(wc -c < $TMP/restamp) bytes"
+    ERR=1
+fi
+
+rm -rf $TMP
+[ $ERR -eq 0 ] && echo "PASS"
+exit $ERR
@@ -36,6 +36,7 @@
 #include <stdint.h>   /* uint8_t, uint16_t, etc... */
 #include <string.h>   /* memcpy */
 #include <stdbool.h>
+#include <bitstream/common.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 
@@ -134,6 +135,13 @@ static inline uint32_t srt_get_data_packet_seq(const uint8_t *buf)
     return ((buf[0] & 0x7f) << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
 }
 
+/* returns the extended sequence number of the 31-bit seq closest to last,
+ * or of the first packet if last is 0 (see bitstream_extend_seq()) */
+static inline uint64_t srt_seq_extend(uint64_t last, uint32_t seq)
+{
+    return bitstream_extend_seq(last, seq & 0x7fffffff, UINT64_C(0x80000000));
+}
+
 static inline void srt_set_data_packet_position(uint8_t *buf, uint8_t position)
 {
     buf[4] = (buf[4] & 0x3f) | ((position & 0x3) << 6);
@@ -935,6 +943,25 @@ static inline bool srt_get_nak_range(const uint8_t **p_cif, size_t *p_cif_size,
     return true;
 }
 
+/* writes a NAK entry for packets lost from start_seq, returns its size */
+static inline size_t srt_set_nak_range(uint8_t *cif, uint32_t start_seq, uint32_t packets)
+{
+    cif[0] = (start_seq >> 24) & 0x7f;
+    cif[1] = (start_seq >> 16) & 0xff;
+    cif[2] = (start_seq >>  8) & 0xff;
+    cif[3] =  start_seq & 0xff;
+    if (packets <= 1)
+        return 4;
+
+    uint32_t last_seq = (start_seq + packets - 1) & 0x7fffffff;
+    cif[0] |= 0x80;
+    cif[4] = (last_seq >> 24) & 0x7f;
+    cif[5] = (last_seq >> 16) & 0xff;
+    cif[6] = (last_seq >>  8) & 0xff;
+    cif[7] =  last_seq & 0xff;
+    return 8;
+}
+
 
 /*
    SRT DROPREQ Control Information Field
@@ -968,7 +995,7 @@ static inline void srt_set_dropreq_first_seq(uint8_t *cif, uint32_t first_seq)
 
 static inline uint32_t srt_get_dropreq_first_seq(const uint8_t *cif)
 {
-    return ((cif[0] << 24) & 0x7f) | (cif[1] << 16) | (cif[2] << 8) | cif[3];
+    return ((cif[0] & 0x7f) << 24) | (cif[1] << 16) | (cif[2] << 8) | cif[3];
 }
 
 static inline void srt_set_dropreq_last_seq(uint8_t *cif, uint32_t last_seq)
@@ -981,7 +1008,7 @@ static inline void srt_set_dropreq_last_seq(uint8_t *cif, uint32_t last_seq)
 
 static inline uint32_t srt_get_dropreq_last_seq(const uint8_t *cif)
 {
-    return ((cif[4] << 24) & 0x7f) | (cif[5] << 16) | (cif[6] << 8) | cif[7];
+    return ((cif[4] & 0x7f) << 24) | (cif[5] << 16) | (cif[6] << 8) | cif[7];
 }
 
 
@@ -0,0 +1,382 @@
+/*****************************************************************************
+ * srt_control.h: SRT control packet dispatcher
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * References:
+ *  - SRT Technical Overview
+ *  - draft-sharabayko-srt
+ */
+
+/*
+ * srt_ctrl_parse() validates a control packet and decodes it in a single
+ * pass into a srt_ctrl_t, a tagged union of fixed-size structures selected
+ * by i_type (and i_subtype for SRT_CONTROL_TYPE_USER). Nothing is allocated
+ * nor copied: variable-length fields (key material, stream ID, peer
+ * address...) point into the packet, which must outlive the srt_ctrl_t.
+ */
+
+#ifndef __BITSTREAM_HAIVISION_SRT_CONTROL_H__
+#define __BITSTREAM_HAIVISION_SRT_CONTROL_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/haivision/srt.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SRT_CONTROL_SUBTYPE_HSREQ   1
+#define SRT_CONTROL_SUBTYPE_HSRSP   2
+#define SRT_CONTROL_SUBTYPE_KMREQ   3
+#define SRT_CONTROL_SUBTYPE_KMRSP   4
+
+#define SRT_CTRL_NAK_MAX            128 /* ranges */
+
+typedef struct srt_ctrl_hsreq_t {
+    uint16_t i_major;
+    uint8_t i_minor, i_patch;
+    uint32_t i_flags;
+    uint16_t i_receiver_tsbpd_delay;
+    uint16_t i_sender_tsbpd_delay;
+} srt_ctrl_hsreq_t;
+
+typedef struct srt_ctrl_km_t {
+    /* KMRSP error state if p_km is NULL */
+    uint32_t i_state;
+    const uint8_t *p_km;
+    size_t i_size;
+    uint8_t i_kk, i_cipher, i_auth, i_klen;
+} srt_ctrl_km_t;
+
+typedef struct srt_ctrl_handshake_t {
+    uint32_t i_version;
+    uint16_t i_encryption;
+    uint16_t i_extension;
+    uint32_t i_isn;
+    uint32_t i_mtu;
+    uint32_t i_mfw;
+    uint32_t i_type;
+    uint32_t i_socket_id;
+    uint32_t i_syn_cookie;
+    const uint8_t *p_cif; /* for srt_get_handshake_ip() */
+
+    /* bit mask of (1 << SRT_HANDSHAKE_EXT_TYPE_*) */
+    uint32_t i_extensions;
+    srt_ctrl_hsreq_t hsreq; /* HSREQ or HSRSP */
+    srt_ctrl_km_t km;       /* KMREQ or KMRSP */
+    const uint8_t *p_sid;   /* see srt_ctrl_get_sid() */
+    size_t i_sid_size;
+    const uint8_t *p_congestion;
+    size_t i_congestion_size;
+    const uint8_t *p_filter;
+    size_t i_filter_size;
+    const uint8_t *p_group;
+    size_t i_group_size;
+} srt_ctrl_handshake_t;
+
+typedef struct srt_ctrl_ack_t {
+    /* light ACK: only i_last_ack_seq */
+    bool b_light;
+    uint32_t i_last_ack_seq;
+    uint32_t i_rtt;
+    uint32_t i_rtt_variance;
+    uint32_t i_avail_bufsize;
+    uint32_t i_packets_receiving_rate;
+    uint32_t i_estimated_link_capacity;
+    uint32_t i_receiving_rate;
+} srt_ctrl_ack_t;
+
+typedef struct srt_ctrl_nak_t {
+    unsigned int i_nb_ranges;
+    /* more ranges than SRT_CTRL_NAK_MAX were present */
+    bool b_truncated;
+    struct {
+        uint32_t i_start;
+        uint32_t i_packets;
+    } p_ranges[SRT_CTRL_NAK_MAX];
+} srt_ctrl_nak_t;
+
+typedef struct srt_ctrl_dropreq_t {
+    uint32_t i_first_seq;
+    uint32_t i_last_seq;
+} srt_ctrl_dropreq_t;
+
+typedef struct srt_ctrl_t {
+    uint16_t i_type;
+    uint16_t i_subtype;
+    uint32_t i_type_specific;
+    uint32_t i_timestamp;
+    uint32_t i_dst_socket_id;
+
+    union {
+        srt_ctrl_handshake_t handshake; /* HANDSHAKE */
+        srt_ctrl_ack_t ack;             /* ACK */
+        srt_ctrl_nak_t nak;             /* NAK */
+        srt_ctrl_dropreq_t dropreq;     /* DROPREQ */
+        srt_ctrl_hsreq_t hsreq;         /* USER, HSREQ or HSRSP */
+        srt_ctrl_km_t km;               /* USER, KMREQ or KMRSP */
+    } u;
+} srt_ctrl_t;
+
+static inline uint32_t srt_ctrl_get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static inline bool srt_ctrl_parse_hsreq(const uint8_t *p_ext, size_t i_size,
+                                        srt_ctrl_hsreq_t *p_hsreq)
+{
+    if (i_size < SRT_HANDSHAKE_HSREQ_SIZE)
+        return false;
+    srt_get_handshake_extension_srt_version(p_ext, &p_hsreq->i_major,
+                                            &p_hsreq->i_minor,
+                                            &p_hsreq->i_patch);
+    p_hsreq->i_flags = srt_get_handshake_extension_srt_flags(p_ext);
+    p_hsreq->i_receiver_tsbpd_delay =
+        srt_get_handshake_extension_receiver_tsbpd_delay(p_ext);
+    p_hsreq->i_sender_tsbpd_delay =
+        srt_get_handshake_extension_sender_tsbpd_delay(p_ext);
+    return true;
+}
+
+static inline bool srt_ctrl_parse_km(const uint8_t *p_km, size_t i_size,
+                                     bool b_response, srt_ctrl_km_t *p_ctrl_km)
+{
+    memset(p_ctrl_km, 0, sizeof(srt_ctrl_km_t));
+    if (b_response && i_size == 4) {
+        p_ctrl_km->i_state = srt_ctrl_get32(p_km);
+        return true;
+    }
+    if (!srt_check_km(p_km, i_size))
+        return false;
+    p_ctrl_km->p_km = p_km;
+    p_ctrl_km->i_size = i_size;
+    p_ctrl_km->i_kk = srt_km_get_kk(p_km);
+    p_ctrl_km->i_cipher = srt_km_get_cipher(p_km);
+    p_ctrl_km->i_auth = srt_km_get_auth(p_km);
+    p_ctrl_km->i_klen = srt_km_get_klen(p_km) * 4;
+    return true;
+}
+
+static inline bool srt_ctrl_parse_handshake(const uint8_t *p_cif, size_t i_size,
+                                            srt_ctrl_handshake_t *p_hs)
+{
+    const uint8_t *p_ext;
+
+    if (!srt_check_handshake(p_cif, i_size))
+        return false;
+
+    memset(p_hs, 0, sizeof(srt_ctrl_handshake_t));
+    p_hs->i_version = srt_get_handshake_version(p_cif);
+    p_hs->i_encryption = srt_get_handshake_encryption(p_cif);
+    p_hs->i_extension = srt_get_handshake_extension(p_cif);
+    p_hs->i_isn = srt_get_handshake_isn(p_cif);
+    p_hs->i_mtu = srt_get_handshake_mtu(p_cif);
+    p_hs->i_mfw = srt_get_handshake_mfw(p_cif);
+    p_hs->i_type = srt_get_handshake_type(p_cif);
+    p_hs->i_socket_id = srt_get_handshake_socket_id(p_cif);
+    p_hs->i_syn_cookie = srt_get_handshake_syn_cookie(p_cif);
+    p_hs->p_cif = p_cif;
+
+    if (p_hs->i_version != SRT_HANDSHAKE_VERSION || !p_hs->i_extension ||
+        p_hs->i_extension == SRT_MAGIC_CODE)
+        return true;
+
+    /* extension lengths were checked by srt_check_handshake() */
+    p_ext = p_cif + SRT_HANDSHAKE_CIF_SIZE;
+    i_size -= SRT_HANDSHAKE_CIF_SIZE;
+    while (i_size) {
+        uint16_t i_type = srt_get_handshake_extension_type(p_ext);
+        size_t i_ext_size = 4 * srt_get_handshake_extension_len(p_ext);
+        const uint8_t *p_data = p_ext + SRT_HANDSHAKE_CIF_EXTENSION_MIN_SIZE;
+
+        switch (i_type) {
+        case SRT_HANDSHAKE_EXT_TYPE_HSREQ:
+        case SRT_HANDSHAKE_EXT_TYPE_HSRSP:
+            if (!srt_ctrl_parse_hsreq(p_data, i_ext_size, &p_hs->hsreq))
+                return false;
+            break;
+        case SRT_HANDSHAKE_EXT_TYPE_KMREQ:
+        case SRT_HANDSHAKE_EXT_TYPE_KMRSP:
+            if (!srt_ctrl_parse_km(p_data, i_ext_size,
+                                   i_type == SRT_HANDSHAKE_EXT_TYPE_KMRSP,
+                                   &p_hs->km))
+                return false;
+            break;
+        case SRT_HANDSHAKE_EXT_TYPE_SID:
+            p_hs->p_sid = p_data;
+            p_hs->i_sid_size = i_ext_size;
+            break;
+        case SRT_HANDSHAKE_EXT_TYPE_CONGESTION:
+            p_hs->p_congestion = p_data;
+            p_hs->i_congestion_size = i_ext_size;
+            break;
+        case SRT_HANDSHAKE_EXT_TYPE_FILTER:
+            p_hs->p_filter = p_data;
+            p_hs->i_filter_size = i_ext_size;
+            break;
+        case SRT_HANDSHAKE_EXT_TYPE_GROUP:
+            p_hs->p_group = p_data;
+            p_hs->i_group_size = i_ext_size;
+            break;
+        default:
+            break;
+        }
+        if (i_type < 32)
+            p_hs->i_extensions |= UINT32_C(1) << i_type;
+
+        p_ext = p_data + i_ext_size;
+        i_size -= SRT_HANDSHAKE_CIF_EXTENSION_MIN_SIZE + i_ext_size;
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * srt_ctrl_get_sid
+ *****************************************************************************
+ * Copies the stream ID of a handshake to psz_sid (of size i_size, at least
+ * 1) as a nul-terminated string. The stream ID is sent as little-endian
+ * 32-bit words. Returns false if it was truncated.
+ *****************************************************************************/
+static inline bool srt_ctrl_get_sid(const srt_ctrl_handshake_t *p_hs,
+                                    char *psz_sid, size_t i_size)
+{
+    size_t i;
+
+    for (i = 0; i < p_hs->i_sid_size && i < i_size - 1; i++) {
+        char c = p_hs->p_sid[(i & ~3) + 3 - (i & 3)];
+        if (!c)
+            break;
+        psz_sid[i] = c;
+    }
+    psz_sid[i] = '\0';
+    return i == p_hs->i_sid_size || !p_hs->p_sid[(i & ~3) + 3 - (i & 3)];
+}
+
+/*****************************************************************************
+ * srt_ctrl_parse
+ *****************************************************************************
+ * Decodes the control packet p_buf of size i_size. Returns false if it is
+ * not a valid control packet. Unknown types are accepted with only the
+ * header decoded.
+ *****************************************************************************/
+static inline bool srt_ctrl_parse(const uint8_t *p_buf, size_t i_size,
+                                  srt_ctrl_t *p_ctrl)
+{
+    const uint8_t *p_cif = srt_get_control_packet_cif(p_buf);
+    size_t i_cif_size;
+
+    if (i_size < SRT_HEADER_SIZE || !srt_get_packet_control(p_buf))
+        return false;
+    i_cif_size = i_size - SRT_HEADER_SIZE;
+
+    p_ctrl->i_type = srt_get_control_packet_type(p_buf);
+    p_ctrl->i_subtype = srt_get_control_packet_subtype(p_buf);
+    p_ctrl->i_type_specific = srt_get_control_packet_type_specific(p_buf);
+    p_ctrl->i_timestamp = srt_get_packet_timestamp(p_buf);
+    p_ctrl->i_dst_socket_id = srt_get_packet_dst_socket_id(p_buf);
+
+    switch (p_ctrl->i_type) {
+    case SRT_CONTROL_TYPE_HANDSHAKE:
+        return srt_ctrl_parse_handshake(p_cif, i_cif_size,
+                                        &p_ctrl->u.handshake);
+
+    case SRT_CONTROL_TYPE_ACK: {
+        srt_ctrl_ack_t *p_ack = &p_ctrl->u.ack;
+        memset(p_ack, 0, sizeof(srt_ctrl_ack_t));
+        if (i_cif_size == 4) {
+            p_ack->b_light = true;
+            p_ack->i_last_ack_seq = srt_get_ack_last_ack_seq(p_cif);
+            return true;
+        }
+        if (!srt_check_ack(p_cif, i_cif_size))
+            return false;
+        p_ack->i_last_ack_seq = srt_get_ack_last_ack_seq(p_cif);
+        p_ack->i_rtt = srt_get_ack_rtt(p_cif);
+        p_ack->i_rtt_variance = srt_get_ack_rtt_variance(p_cif);
+        p_ack->i_avail_bufsize = srt_get_ack_avail_bufsize(p_cif);
+        if (i_cif_size >= SRT_ACK_CIF_SIZE_2) {
+            p_ack->i_packets_receiving_rate =
+                srt_get_ack_packets_receiving_rate(p_cif);
+            p_ack->i_estimated_link_capacity =
+                srt_get_ack_estimated_link_capacity(p_cif);
+        }
+        if (i_cif_size >= SRT_ACK_CIF_SIZE_3)
+            p_ack->i_receiving_rate = srt_get_ack_receiving_rate(p_cif);
+        return true;
+    }
+
+    case SRT_CONTROL_TYPE_NAK: {
+        srt_ctrl_nak_t *p_nak = &p_ctrl->u.nak;
+        uint32_t i_start, i_packets;
+        p_nak->i_nb_ranges = 0;
+        p_nak->b_truncated = false;
+        while (srt_get_nak_range(&p_cif, &i_cif_size, &i_start, &i_packets)) {
+            if (p_nak->i_nb_ranges == SRT_CTRL_NAK_MAX) {
+                p_nak->b_truncated = true;
+                break;
+            }
+            p_nak->p_ranges[p_nak->i_nb_ranges].i_start = i_start;
+            p_nak->p_ranges[p_nak->i_nb_ranges].i_packets = i_packets;
+            p_nak->i_nb_ranges++;
+        }
+        /* a malformed entry stops srt_get_nak_range() early */
+        return p_nak->b_truncated || (!i_cif_size && p_nak->i_nb_ranges);
+    }
+
+    case SRT_CONTROL_TYPE_DROPREQ:
+        if (!srt_check_dropreq(p_cif, i_cif_size))
+            return false;
+        p_ctrl->u.dropreq.i_first_seq = srt_get_dropreq_first_seq(p_cif);
+        p_ctrl->u.dropreq.i_last_seq = srt_get_dropreq_last_seq(p_cif);
+        return true;
+
+    case SRT_CONTROL_TYPE_USER:
+        switch (p_ctrl->i_subtype) {
+        case SRT_CONTROL_SUBTYPE_HSREQ:
+        case SRT_CONTROL_SUBTYPE_HSRSP:
+            return srt_ctrl_parse_hsreq(p_cif, i_cif_size, &p_ctrl->u.hsreq);
+        case SRT_CONTROL_SUBTYPE_KMREQ:
+        case SRT_CONTROL_SUBTYPE_KMRSP:
+            return srt_ctrl_parse_km(p_cif, i_cif_size,
+                    p_ctrl->i_subtype == SRT_CONTROL_SUBTYPE_KMRSP,
+                    &p_ctrl->u.km);
+        default:
+            return true;
+        }
+
+    default:
+        return true;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,497 @@
+/*****************************************************************************
+ * srt_rx.h: SRT receiver
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * References:
+ *  - SRT Technical Overview
+ *  - draft-sharabayko-srt
+ */
+
+/*
+ * The receiver core does no I/O: data packets are fed to it with their
+ * reception date (in microseconds), and it writes the ACK and NAK control
+ * packets to send back into buffers supplied by the caller. Like
+ * rtp_reorder.h, data packets are kept in a ring of caller-allocated slots
+ * indexed by the extended sequence number, without being copied, and given
+ * back in order with srtrx_pop(). Missing packets are kept as a sorted list
+ * of ranges, which is what NAK packets carry; a range is reported again
+ * every (RTT + 4 * RTTVar) / 2 until the packets are received or skipped.
+ *
+ * Typical use:
+ *
+ *   i_ret = srtrx_input(&rx, p_packet, i_size, i_now);
+ *   if (i_ret != SRTRX_OK)
+ *       free(p_packet);
+ *   if ((i_nak_size = srtrx_nak(&rx, i_now, p_nak, sizeof(p_nak))))
+ *       send(p_nak, i_nak_size);
+ *   if ((i_ack_size = srtrx_ack(&rx, i_now, p_ack, sizeof(p_ack))))
+ *       send(p_ack, i_ack_size);
+ *   while ((p = srtrx_pop(&rx, &i_psize)) != NULL)
+ *       output(p, i_psize);
+ */
+
+#ifndef __BITSTREAM_HAIVISION_SRT_RX_H__
+#define __BITSTREAM_HAIVISION_SRT_RX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset, memmove */
+#include <bitstream/haivision/srt.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SRTRX_OK                0
+#define SRTRX_LATE              1
+#define SRTRX_DUPLICATE         2
+#define SRTRX_FULL              3
+#define SRTRX_INVALID           4
+
+#define SRTRX_LOSS_MAX          128
+#define SRTRX_ACK_HISTORY       16
+#define SRTRX_ACK_INTERVAL      10000 /* us */
+#define SRTRX_NAK_INTERVAL_MIN  20000 /* us */
+
+typedef struct srtrx_slot_t {
+    uint8_t *p_packet;
+    size_t i_size;
+    uint64_t i_seq;
+    uint64_t i_date;
+} srtrx_slot_t;
+
+typedef struct srtrx_loss_t {
+    uint64_t i_first;
+    uint64_t i_last;
+    uint64_t i_nak_date;
+} srtrx_loss_t;
+
+typedef struct srtrx_t {
+    srtrx_slot_t *p_slots;
+    uint64_t i_mask;
+    uint32_t i_peer_socket_id;
+    uint64_t i_start;
+
+    uint64_t i_next;
+    uint64_t i_highest;
+    uint64_t i_count;
+
+    /* missing packets, sorted */
+    srtrx_loss_t p_losses[SRTRX_LOSS_MAX];
+    unsigned int i_nb_losses;
+
+    /* ACK and RTT */
+    uint32_t i_ack_number;
+    uint64_t i_ack_date;
+    struct {
+        uint32_t i_number;
+        uint64_t i_date;
+    } p_acks[SRTRX_ACK_HISTORY];
+    uint32_t i_rtt, i_rtt_var;
+
+    /* receiving rate over the last ACK interval, and link capacity measured
+     * on probing packet pairs (sequence numbers 16n and 16n + 1) */
+    uint64_t i_rate_packets, i_rate_bytes;
+    uint32_t i_packets_rate, i_bytes_rate;
+    uint64_t i_probe_seq, i_probe_date;
+    uint32_t i_capacity;
+
+    /* statistics */
+    uint64_t i_received;
+    uint64_t i_delivered;
+    uint64_t i_lost;
+    uint64_t i_skipped;
+    uint64_t i_recovered;
+    uint64_t i_late;
+    uint64_t i_duplicate;
+    uint64_t i_nak_sent;
+    uint64_t i_ack_sent;
+} srtrx_t;
+
+/*****************************************************************************
+ * srtrx_init
+ *****************************************************************************
+ * i_nb_slots must be a power of two. i_isn is the initial sequence number
+ * from the handshake, and i_start the date of the connection, from which
+ * the timestamps of control packets are counted.
+ *****************************************************************************/
+static inline void srtrx_init(srtrx_t *p_rx, srtrx_slot_t *p_slots,
+                              uint64_t i_nb_slots, uint32_t i_isn,
+                              uint32_t i_peer_socket_id, uint64_t i_start)
+{
+    memset(p_rx, 0, sizeof(srtrx_t));
+    memset(p_slots, 0, i_nb_slots * sizeof(srtrx_slot_t));
+    p_rx->p_slots = p_slots;
+    p_rx->i_mask = i_nb_slots - 1;
+    p_rx->i_peer_socket_id = i_peer_socket_id;
+    p_rx->i_start = i_start;
+    p_rx->i_next = srt_seq_extend(0, i_isn);
+    p_rx->i_highest = p_rx->i_next - 1;
+    p_rx->i_ack_date = i_start;
+    p_rx->i_rtt = 100000;
+    p_rx->i_rtt_var = 50000;
+}
+
+/* adds lost packets after the highest sequence number */
+static inline void srtrx_loss_add(srtrx_t *p_rx, uint64_t i_first,
+                                  uint64_t i_last)
+{
+    srtrx_loss_t *p_loss;
+
+    if (p_rx->i_nb_losses == SRTRX_LOSS_MAX) {
+        /* merge with the last range, at the cost of reporting packets that
+         * were received in between */
+        p_rx->p_losses[SRTRX_LOSS_MAX - 1].i_last = i_last;
+        return;
+    }
+    p_loss = &p_rx->p_losses[p_rx->i_nb_losses++];
+    p_loss->i_first = i_first;
+    p_loss->i_last = i_last;
+    p_loss->i_nak_date = 0;
+}
+
+/* removes a received packet from the list, returns false if not found */
+static inline bool srtrx_loss_del(srtrx_t *p_rx, uint64_t i_seq)
+{
+    unsigned int i;
+
+    for (i = 0; i < p_rx->i_nb_losses; i++) {
+        srtrx_loss_t *p_loss = &p_rx->p_losses[i];
+        if (i_seq > p_loss->i_last)
+            continue;
+        if (i_seq < p_loss->i_first)
+            return false;
+
+        if (p_loss->i_first == p_loss->i_last) {
+            memmove(p_loss, p_loss + 1,
+                    (--p_rx->i_nb_losses - i) * sizeof(srtrx_loss_t));
+        } else if (i_seq == p_loss->i_first) {
+            p_loss->i_first++;
+        } else if (i_seq == p_loss->i_last) {
+            p_loss->i_last--;
+        } else if (p_rx->i_nb_losses == SRTRX_LOSS_MAX) {
+            /* no room to split the range: merge the two oldest ranges, at
+             * the cost of reporting packets that were received in between,
+             * and try again */
+            p_rx->p_losses[0].i_last = p_rx->p_losses[1].i_last;
+            if (p_rx->p_losses[1].i_nak_date < p_rx->p_losses[0].i_nak_date)
+                p_rx->p_losses[0].i_nak_date = p_rx->p_losses[1].i_nak_date;
+            memmove(p_rx->p_losses + 1, p_rx->p_losses + 2,
+                    (--p_rx->i_nb_losses - 1) * sizeof(srtrx_loss_t));
+            return srtrx_loss_del(p_rx, i_seq);
+        } else {
+            memmove(p_loss + 1, p_loss,
+                    (p_rx->i_nb_losses++ - i) * sizeof(srtrx_loss_t));
+            p_loss->i_last = i_seq - 1;
+            p_loss[1].i_first = i_seq + 1;
+        }
+        return true;
+    }
+    return false;
+}
+
+/* forgets lost packets before i_seq */
+static inline void srtrx_loss_trim(srtrx_t *p_rx, uint64_t i_seq)
+{
+    unsigned int i = 0;
+
+    while (i < p_rx->i_nb_losses && p_rx->p_losses[i].i_last < i_seq)
+        i++;
+    if (i) {
+        p_rx->i_nb_losses -= i;
+        memmove(p_rx->p_losses, p_rx->p_losses + i,
+                p_rx->i_nb_losses * sizeof(srtrx_loss_t));
+    }
+    if (p_rx->i_nb_losses && p_rx->p_losses[0].i_first < i_seq)
+        p_rx->p_losses[0].i_first = i_seq;
+}
+
+/*****************************************************************************
+ * srtrx_input
+ *****************************************************************************
+ * Returns SRTRX_OK if the data packet has been buffered. Otherwise the
+ * caller keeps ownership of the packet: it was late, duplicate, invalid, or
+ * SRTRX_FULL if it is too far ahead, in which case the buffer must be
+ * drained with srtrx_pop() or srtrx_skip() before pushing the packet again.
+ *****************************************************************************/
+static inline int srtrx_input(srtrx_t *p_rx, uint8_t *p_packet,
+                              size_t i_size, uint64_t i_date)
+{
+    srtrx_slot_t *p_slot;
+    uint64_t i_seq;
+
+    if (i_size < SRT_HEADER_SIZE || srt_get_packet_control(p_packet))
+        return SRTRX_INVALID;
+
+    i_seq = srt_seq_extend(p_rx->i_highest,
+                           srt_get_data_packet_seq(p_packet));
+    if (i_seq < p_rx->i_next) {
+        p_rx->i_late++;
+        return SRTRX_LATE;
+    }
+    if (i_seq - p_rx->i_next > p_rx->i_mask)
+        return SRTRX_FULL;
+
+    p_slot = &p_rx->p_slots[i_seq & p_rx->i_mask];
+    if (p_slot->p_packet != NULL) {
+        /* may still be listed if its range was merged with another one */
+        srtrx_loss_del(p_rx, i_seq);
+        p_rx->i_duplicate++;
+        return SRTRX_DUPLICATE;
+    }
+    p_slot->p_packet = p_packet;
+    p_slot->i_size = i_size;
+    p_slot->i_seq = i_seq;
+    p_slot->i_date = i_date;
+    p_rx->i_count++;
+    p_rx->i_received++;
+    p_rx->i_rate_packets++;
+    p_rx->i_rate_bytes += i_size;
+
+    if (i_seq > p_rx->i_highest) {
+        if (i_seq > p_rx->i_highest + 1) {
+            srtrx_loss_add(p_rx, p_rx->i_highest + 1, i_seq - 1);
+            p_rx->i_lost += i_seq - p_rx->i_highest - 1;
+        }
+        p_rx->i_highest = i_seq;
+    } else if (srtrx_loss_del(p_rx, i_seq))
+        p_rx->i_recovered++;
+
+    /* packet pair probing */
+    if (!(i_seq & 0xf)) {
+        p_rx->i_probe_seq = i_seq;
+        p_rx->i_probe_date = i_date;
+    } else if ((i_seq & 0xf) == 1 && p_rx->i_probe_seq == i_seq - 1 &&
+               i_date > p_rx->i_probe_date &&
+               !srt_get_data_packet_retransmit(p_packet)) {
+        uint32_t i_capacity = UINT64_C(1000000) / (i_date - p_rx->i_probe_date);
+        p_rx->i_capacity = p_rx->i_capacity ?
+            (p_rx->i_capacity * 7 + i_capacity) / 8 : i_capacity;
+    }
+    return SRTRX_OK;
+}
+
+/*****************************************************************************
+ * srtrx_pop
+ *****************************************************************************
+ * Returns the next packet in sequence order, or NULL if it has not been
+ * received yet.
+ *****************************************************************************/
+static inline uint8_t *srtrx_pop(srtrx_t *p_rx, size_t *pi_size)
+{
+    srtrx_slot_t *p_slot = &p_rx->p_slots[p_rx->i_next & p_rx->i_mask];
+    uint8_t *p_packet = p_slot->p_packet;
+
+    if (p_packet == NULL || p_slot->i_seq != p_rx->i_next)
+        return NULL;
+    *pi_size = p_slot->i_size;
+    p_slot->p_packet = NULL;
+    p_rx->i_count--;
+    p_rx->i_next++;
+    p_rx->i_delivered++;
+    srtrx_loss_trim(p_rx, p_rx->i_next);
+    return p_packet;
+}
+
+/* returns the slot of the next packet, or NULL */
+static inline const srtrx_slot_t *srtrx_peek(const srtrx_t *p_rx)
+{
+    const srtrx_slot_t *p_slot = &p_rx->p_slots[p_rx->i_next & p_rx->i_mask];
+    return p_slot->p_packet != NULL ? p_slot : NULL;
+}
+
+/*****************************************************************************
+ * srtrx_skip
+ *****************************************************************************
+ * Gives up on the missing packets before i_seq (an extended sequence
+ * number), up to the first packet received, for instance upon a DROPREQ or
+ * when their delivery deadline has passed. Returns the number of packets
+ * skipped.
+ *****************************************************************************/
+static inline uint64_t srtrx_skip(srtrx_t *p_rx, uint64_t i_seq)
+{
+    uint64_t i_skipped = 0;
+
+    while (p_rx->i_next < i_seq && p_rx->i_next <= p_rx->i_highest &&
+           p_rx->p_slots[p_rx->i_next & p_rx->i_mask].p_packet == NULL) {
+        p_rx->i_next++;
+        i_skipped++;
+    }
+    if (p_rx->i_next > p_rx->i_highest && i_seq > p_rx->i_next) {
+        /* packets that were never received */
+        i_skipped += i_seq - p_rx->i_next;
+        p_rx->i_next = i_seq;
+        p_rx->i_highest = i_seq - 1;
+    }
+    srtrx_loss_trim(p_rx, p_rx->i_next);
+    p_rx->i_skipped += i_skipped;
+    return i_skipped;
+}
+
+/*****************************************************************************
+ * srtrx_dropreq
+ *****************************************************************************
+ * Gives up on the packets the sender will not retransmit, from the CIF of a
+ * DROPREQ packet. Returns the number of packets skipped.
+ *****************************************************************************/
+static inline uint64_t srtrx_dropreq(srtrx_t *p_rx, const uint8_t *p_cif,
+                                     size_t i_cif_size)
+{
+    uint64_t i_last;
+
+    if (!srt_check_dropreq(p_cif, i_cif_size))
+        return 0;
+    i_last = srt_seq_extend(p_rx->i_highest, srt_get_dropreq_last_seq(p_cif));
+    if (i_last < p_rx->i_next || i_last - p_rx->i_next > p_rx->i_mask)
+        return 0;
+    return srtrx_skip(p_rx, i_last + 1);
+}
+
+/* writes the header of a control packet */
+static inline void srtrx_control(srtrx_t *p_rx, uint8_t *p_buf,
+                                 uint16_t i_type, uint32_t i_type_specific,
+                                 uint64_t i_now)
+{
+    memset(p_buf, 0, SRT_HEADER_SIZE);
+    srt_set_packet_control(p_buf, true);
+    srt_set_control_packet_type(p_buf, i_type);
+    srt_set_control_packet_type_specific(p_buf, i_type_specific);
+    srt_set_packet_timestamp(p_buf, i_now - p_rx->i_start);
+    srt_set_packet_dst_socket_id(p_buf, p_rx->i_peer_socket_id);
+}
+
+/*****************************************************************************
+ * srtrx_nak
+ *****************************************************************************
+ * Writes a NAK packet for the lost packets due to be reported to p_buf, and
+ * returns its size, or 0 if there is nothing to report.
+ *****************************************************************************/
+static inline size_t srtrx_nak(srtrx_t *p_rx, uint64_t i_now, uint8_t *p_buf,
+                               size_t i_buf_size)
+{
+    uint64_t i_interval = (p_rx->i_rtt + 4 * p_rx->i_rtt_var) / 2;
+    size_t i_size = SRT_HEADER_SIZE;
+    unsigned int i;
+
+    if (i_interval < SRTRX_NAK_INTERVAL_MIN)
+        i_interval = SRTRX_NAK_INTERVAL_MIN;
+    if (i_buf_size < SRT_HEADER_SIZE + 8)
+        return 0;
+
+    for (i = 0; i < p_rx->i_nb_losses &&
+                i_size + 8 <= i_buf_size; i++) {
+        srtrx_loss_t *p_loss = &p_rx->p_losses[i];
+        if (p_loss->i_nak_date && i_now - p_loss->i_nak_date < i_interval)
+            continue;
+        p_loss->i_nak_date = i_now;
+        i_size += srt_set_nak_range(p_buf + i_size,
+                                    p_loss->i_first & 0x7fffffff,
+                                    p_loss->i_last - p_loss->i_first + 1);
+    }
+    if (i_size == SRT_HEADER_SIZE)
+        return 0;
+
+    srtrx_control(p_rx, p_buf, SRT_CONTROL_TYPE_NAK, 0, i_now);
+    p_rx->i_nak_sent++;
+    return i_size;
+}
+
+/* returns the extended sequence number up to which all packets were
+ * received or skipped */
+static inline uint64_t srtrx_get_ack_seq(const srtrx_t *p_rx)
+{
+    if (p_rx->i_nb_losses)
+        return p_rx->p_losses[0].i_first;
+    return p_rx->i_highest + 1;
+}
+
+/*****************************************************************************
+ * srtrx_ack
+ *****************************************************************************
+ * Writes a full ACK packet to p_buf if one is due, and returns its size, or
+ * 0 if none.
+ *****************************************************************************/
+static inline size_t srtrx_ack(srtrx_t *p_rx, uint64_t i_now, uint8_t *p_buf,
+                               size_t i_buf_size)
+{
+    uint64_t i_elapsed = i_now - p_rx->i_ack_date;
+    uint8_t *p_cif = p_buf + SRT_HEADER_SIZE;
+    unsigned int i_index;
+
+    if (i_now < p_rx->i_ack_date || i_elapsed < SRTRX_ACK_INTERVAL ||
+        i_buf_size < SRT_HEADER_SIZE + SRT_ACK_CIF_SIZE_3)
+        return 0;
+
+    p_rx->i_packets_rate = p_rx->i_rate_packets * 1000000 / i_elapsed;
+    p_rx->i_bytes_rate = p_rx->i_rate_bytes * 1000000 / i_elapsed;
+    p_rx->i_rate_packets = p_rx->i_rate_bytes = 0;
+    p_rx->i_ack_date = i_now;
+
+    p_rx->i_ack_number++;
+    i_index = p_rx->i_ack_number % SRTRX_ACK_HISTORY;
+    p_rx->p_acks[i_index].i_number = p_rx->i_ack_number;
+    p_rx->p_acks[i_index].i_date = i_now;
+
+    srtrx_control(p_rx, p_buf, SRT_CONTROL_TYPE_ACK, p_rx->i_ack_number,
+                  i_now);
+    srt_set_ack_last_ack_seq(p_cif, srtrx_get_ack_seq(p_rx) & 0x7fffffff);
+    srt_set_ack_rtt(p_cif, p_rx->i_rtt);
+    srt_set_ack_rtt_variance(p_cif, p_rx->i_rtt_var);
+    srt_set_ack_avail_bufsize(p_cif, p_rx->i_mask + 1 - p_rx->i_count);
+    srt_set_ack_packets_receiving_rate(p_cif, p_rx->i_packets_rate);
+    srt_set_ack_estimated_link_capacity(p_cif, p_rx->i_capacity);
+    srt_set_ack_receiving_rate(p_cif, p_rx->i_bytes_rate);
+    p_rx->i_ack_sent++;
+    return SRT_HEADER_SIZE + SRT_ACK_CIF_SIZE_3;
+}
+
+/*****************************************************************************
+ * srtrx_ackack
+ *****************************************************************************
+ * Updates the RTT from the ACKACK answering one of our ACK packets.
+ *****************************************************************************/
+static inline void srtrx_ackack(srtrx_t *p_rx, uint32_t i_ack_number,
+                                uint64_t i_now)
+{
+    unsigned int i_index = i_ack_number % SRTRX_ACK_HISTORY;
+    uint32_t i_rtt, i_diff;
+
+    if (p_rx->p_acks[i_index].i_number != i_ack_number ||
+        !p_rx->p_acks[i_index].i_date || i_now < p_rx->p_acks[i_index].i_date)
+        return;
+
+    i_rtt = i_now - p_rx->p_acks[i_index].i_date;
+    p_rx->p_acks[i_index].i_date = 0;
+    i_diff = i_rtt > p_rx->i_rtt ? i_rtt - p_rx->i_rtt : p_rx->i_rtt - i_rtt;
+    p_rx->i_rtt_var = (p_rx->i_rtt_var * 3 + i_diff) / 4;
+    p_rx->i_rtt = (p_rx->i_rtt * 7 + i_rtt) / 8;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
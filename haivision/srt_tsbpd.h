@@ -0,0 +1,222 @@
+/*****************************************************************************
+ * srt_tsbpd.h: SRT timestamp-based packet delivery
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * References:
+ *  - SRT Technical Overview
+ *  - draft-sharabayko-srt
+ */
+
+/*
+ * Each data packet carries the sender's timestamp, in microseconds since
+ * the connection start. The first packet maps the sender clock onto the
+ * local one, and a packet is then delivered at the local date of its
+ * timestamp plus the latency negotiated in the handshake (the maximum of
+ * both TSBPD delay fields). Clock drift between both ends is measured on
+ * timestamp/date pairs supplied by the caller, typically the ACKACK packets
+ * which are sent without queuing; the average drift over
+ * SRT_TSBPD_DRIFT_SAMPLES samples is applied to the mapping, and when it
+ * exceeds SRT_TSBPD_DRIFT_MAX the excess is moved to the time base.
+ *
+ * Missing packets whose successor is due are given up (too-late packet
+ * drop), so that delivery keeps a constant delay.
+ *
+ * Typical use, with srt_rx.h:
+ *
+ *   while ((p = srt_tsbpd_pop(&tsbpd, &rx, i_now, &i_size)) != NULL)
+ *       output(p, i_size);
+ *   sleep_until(srt_tsbpd_get_deadline(&tsbpd, &rx));
+ */
+
+#ifndef __BITSTREAM_HAIVISION_SRT_TSBPD_H__
+#define __BITSTREAM_HAIVISION_SRT_TSBPD_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/haivision/srt.h>
+#include <bitstream/haivision/srt_rx.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SRT_TSBPD_DRIFT_SAMPLES 1000
+#define SRT_TSBPD_DRIFT_MAX     5000 /* us */
+
+typedef struct srt_tsbpd_t {
+    uint64_t i_latency;
+
+    bool b_started;
+    uint64_t i_base;
+    uint64_t i_last_timestamp;
+
+    /* drift tracking */
+    int64_t i_drift;
+    int64_t i_drift_sum;
+    unsigned int i_drift_count;
+} srt_tsbpd_t;
+
+/*****************************************************************************
+ * srt_tsbpd_init
+ *****************************************************************************
+ * i_latency is in microseconds, see srt_tsbpd_get_latency().
+ *****************************************************************************/
+static inline void srt_tsbpd_init(srt_tsbpd_t *p_tsbpd, uint64_t i_latency)
+{
+    memset(p_tsbpd, 0, sizeof(srt_tsbpd_t));
+    p_tsbpd->i_latency = i_latency;
+}
+
+/* returns the latency in microseconds from our and the peer's TSBPD
+ * handshake extension */
+static inline uint64_t srt_tsbpd_get_latency(const uint8_t *p_ext_local,
+                                             const uint8_t *p_ext_peer)
+{
+    uint16_t i_rx = srt_get_handshake_extension_receiver_tsbpd_delay(p_ext_local);
+    uint16_t i_tx = srt_get_handshake_extension_sender_tsbpd_delay(p_ext_peer);
+    return (uint64_t)(i_rx > i_tx ? i_rx : i_tx) * 1000;
+}
+
+/* returns the extended timestamp closest to the last one */
+static inline uint64_t srt_tsbpd_extend(srt_tsbpd_t *p_tsbpd,
+                                        uint32_t i_timestamp)
+{
+    uint64_t i_ext = bitstream_extend(p_tsbpd->i_last_timestamp, i_timestamp,
+                                      UINT64_C(1) << 32);
+
+    if (i_ext > p_tsbpd->i_last_timestamp)
+        p_tsbpd->i_last_timestamp = i_ext;
+    return i_ext;
+}
+
+/* starts the time base on the first packet received */
+static inline void srt_tsbpd_start(srt_tsbpd_t *p_tsbpd, uint32_t i_timestamp,
+                                   uint64_t i_date)
+{
+    p_tsbpd->b_started = true;
+    p_tsbpd->i_last_timestamp = i_timestamp;
+    p_tsbpd->i_base = i_date - i_timestamp;
+}
+
+/* returns the local date at which a packet of timestamp i_timestamp is due */
+static inline uint64_t srt_tsbpd_get_date(srt_tsbpd_t *p_tsbpd,
+                                          uint32_t i_timestamp)
+{
+    return p_tsbpd->i_base + srt_tsbpd_extend(p_tsbpd, i_timestamp) +
+           p_tsbpd->i_drift + p_tsbpd->i_latency;
+}
+
+/*****************************************************************************
+ * srt_tsbpd_drift
+ *****************************************************************************
+ * Feeds a sample of the sender clock (timestamp of a control packet) against
+ * its local reception date.
+ *****************************************************************************/
+static inline void srt_tsbpd_drift(srt_tsbpd_t *p_tsbpd, uint32_t i_timestamp,
+                                   uint64_t i_date)
+{
+    int64_t i_drift;
+
+    if (!p_tsbpd->b_started)
+        return;
+    p_tsbpd->i_drift_sum += (int64_t)(i_date - p_tsbpd->i_base -
+                                      srt_tsbpd_extend(p_tsbpd, i_timestamp));
+    if (++p_tsbpd->i_drift_count < SRT_TSBPD_DRIFT_SAMPLES)
+        return;
+
+    i_drift = p_tsbpd->i_drift_sum / (int64_t)p_tsbpd->i_drift_count;
+    p_tsbpd->i_drift_sum = 0;
+    p_tsbpd->i_drift_count = 0;
+    if (i_drift > SRT_TSBPD_DRIFT_MAX) {
+        p_tsbpd->i_base += i_drift - SRT_TSBPD_DRIFT_MAX;
+        i_drift = SRT_TSBPD_DRIFT_MAX;
+    } else if (i_drift < -SRT_TSBPD_DRIFT_MAX) {
+        p_tsbpd->i_base += i_drift + SRT_TSBPD_DRIFT_MAX;
+        i_drift = -SRT_TSBPD_DRIFT_MAX;
+    }
+    p_tsbpd->i_drift = i_drift;
+}
+
+/* returns the first packet received after the missing ones, or NULL */
+static inline const srtrx_slot_t *srt_tsbpd_next(const srtrx_t *p_rx)
+{
+    uint64_t i_seq;
+
+    if (!p_rx->i_count)
+        return NULL;
+    for (i_seq = p_rx->i_next; i_seq <= p_rx->i_highest; i_seq++) {
+        const srtrx_slot_t *p_slot = &p_rx->p_slots[i_seq & p_rx->i_mask];
+        if (p_slot->p_packet != NULL)
+            return p_slot;
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * srt_tsbpd_pop
+ *****************************************************************************
+ * Returns the next packet of the receiver if it is due at date i_now, or
+ * NULL. Missing packets preceding a due packet are skipped.
+ *****************************************************************************/
+static inline uint8_t *srt_tsbpd_pop(srt_tsbpd_t *p_tsbpd, srtrx_t *p_rx,
+                                     uint64_t i_now, size_t *pi_size)
+{
+    const srtrx_slot_t *p_slot = srt_tsbpd_next(p_rx);
+
+    if (p_slot == NULL)
+        return NULL;
+    if (!p_tsbpd->b_started)
+        srt_tsbpd_start(p_tsbpd, srt_get_packet_timestamp(p_slot->p_packet),
+                        p_slot->i_date);
+    if (srt_tsbpd_get_date(p_tsbpd,
+                           srt_get_packet_timestamp(p_slot->p_packet)) > i_now)
+        return NULL;
+
+    if (p_slot->i_seq != p_rx->i_next)
+        srtrx_skip(p_rx, p_slot->i_seq);
+    return srtrx_pop(p_rx, pi_size);
+}
+
+/* returns the date at which srt_tsbpd_pop() may release a packet */
+static inline uint64_t srt_tsbpd_get_deadline(srt_tsbpd_t *p_tsbpd,
+                                              const srtrx_t *p_rx)
+{
+    const srtrx_slot_t *p_slot = srt_tsbpd_next(p_rx);
+
+    if (p_slot == NULL)
+        return UINT64_MAX;
+    if (!p_tsbpd->b_started)
+        return 0;
+    return srt_tsbpd_get_date(p_tsbpd,
+                              srt_get_packet_timestamp(p_slot->p_packet));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
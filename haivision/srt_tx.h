@@ -0,0 +1,312 @@
+/*****************************************************************************
+ * srt_tx.h: SRT sender retransmission buffer
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * References:
+ *  - SRT Technical Overview
+ *  - draft-sharabayko-srt
+ */
+
+/*
+ * Like srt_rx.h, the sender does no I/O. Data packets are numbered and time
+ * stamped by srttx_output() and kept, without copy, in a power-of-two ring
+ * of caller-allocated slots indexed by sequence number, until they are
+ * acknowledged. A NAK is answered with a direct lookup per lost packet.
+ * Packets that are still unacknowledged i_drop_delay after they were sent
+ * will not be delivered in time by the receiver: they are given up, and a
+ * DROPREQ is sent so that the receiver stops requesting them.
+ *
+ * Typical use:
+ *
+ *   srttx_output(&tx, p_packet, i_size, i_now);
+ *   send(p_packet, i_size);
+ *   ...
+ *   if (type == SRT_CONTROL_TYPE_ACK)
+ *       srttx_ack(&tx, srt_get_ack_last_ack_seq(p_cif));
+ *   else if (type == SRT_CONTROL_TYPE_NAK) {
+ *       i_nb = srttx_nak(&tx, p_cif, i_cif_size, i_now, pp_packets,
+ *                        pi_sizes, MAX);
+ *       for (i = 0; i < i_nb; i++)
+ *           send(pp_packets[i], pi_sizes[i]);
+ *   }
+ *   if ((i_drop_size = srttx_drop(&tx, i_now, p_drop, sizeof(p_drop))))
+ *       send(p_drop, i_drop_size);
+ *   while ((p = srttx_pop(&tx, &i_psize)) != NULL)
+ *       free(p);
+ */
+
+#ifndef __BITSTREAM_HAIVISION_SRT_TX_H__
+#define __BITSTREAM_HAIVISION_SRT_TX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/haivision/srt.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SRTTX_OK                0
+#define SRTTX_FULL              3
+
+typedef struct srttx_slot_t {
+    uint8_t *p_packet;
+    size_t i_size;
+    uint64_t i_date;
+} srttx_slot_t;
+
+typedef struct srttx_t {
+    srttx_slot_t *p_slots;
+    uint64_t i_mask;
+    uint32_t i_peer_socket_id;
+    uint64_t i_start;
+    uint64_t i_drop_delay;
+
+    /* [i_first, i_acked[ acknowledged or dropped, to be released,
+     * [i_acked, i_next[ in flight */
+    uint64_t i_first;
+    uint64_t i_acked;
+    uint64_t i_next;
+    uint32_t i_message_number;
+
+    /* packets to report in a DROPREQ */
+    bool b_drop;
+    uint64_t i_drop_first;
+    uint64_t i_drop_last;
+
+    /* statistics */
+    uint64_t i_sent;
+    uint64_t i_retransmitted;
+    uint64_t i_dropped;
+    uint64_t i_nak_received;
+} srttx_t;
+
+/*****************************************************************************
+ * srttx_init
+ *****************************************************************************
+ * i_nb_slots must be a power of two. i_isn is the initial sequence number
+ * sent in the handshake, i_start the date of the connection, and
+ * i_drop_delay the time after which unacknowledged packets are dropped,
+ * usually somewhat more than the peer's TSBPD latency.
+ *****************************************************************************/
+static inline void srttx_init(srttx_t *p_tx, srttx_slot_t *p_slots,
+                              uint64_t i_nb_slots, uint32_t i_isn,
+                              uint32_t i_peer_socket_id, uint64_t i_start,
+                              uint64_t i_drop_delay)
+{
+    memset(p_tx, 0, sizeof(srttx_t));
+    memset(p_slots, 0, i_nb_slots * sizeof(srttx_slot_t));
+    p_tx->p_slots = p_slots;
+    p_tx->i_mask = i_nb_slots - 1;
+    p_tx->i_peer_socket_id = i_peer_socket_id;
+    p_tx->i_start = i_start;
+    p_tx->i_drop_delay = i_drop_delay;
+    p_tx->i_first = p_tx->i_acked = p_tx->i_next = srt_seq_extend(0, i_isn);
+}
+
+/* returns the extended sequence number of a sequence number in flight */
+static inline uint64_t srttx_seq_extend(const srttx_t *p_tx, uint32_t i_seq)
+{
+    return srt_seq_extend(p_tx->i_next - 1, i_seq);
+}
+
+/*****************************************************************************
+ * srttx_output
+ *****************************************************************************
+ * Writes the SRT header of a data packet (single packet message) whose
+ * payload follows SRT_HEADER_SIZE bytes, and keeps the packet for
+ * retransmission. Returns SRTTX_FULL if the ring is full of unacknowledged
+ * packets, in which case the caller keeps ownership of the packet.
+ *****************************************************************************/
+static inline int srttx_output(srttx_t *p_tx, uint8_t *p_packet, size_t i_size,
+                               uint64_t i_date)
+{
+    srttx_slot_t *p_slot;
+
+    if (p_tx->i_next - p_tx->i_first > p_tx->i_mask)
+        return SRTTX_FULL;
+
+    memset(p_packet, 0, SRT_HEADER_SIZE);
+    srt_set_data_packet_seq(p_packet, p_tx->i_next & 0x7fffffff);
+    srt_set_data_packet_position(p_packet, 3);
+    p_tx->i_message_number = (p_tx->i_message_number % 0x3ffffff) + 1;
+    srt_set_data_packet_message_number(p_packet, p_tx->i_message_number);
+    srt_set_packet_timestamp(p_packet, i_date - p_tx->i_start);
+    srt_set_packet_dst_socket_id(p_packet, p_tx->i_peer_socket_id);
+
+    p_slot = &p_tx->p_slots[p_tx->i_next & p_tx->i_mask];
+    p_slot->p_packet = p_packet;
+    p_slot->i_size = i_size;
+    p_slot->i_date = i_date;
+    p_tx->i_next++;
+    p_tx->i_sent++;
+    return SRTTX_OK;
+}
+
+/* returns the message number of a packet in flight or not yet released,
+ * knowing that srttx_output() numbers each packet as a new message */
+static inline uint32_t srttx_get_message_number(const srttx_t *p_tx,
+                                                uint64_t i_seq)
+{
+    uint64_t i_back = (p_tx->i_next - 1 - i_seq) % 0x3ffffff;
+    return (p_tx->i_message_number + 0x3ffffff - 1 - i_back) % 0x3ffffff + 1;
+}
+
+/* marks the packets before i_seq, taken from an ACK, as received */
+static inline void srttx_ack(srttx_t *p_tx, uint32_t i_seq)
+{
+    uint64_t i_ack = srttx_seq_extend(p_tx, i_seq);
+
+    if (i_ack > p_tx->i_acked && i_ack <= p_tx->i_next)
+        p_tx->i_acked = i_ack;
+}
+
+/*****************************************************************************
+ * srttx_pop
+ *****************************************************************************
+ * Returns the next packet which is no longer needed, or NULL.
+ *****************************************************************************/
+static inline uint8_t *srttx_pop(srttx_t *p_tx, size_t *pi_size)
+{
+    srttx_slot_t *p_slot;
+    uint8_t *p_packet;
+
+    if (p_tx->i_first >= p_tx->i_acked)
+        return NULL;
+    p_slot = &p_tx->p_slots[p_tx->i_first++ & p_tx->i_mask];
+    p_packet = p_slot->p_packet;
+    *pi_size = p_slot->i_size;
+    p_slot->p_packet = NULL;
+    return p_packet;
+}
+
+/* adds packets to the next DROPREQ */
+static inline void srttx_drop_add(srttx_t *p_tx, uint64_t i_first,
+                                  uint64_t i_last)
+{
+    if (!p_tx->b_drop) {
+        p_tx->b_drop = true;
+        p_tx->i_drop_first = i_first;
+        p_tx->i_drop_last = i_last;
+        return;
+    }
+    if (i_first < p_tx->i_drop_first)
+        p_tx->i_drop_first = i_first;
+    if (i_last > p_tx->i_drop_last)
+        p_tx->i_drop_last = i_last;
+}
+
+/*****************************************************************************
+ * srttx_nak
+ *****************************************************************************
+ * Looks up the packets requested by the CIF of a NAK packet, flags them as
+ * retransmitted, and stores at most i_max of them in pp_packets/pi_sizes,
+ * for the caller to send again. Packets that are no longer available are
+ * reported by the next DROPREQ. Returns the number of packets stored.
+ *****************************************************************************/
+static inline unsigned int srttx_nak(srttx_t *p_tx, const uint8_t *p_cif,
+                                     size_t i_cif_size, uint64_t i_now,
+                                     uint8_t **pp_packets, size_t *pi_sizes,
+                                     unsigned int i_max)
+{
+    unsigned int i_nb = 0;
+    uint32_t i_start, i_packets;
+
+    p_tx->i_nak_received++;
+    while (srt_get_nak_range(&p_cif, &i_cif_size, &i_start, &i_packets)) {
+        uint64_t i_first = srttx_seq_extend(p_tx, i_start);
+        uint64_t i_last = i_first + i_packets - 1;
+        uint64_t i_seq;
+
+        if (i_first >= p_tx->i_next)
+            continue;
+        if (i_last >= p_tx->i_next)
+            i_last = p_tx->i_next - 1;
+        if (i_first < p_tx->i_acked) {
+            srttx_drop_add(p_tx, i_first, i_last < p_tx->i_acked ?
+                                          i_last : p_tx->i_acked - 1);
+            i_first = p_tx->i_acked;
+        }
+
+        for (i_seq = i_first; i_seq <= i_last && i_nb < i_max; i_seq++) {
+            srttx_slot_t *p_slot = &p_tx->p_slots[i_seq & p_tx->i_mask];
+            if (i_now >= p_slot->i_date + p_tx->i_drop_delay)
+                continue; /* dropped by srttx_drop() */
+            srt_set_data_packet_retransmit(p_slot->p_packet, true);
+            pp_packets[i_nb] = p_slot->p_packet;
+            pi_sizes[i_nb] = p_slot->i_size;
+            i_nb++;
+        }
+    }
+    p_tx->i_retransmitted += i_nb;
+    return i_nb;
+}
+
+/*****************************************************************************
+ * srttx_drop
+ *****************************************************************************
+ * Gives up on the packets past their deadline at date i_now, and writes a
+ * DROPREQ packet to p_buf if the receiver must be told, carrying the message
+ * number of the first packet dropped. Returns its size, or 0 if none.
+ *****************************************************************************/
+static inline size_t srttx_drop(srttx_t *p_tx, uint64_t i_now, uint8_t *p_buf,
+                                size_t i_buf_size)
+{
+    uint64_t i_acked = p_tx->i_acked;
+    uint8_t *p_cif = p_buf + SRT_HEADER_SIZE;
+
+    while (p_tx->i_acked < p_tx->i_next &&
+           i_now >= p_tx->p_slots[p_tx->i_acked & p_tx->i_mask].i_date +
+                    p_tx->i_drop_delay)
+        p_tx->i_acked++;
+    if (p_tx->i_acked > i_acked) {
+        p_tx->i_dropped += p_tx->i_acked - i_acked;
+        srttx_drop_add(p_tx, i_acked, p_tx->i_acked - 1);
+    }
+
+    if (!p_tx->b_drop ||
+        i_buf_size < SRT_HEADER_SIZE + SRT_DROPREQ_CIF_SIZE)
+        return 0;
+    p_tx->b_drop = false;
+
+    memset(p_buf, 0, SRT_HEADER_SIZE);
+    srt_set_packet_control(p_buf, true);
+    srt_set_control_packet_type(p_buf, SRT_CONTROL_TYPE_DROPREQ);
+    srt_set_control_packet_type_specific(p_buf,
+        srttx_get_message_number(p_tx, p_tx->i_drop_first));
+    srt_set_packet_timestamp(p_buf, i_now - p_tx->i_start);
+    srt_set_packet_dst_socket_id(p_buf, p_tx->i_peer_socket_id);
+    srt_set_dropreq_first_seq(p_cif, p_tx->i_drop_first & 0x7fffffff);
+    srt_set_dropreq_last_seq(p_cif, p_tx->i_drop_last & 0x7fffffff);
+    return SRT_HEADER_SIZE + SRT_DROPREQ_CIF_SIZE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
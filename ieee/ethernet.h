@@ -57,6 +57,7 @@ extern "C"
 #define ETHERNET_TYPE_MPLS          0x8847
 #define ETHERNET_TYPE_PPPOE_DISC    0x8863
 #define ETHERNET_TYPE_PPPOE_SESSION 0x8864
+#define ETHERNET_TYPE_QINQ          0x88A8
 #define ETHERNET_TYPE_LLDP          0x88CC
 
 static inline uint8_t *ethernet_dstaddr(uint8_t *p_ethernet)
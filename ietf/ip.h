@@ -29,12 +29,17 @@
  * Normative references:
  *  - IETF RFC 791 INTERNET PROTOCOL (September 1981)
  *  - IETF RFC 790 ASSIGNED NUMBERS (September 1981)
+ *  - IETF RFC 1071 Computing the Internet Checksum (September 1988)
+ *  - IETF RFC 1624 Computation of the Internet Checksum via Incremental
+ *    Update (May 1994)
  */
 
 #ifndef __BITSTREAM_IETF_IP_H__
 #define __BITSTREAM_IETF_IP_H__
 
+#include <stddef.h>   /* size_t */
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -161,7 +166,7 @@ static inline void ip_set_frag_offset(uint8_t *p_ip, uint16_t offset)
     p_ip[7] = (offset & 0xff);
 }
 
-static inline uint8_t ip_get_frag_offset(const uint8_t *p_ip)
+static inline uint16_t ip_get_frag_offset(const uint8_t *p_ip)
 {
     return ((p_ip[6] & 0x1f) << 8 | p_ip[7]);
 }
@@ -238,6 +243,128 @@ static inline uint8_t *ip_payload(uint8_t *p_ip)
     return p_ip + 4 * ip_get_ihl(p_ip); /* ihl is in 32b words */
 }
 
+/*****************************************************************************
+ * Internet checksum
+ *****************************************************************************
+ * Partial sums are kept unfolded in 64 bits, and may be chained as long as
+ * all buffers but the last one have an even size. Buffers are summed as
+ * big-endian 32-bit words, two at a time, which compilers turn into wide
+ * loads and which is equivalent to summing 16-bit words modulo 0xffff.
+ *****************************************************************************/
+static inline uint64_t ip_cksum_partial(const uint8_t *p, size_t i_size,
+                                        uint64_t i_sum)
+{
+    uint64_t i_sum2 = 0;
+
+    while (i_size >= 8) {
+        i_sum += ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                 ((uint32_t)p[2] << 8) | p[3];
+        i_sum2 += ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) |
+                  ((uint32_t)p[6] << 8) | p[7];
+        p += 8;
+        i_size -= 8;
+    }
+    i_sum += i_sum2 >> 32;
+    i_sum += i_sum2 & 0xffffffff;
+    if (i_size >= 4) {
+        i_sum += ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                 ((uint32_t)p[2] << 8) | p[3];
+        p += 4;
+        i_size -= 4;
+    }
+    if (i_size >= 2) {
+        i_sum += (p[0] << 8) | p[1];
+        p += 2;
+        i_size -= 2;
+    }
+    if (i_size)
+        i_sum += p[0] << 8;
+    return i_sum;
+}
+
+/* folds a partial sum to 16 bits, without complementing it */
+static inline uint16_t ip_cksum_fold(uint64_t i_sum)
+{
+    i_sum = (i_sum >> 32) + (i_sum & 0xffffffff);
+    i_sum = (i_sum >> 16) + (i_sum & 0xffff);
+    i_sum = (i_sum >> 16) + (i_sum & 0xffff);
+    i_sum = (i_sum >> 16) + (i_sum & 0xffff);
+    return i_sum;
+}
+
+static inline uint16_t ip_cksum(const uint8_t *p, size_t i_size)
+{
+    return ~ip_cksum_fold(ip_cksum_partial(p, i_size, 0));
+}
+
+/* returns the checksum after a 16-bit word changed from i_old to i_new
+ * (RFC 1624 eqn. 3) */
+static inline uint16_t ip_cksum_update16(uint16_t i_cksum, uint16_t i_old,
+                                         uint16_t i_new)
+{
+    uint32_t i_sum = (uint16_t)~i_cksum + (uint16_t)~i_old + i_new;
+    i_sum = (i_sum >> 16) + (i_sum & 0xffff);
+    i_sum = (i_sum >> 16) + (i_sum & 0xffff);
+    return ~i_sum;
+}
+
+/* same for a 32-bit word aligned on a 16-bit boundary */
+static inline uint16_t ip_cksum_update32(uint16_t i_cksum, uint32_t i_old,
+                                         uint32_t i_new)
+{
+    i_cksum = ip_cksum_update16(i_cksum, i_old >> 16, i_new >> 16);
+    return ip_cksum_update16(i_cksum, i_old & 0xffff, i_new & 0xffff);
+}
+
+/* computes and sets the header checksum */
+static inline void ip_set_cksum_header(uint8_t *p_ip)
+{
+    ip_set_cksum(p_ip, 0);
+    ip_set_cksum(p_ip, ip_cksum(p_ip, 4 * ip_get_ihl(p_ip)));
+}
+
+static inline bool ip_check_cksum(const uint8_t *p_ip)
+{
+    return !ip_cksum(p_ip, 4 * ip_get_ihl(p_ip));
+}
+
+/* the following setters update the header checksum incrementally */
+static inline void ip_patch_ttl(uint8_t *p_ip, uint8_t ttl)
+{
+    uint16_t i_old = (p_ip[8] << 8) | p_ip[9];
+    ip_set_ttl(p_ip, ttl);
+    ip_set_cksum(p_ip, ip_cksum_update16(ip_get_cksum(p_ip), i_old,
+                                         (p_ip[8] << 8) | p_ip[9]));
+}
+
+static inline void ip_patch_len(uint8_t *p_ip, uint16_t len)
+{
+    ip_set_cksum(p_ip, ip_cksum_update16(ip_get_cksum(p_ip),
+                                         ip_get_len(p_ip), len));
+    ip_set_len(p_ip, len);
+}
+
+static inline void ip_patch_id(uint8_t *p_ip, uint16_t id)
+{
+    ip_set_cksum(p_ip, ip_cksum_update16(ip_get_cksum(p_ip),
+                                         ip_get_id(p_ip), id));
+    ip_set_id(p_ip, id);
+}
+
+static inline void ip_patch_srcaddr(uint8_t *p_ip, uint32_t addr)
+{
+    ip_set_cksum(p_ip, ip_cksum_update32(ip_get_cksum(p_ip),
+                                         ip_get_srcaddr(p_ip), addr));
+    ip_set_srcaddr(p_ip, addr);
+}
+
+static inline void ip_patch_dstaddr(uint8_t *p_ip, uint32_t addr)
+{
+    ip_set_cksum(p_ip, ip_cksum_update32(ip_get_cksum(p_ip),
+                                         ip_get_dstaddr(p_ip), addr));
+    ip_set_dstaddr(p_ip, addr);
+}
+
 #ifdef __cplusplus
 }
 #endif
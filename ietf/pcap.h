@@ -0,0 +1,498 @@
+/*****************************************************************************
+ * pcap.h: PCAP and PCAPNG capture files
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF draft-ietf-opsawg-pcap PCAP Capture File Format
+ *  - IETF draft-ietf-opsawg-pcapng PCAP Now Generic (pcapng) Capture File
+ *    Format
+ *  - IEEE Std 802.1Q-2014 (VLAN tagging)
+ */
+
+/*
+ * The reader walks a capture file which has been loaded or mapped in memory
+ * by the caller, and returns views of its packets without copying them.
+ * Both the classic and the next generation formats are supported, in either
+ * byte order. A packet may then be dissected down to its UDP payload
+ * (Ethernet, possibly VLAN-tagged, Linux cooked or raw IPv4 link types),
+ * filtered on its destination address and port, and its payload identified
+ * as RTP and/or MPEG transport stream packets.
+ *
+ * Typical use:
+ *
+ *   p_map = mmap(NULL, i_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+ *   if (pcap_open(&reader, p_map, i_size))
+ *       while (pcap_next(&reader, &packet))
+ *           if (pcap_dissect(&packet, &udp) && pcap_filter(&udp, i_group, 0))
+ *               for (i = 0; i < udp.i_nb_ts; i++)
+ *                   demux(udp.p_ts + i * TS_SIZE);
+ */
+
+#ifndef __BITSTREAM_IETF_PCAP_H__
+#define __BITSTREAM_IETF_PCAP_H__
+
+#include <stddef.h>   /* ptrdiff_t */
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/ieee/ethernet.h>
+#include <bitstream/ietf/ip.h>
+#include <bitstream/ietf/udp.h>
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/mpeg/ts.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * PCAP
+ *****************************************************************************/
+#define PCAP_MAGIC_USEC         0xa1b2c3d4
+#define PCAP_MAGIC_NSEC         0xa1b23c4d
+#define PCAP_HEADER_SIZE        24
+#define PCAP_RECORD_HEADER_SIZE 16
+
+#define PCAP_LINKTYPE_ETHERNET  1
+#define PCAP_LINKTYPE_RAW       101
+#define PCAP_LINKTYPE_LINUX_SLL 113
+#define PCAP_LINKTYPE_IPV4      228
+
+#define PCAP_LINUX_SLL_SIZE     16
+
+/*****************************************************************************
+ * PCAPNG
+ *****************************************************************************/
+#define PCAPNG_BLOCK_SHB        0x0a0d0d0a
+#define PCAPNG_BLOCK_IDB        0x00000001
+#define PCAPNG_BLOCK_SPB        0x00000003
+#define PCAPNG_BLOCK_EPB        0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1a2b3c4d
+#define PCAPNG_BLOCK_MINSIZE    12
+#define PCAPNG_SHB_MINSIZE      28
+#define PCAPNG_IDB_MINSIZE      20
+#define PCAPNG_SPB_MINSIZE      16
+#define PCAPNG_EPB_MINSIZE      32
+
+#define PCAPNG_OPT_ENDOFOPT     0
+#define PCAPNG_OPT_IF_TSRESOL   9
+
+#define PCAP_MAX_INTERFACES     16
+
+typedef struct pcap_interface_t {
+    uint16_t i_linktype;
+    /* timestamp resolution, as in the if_tsresol option */
+    uint8_t i_tsresol;
+} pcap_interface_t;
+
+typedef struct pcap_reader_t {
+    uint8_t *p_buffer;
+    size_t i_size;
+    size_t i_pos;
+
+    bool b_ng;
+    /* byte order of the file (or of the current section) */
+    bool b_big_endian;
+    unsigned int i_nb_interfaces;
+    pcap_interface_t p_interfaces[PCAP_MAX_INTERFACES];
+
+    /* statistics */
+    uint64_t i_packets;
+    uint64_t i_truncated;
+} pcap_reader_t;
+
+typedef struct pcap_packet_t {
+    uint8_t *p_data;
+    size_t i_caplen;
+    size_t i_len;
+    /* in nanoseconds since the epoch, 0 if unknown */
+    uint64_t i_date;
+    uint16_t i_linktype;
+    unsigned int i_interface;
+} pcap_packet_t;
+
+static inline uint32_t pcap_get32(const pcap_reader_t *p_reader,
+                                  const uint8_t *p)
+{
+    if (p_reader->b_big_endian)
+        return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    return (p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+static inline uint16_t pcap_get16(const pcap_reader_t *p_reader,
+                                  const uint8_t *p)
+{
+    if (p_reader->b_big_endian)
+        return (p[0] << 8) | p[1];
+    return (p[1] << 8) | p[0];
+}
+
+/* converts a timestamp in units of the given if_tsresol to nanoseconds */
+static inline uint64_t pcap_get_date(uint64_t i_ts, uint8_t i_tsresol)
+{
+    static const uint64_t pi_pow10[10] = { 1, 10, 100, 1000, 10000, 100000,
+        1000000, 10000000, 100000000, 1000000000 };
+    uint8_t i_exp = i_tsresol & 0x7f;
+
+    if (i_tsresol & 0x80) {
+        uint64_t i_mask;
+        if (i_exp >= 64)
+            return 0;
+        i_mask = (UINT64_C(1) << i_exp) - 1;
+        return (i_ts >> i_exp) * UINT64_C(1000000000) +
+               (((i_ts & i_mask) * UINT64_C(1000000000)) >> i_exp);
+    }
+    if (i_exp <= 9)
+        return i_ts * pi_pow10[9 - i_exp];
+    if (i_exp <= 18)
+        return i_ts / pi_pow10[i_exp - 9];
+    return 0;
+}
+
+/*****************************************************************************
+ * pcap_open
+ *****************************************************************************
+ * Returns false if p_buffer does not start with a PCAP file header or a
+ * PCAPNG section header block.
+ *****************************************************************************/
+static inline bool pcap_open(pcap_reader_t *p_reader, uint8_t *p_buffer,
+                             size_t i_size)
+{
+    uint32_t i_magic;
+
+    memset(p_reader, 0, sizeof(pcap_reader_t));
+    p_reader->p_buffer = p_buffer;
+    p_reader->i_size = i_size;
+
+    if (i_size < PCAP_HEADER_SIZE)
+        return false;
+    i_magic = pcap_get32(p_reader, p_buffer);
+
+    if (i_magic == PCAPNG_BLOCK_SHB) {
+        /* the section header block is parsed by pcap_next() */
+        p_reader->b_ng = true;
+        return i_size >= PCAPNG_SHB_MINSIZE;
+    }
+
+    if (i_magic != PCAP_MAGIC_USEC && i_magic != PCAP_MAGIC_NSEC) {
+        p_reader->b_big_endian = true;
+        i_magic = pcap_get32(p_reader, p_buffer);
+        if (i_magic != PCAP_MAGIC_USEC && i_magic != PCAP_MAGIC_NSEC)
+            return false;
+    }
+    p_reader->i_nb_interfaces = 1;
+    p_reader->p_interfaces[0].i_linktype = pcap_get32(p_reader, p_buffer + 20);
+    p_reader->p_interfaces[0].i_tsresol = i_magic == PCAP_MAGIC_NSEC ? 9 : 6;
+    p_reader->i_pos = PCAP_HEADER_SIZE;
+    return true;
+}
+
+static inline void pcapng_parse_idb(pcap_reader_t *p_reader,
+                                    const uint8_t *p_block, uint32_t i_length)
+{
+    pcap_interface_t *p_interface;
+    const uint8_t *p_option = p_block + 16;
+    const uint8_t *p_end = p_block + i_length - 4;
+
+    if (p_reader->i_nb_interfaces >= PCAP_MAX_INTERFACES) {
+        p_reader->i_nb_interfaces++;
+        return;
+    }
+    p_interface = &p_reader->p_interfaces[p_reader->i_nb_interfaces++];
+    p_interface->i_linktype = pcap_get16(p_reader, p_block + 8);
+    p_interface->i_tsresol = 6;
+
+    while (p_end - p_option >= 4) {
+        uint16_t i_code = pcap_get16(p_reader, p_option);
+        uint16_t i_len = pcap_get16(p_reader, p_option + 2);
+        if (i_code == PCAPNG_OPT_ENDOFOPT || p_end - p_option - 4 < i_len)
+            break;
+        if (i_code == PCAPNG_OPT_IF_TSRESOL && i_len >= 1)
+            p_interface->i_tsresol = p_option[4];
+        p_option += 4 + ((i_len + 3) & ~3);
+    }
+}
+
+/* fills p_packet from a captured frame of the given interface */
+static inline bool pcap_packet(pcap_reader_t *p_reader,
+                               pcap_packet_t *p_packet, uint8_t *p_data,
+                               size_t i_caplen, size_t i_len,
+                               unsigned int i_interface, uint64_t i_ts)
+{
+    const pcap_interface_t *p_interface;
+
+    if (i_interface >= p_reader->i_nb_interfaces ||
+        i_interface >= PCAP_MAX_INTERFACES)
+        return false;
+    p_interface = &p_reader->p_interfaces[i_interface];
+    p_packet->p_data = p_data;
+    p_packet->i_caplen = i_caplen;
+    p_packet->i_len = i_len;
+    p_packet->i_date = pcap_get_date(i_ts, p_interface->i_tsresol);
+    p_packet->i_linktype = p_interface->i_linktype;
+    p_packet->i_interface = i_interface;
+    p_reader->i_packets++;
+    if (i_caplen < i_len)
+        p_reader->i_truncated++;
+    return true;
+}
+
+/*****************************************************************************
+ * pcap_next
+ *****************************************************************************
+ * Returns the next captured packet, or false at the end of the file or if
+ * the file is corrupt.
+ *****************************************************************************/
+static inline bool pcap_next(pcap_reader_t *p_reader, pcap_packet_t *p_packet)
+{
+    while (p_reader->i_pos < p_reader->i_size) {
+        uint8_t *p_block = p_reader->p_buffer + p_reader->i_pos;
+        size_t i_left = p_reader->i_size - p_reader->i_pos;
+        uint32_t i_type, i_length;
+
+        if (!p_reader->b_ng) {
+            uint32_t i_caplen, i_ts;
+
+            if (i_left < PCAP_RECORD_HEADER_SIZE)
+                break;
+            i_caplen = pcap_get32(p_reader, p_block + 8);
+            if (i_caplen > i_left - PCAP_RECORD_HEADER_SIZE)
+                break;
+            p_reader->i_pos += PCAP_RECORD_HEADER_SIZE + i_caplen;
+            i_ts = pcap_get32(p_reader, p_block + 4);
+            return pcap_packet(p_reader, p_packet,
+                    p_block + PCAP_RECORD_HEADER_SIZE, i_caplen,
+                    pcap_get32(p_reader, p_block + 12), 0,
+                    (uint64_t)pcap_get32(p_reader, p_block) *
+                    (p_reader->p_interfaces[0].i_tsresol == 9 ?
+                     1000000000 : 1000000) + i_ts);
+        }
+
+        if (i_left < PCAPNG_BLOCK_MINSIZE)
+            break;
+        i_type = pcap_get32(p_reader, p_block);
+        if (i_type == PCAPNG_BLOCK_SHB) {
+            /* new section, possibly in another byte order */
+            if (i_left < PCAPNG_SHB_MINSIZE)
+                break;
+            p_reader->b_big_endian = false;
+            if (pcap_get32(p_reader, p_block + 8) != PCAPNG_BYTE_ORDER_MAGIC) {
+                p_reader->b_big_endian = true;
+                if (pcap_get32(p_reader, p_block + 8) !=
+                        PCAPNG_BYTE_ORDER_MAGIC)
+                    break;
+            }
+            p_reader->i_nb_interfaces = 0;
+        }
+        i_length = pcap_get32(p_reader, p_block + 4);
+        if (i_length < PCAPNG_BLOCK_MINSIZE || i_length % 4 ||
+            i_length > i_left)
+            break;
+        p_reader->i_pos += i_length;
+
+        if (i_type == PCAPNG_BLOCK_IDB && i_length >= PCAPNG_IDB_MINSIZE)
+            pcapng_parse_idb(p_reader, p_block, i_length);
+
+        else if (i_type == PCAPNG_BLOCK_EPB && i_length >= PCAPNG_EPB_MINSIZE) {
+            uint32_t i_caplen = pcap_get32(p_reader, p_block + 20);
+            if (i_caplen > i_length - PCAPNG_EPB_MINSIZE)
+                continue;
+            if (pcap_packet(p_reader, p_packet, p_block + 28, i_caplen,
+                    pcap_get32(p_reader, p_block + 24),
+                    pcap_get32(p_reader, p_block + 8),
+                    ((uint64_t)pcap_get32(p_reader, p_block + 12) << 32) |
+                    pcap_get32(p_reader, p_block + 16)))
+                return true;
+
+        } else if (i_type == PCAPNG_BLOCK_SPB && i_length >= PCAPNG_SPB_MINSIZE) {
+            uint32_t i_len = pcap_get32(p_reader, p_block + 8);
+            uint32_t i_caplen = i_length - PCAPNG_SPB_MINSIZE;
+            if (i_caplen > i_len)
+                i_caplen = i_len;
+            if (pcap_packet(p_reader, p_packet, p_block + 12, i_caplen, i_len,
+                            0, 0)) {
+                p_packet->i_date = 0;
+                return true;
+            }
+        }
+    }
+
+    p_reader->i_pos = p_reader->i_size;
+    return false;
+}
+
+/*****************************************************************************
+ * Dissection
+ *****************************************************************************/
+typedef struct pcap_udp_t {
+    uint8_t *p_ethernet;
+    /* outer VLAN identifier, or -1 */
+    int i_vlan;
+    uint8_t *p_ip;
+    uint8_t *p_udp;
+    uint8_t *p_payload;
+    size_t i_payload_size;
+
+    /* RTP header if the payload looks like RTP, or NULL */
+    uint8_t *p_rtp;
+    /* TS packets carried by the payload, if any */
+    uint8_t *p_ts;
+    unsigned int i_nb_ts;
+} pcap_udp_t;
+
+/* looks for TS packets, either as the whole payload or after RTP */
+static inline void pcap_dissect_payload(pcap_udp_t *p_udp)
+{
+    uint8_t *p_payload = p_udp->p_payload;
+    size_t i_size = p_udp->i_payload_size;
+
+    p_udp->p_rtp = p_udp->p_ts = NULL;
+    p_udp->i_nb_ts = 0;
+
+    if (i_size >= TS_SIZE && !(i_size % TS_SIZE) && ts_validate(p_payload)) {
+        p_udp->p_ts = p_payload;
+        p_udp->i_nb_ts = i_size / TS_SIZE;
+        return;
+    }
+
+    if (rtp_check_size(p_payload, i_size) && rtp_check_hdr(p_payload)) {
+        uint8_t *p_rtp_payload = rtp_payload(p_payload);
+        size_t i_rtp_size = rtp_payload_size(p_payload, i_size);
+
+        p_udp->p_rtp = p_payload;
+        if (rtp_get_type(p_payload) == RTP_TYPE_TS &&
+            i_rtp_size >= TS_SIZE && ts_validate(p_rtp_payload)) {
+            p_udp->p_ts = p_rtp_payload;
+            p_udp->i_nb_ts = i_rtp_size / TS_SIZE;
+        }
+    }
+}
+
+/*****************************************************************************
+ * pcap_dissect
+ *****************************************************************************
+ * Returns true if the packet is an unfragmented IPv4 UDP datagram, and
+ * fills p_udp with views of its headers and payload. Up to two VLAN tags
+ * are skipped.
+ *****************************************************************************/
+static inline bool pcap_dissect(const pcap_packet_t *p_packet,
+                                pcap_udp_t *p_udp)
+{
+    uint8_t *p = p_packet->p_data;
+    uint8_t *p_end = p + p_packet->i_caplen;
+    uint16_t i_ip_len;
+    size_t i_ihl;
+
+    p_udp->p_ethernet = NULL;
+    p_udp->i_vlan = -1;
+
+    switch (p_packet->i_linktype) {
+        case PCAP_LINKTYPE_ETHERNET: {
+            uint16_t i_lentype;
+            unsigned int i_tags = 0;
+
+            if (p_end - p < ETHERNET_HEADER_LEN)
+                return false;
+            p_udp->p_ethernet = p;
+            i_lentype = ethernet_get_lentype(p);
+            while ((i_lentype == ETHERNET_TYPE_VLAN || i_lentype == ETHERNET_TYPE_QINQ) &&
+                   i_tags++ < 2) {
+                if (p_end - p < ETHERNET_HEADER_LEN + ETHERNET_VLAN_LEN)
+                    return false;
+                if (p_udp->i_vlan == -1)
+                    p_udp->i_vlan = ethernet_vlan_get_id(p);
+                i_lentype = ethernet_vlan_get_lentype(p);
+                /* the tag is now seen as the end of the Ethernet header */
+                p += ETHERNET_VLAN_LEN;
+            }
+            if (i_lentype != ETHERNET_TYPE_IP)
+                return false;
+            p += ETHERNET_HEADER_LEN;
+            break;
+        }
+
+        case PCAP_LINKTYPE_LINUX_SLL:
+            if (p_end - p < PCAP_LINUX_SLL_SIZE ||
+                ((p[14] << 8) | p[15]) != ETHERNET_TYPE_IP)
+                return false;
+            p += PCAP_LINUX_SLL_SIZE;
+            break;
+
+        case PCAP_LINKTYPE_RAW:
+        case PCAP_LINKTYPE_IPV4:
+            break;
+
+        default:
+            return false;
+    }
+
+    /* IPv4 */
+    if (p_end - p < IP_HEADER_MINSIZE || ip_get_version(p) != 4 ||
+        ip_get_proto(p) != IP_PROTO_UDP)
+        return false;
+    i_ihl = 4 * (size_t)ip_get_ihl(p);
+    i_ip_len = ip_get_len(p);
+    if (i_ihl < IP_HEADER_MINSIZE || i_ip_len < i_ihl + UDP_HEADER_SIZE ||
+        ip_get_flag_mf(p) || ip_get_frag_offset(p))
+        return false;
+    /* the frame may be padded, or truncated by the capture */
+    if (p_end - p > i_ip_len)
+        p_end = p + i_ip_len;
+    if (p_end - p < (ptrdiff_t)(i_ihl + UDP_HEADER_SIZE))
+        return false;
+    p_udp->p_ip = p;
+    p += i_ihl;
+
+    /* UDP */
+    p_udp->p_udp = p;
+    p_udp->p_payload = udp_payload(p);
+    p_udp->i_payload_size = p_end - p_udp->p_payload;
+    if (udp_get_len(p) >= UDP_HEADER_SIZE &&
+        (size_t)udp_get_len(p) - UDP_HEADER_SIZE < p_udp->i_payload_size)
+        p_udp->i_payload_size = udp_get_len(p) - UDP_HEADER_SIZE;
+
+    pcap_dissect_payload(p_udp);
+    return true;
+}
+
+/*****************************************************************************
+ * pcap_filter
+ *****************************************************************************
+ * Returns true if the datagram is sent to i_dstaddr (typically a multicast
+ * group) and i_dstport, either being 0 to match any.
+ *****************************************************************************/
+static inline bool pcap_filter(const pcap_udp_t *p_udp, uint32_t i_dstaddr,
+                               uint16_t i_dstport)
+{
+    return (!i_dstaddr || ip_get_dstaddr(p_udp->p_ip) == i_dstaddr) &&
+           (!i_dstport || udp_get_dstport(p_udp->p_udp) == i_dstport);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,317 @@
+/*****************************************************************************
+ * rfc4175_pgroup.h: RFC 4175 4:2:2 10-bit pixel groups
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 4175 Uncompressed
+ */
+
+/*
+ * Conversion of the YCbCr-4:2:2 10-bit pixel groups (5 bytes for 2 pixels:
+ * Cb, Y0, Cr, Y1 as 10-bit big-endian samples) carried in RFC 4175
+ * payloads, from and to planar 16-bit buffers and v210 (6 pixels in 4
+ * little-endian 32-bit words). The components come in the same order in
+ * both packings, so that a component at a given index in a line is found
+ * at the same index in v210, three per 32-bit word.
+ */
+
+#ifndef __BITSTREAM_IETF_RFC4175_PGROUP_H__
+#define __BITSTREAM_IETF_RFC4175_PGROUP_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stddef.h>   /* size_t */
+#include <bitstream/ietf/rfc4175.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RFC_4175_422_10_PGROUP_SIZE     5
+#define RFC_4175_422_10_PGROUP_PIXELS   2
+#define RFC_4175_V210_BLOCK_SIZE        16
+#define RFC_4175_V210_BLOCK_PIXELS      6
+#define RFC_4175_MAX_SEGMENTS           16
+
+/*****************************************************************************
+ * Sample row data headers
+ *****************************************************************************/
+typedef struct rfc4175_segment_t {
+    uint16_t i_line;
+    uint8_t i_field;
+    uint16_t i_offset; /* in pixels */
+    uint16_t i_length; /* in bytes */
+    const uint8_t *p_data;
+} rfc4175_segment_t;
+
+/*****************************************************************************
+ * rfc4175_get_segments
+ *****************************************************************************
+ * Parses the sample row data headers of an RTP payload (starting with the
+ * extended sequence number), and locates the data of each segment. Returns
+ * the number of segments, or -1 if the payload is invalid.
+ *****************************************************************************/
+static inline int rfc4175_get_segments(const uint8_t *p_payload, size_t i_size,
+                                       rfc4175_segment_t *p_segments,
+                                       int i_max)
+{
+    const uint8_t *p_header = p_payload + RFC_4175_EXT_SEQ_NUM_LEN;
+    const uint8_t *p_end = p_payload + i_size;
+    const uint8_t *p_data;
+    int i, i_nb = 0;
+
+    do {
+        if (i_nb >= i_max || p_header + RFC_4175_HEADER_LEN > p_end)
+            return -1;
+        p_segments[i_nb].i_length = rfc4175_get_line_length(p_header);
+        p_segments[i_nb].i_field = rfc4175_get_line_field_id(p_header);
+        p_segments[i_nb].i_line = rfc4175_get_line_number(p_header);
+        p_segments[i_nb].i_offset = rfc4175_get_line_offset(p_header);
+        i_nb++;
+        p_header += RFC_4175_HEADER_LEN;
+    } while (rfc4175_get_line_continuation(p_header - RFC_4175_HEADER_LEN));
+
+    p_data = p_header;
+    for (i = 0; i < i_nb; i++) {
+        if (p_data + p_segments[i].i_length > p_end)
+            return -1;
+        p_segments[i].p_data = p_data;
+        p_data += p_segments[i].i_length;
+    }
+    return i_nb;
+}
+
+/*****************************************************************************
+ * Planar 16-bit
+ *****************************************************************************
+ * i_pixels must be even.
+ *****************************************************************************/
+static inline void rfc4175_422_10_to_planar(const uint8_t *p_src,
+                                            uint16_t *p_y, uint16_t *p_u,
+                                            uint16_t *p_v, size_t i_pixels)
+{
+    size_t i;
+
+    for (i = 0; i < i_pixels / 2; i++) {
+        const uint8_t *p = p_src + i * RFC_4175_422_10_PGROUP_SIZE;
+        p_u[i] = (p[0] << 2) | (p[1] >> 6);
+        p_y[2 * i] = ((p[1] & 0x3f) << 4) | (p[2] >> 4);
+        p_v[i] = ((p[2] & 0xf) << 6) | (p[3] >> 2);
+        p_y[2 * i + 1] = ((p[3] & 0x3) << 8) | p[4];
+    }
+}
+
+static inline void rfc4175_422_10_from_planar(uint8_t *p_dst,
+                                              const uint16_t *p_y,
+                                              const uint16_t *p_u,
+                                              const uint16_t *p_v,
+                                              size_t i_pixels)
+{
+    size_t i;
+
+    for (i = 0; i < i_pixels / 2; i++) {
+        uint8_t *p = p_dst + i * RFC_4175_422_10_PGROUP_SIZE;
+        uint16_t i_u = p_u[i] & 0x3ff, i_y0 = p_y[2 * i] & 0x3ff;
+        uint16_t i_v = p_v[i] & 0x3ff, i_y1 = p_y[2 * i + 1] & 0x3ff;
+        p[0] = i_u >> 2;
+        p[1] = (i_u << 6) | (i_y0 >> 4);
+        p[2] = (i_y0 << 4) | (i_v >> 6);
+        p[3] = (i_v << 2) | (i_y1 >> 8);
+        p[4] = i_y1;
+    }
+}
+
+/*****************************************************************************
+ * v210
+ *****************************************************************************
+ * i_pixel is the position of the first pixel in the v210 line, and i_pixels
+ * must be even. Whole words are written when the position is a multiple of
+ * 6 pixels, otherwise the components are merged one by one.
+ *****************************************************************************/
+static inline void rfc4175_v210_set_component(uint8_t *p_line, size_t i_index,
+                                              uint16_t i_value)
+{
+    uint8_t *p = p_line + (i_index / 3) * 4;
+    uint32_t i_word = p[0] | (p[1] << 8) | (p[2] << 16) |
+                      ((uint32_t)p[3] << 24);
+    unsigned int i_shift = (i_index % 3) * 10;
+
+    i_word &= ~(UINT32_C(0x3ff) << i_shift);
+    i_word |= (uint32_t)(i_value & 0x3ff) << i_shift;
+    p[0] = i_word;
+    p[1] = i_word >> 8;
+    p[2] = i_word >> 16;
+    p[3] = i_word >> 24;
+}
+
+static inline uint16_t rfc4175_v210_get_component(const uint8_t *p_line,
+                                                  size_t i_index)
+{
+    const uint8_t *p = p_line + (i_index / 3) * 4;
+    uint32_t i_word = p[0] | (p[1] << 8) | (p[2] << 16) |
+                      ((uint32_t)p[3] << 24);
+    return (i_word >> ((i_index % 3) * 10)) & 0x3ff;
+}
+
+/* returns the 4 components of the pgroup */
+static inline void rfc4175_422_10_get_pgroup(const uint8_t *p, uint16_t *pi_c)
+{
+    pi_c[0] = (p[0] << 2) | (p[1] >> 6);
+    pi_c[1] = ((p[1] & 0x3f) << 4) | (p[2] >> 4);
+    pi_c[2] = ((p[2] & 0xf) << 6) | (p[3] >> 2);
+    pi_c[3] = ((p[3] & 0x3) << 8) | p[4];
+}
+
+static inline void rfc4175_422_10_to_v210(const uint8_t *p_src,
+                                          uint8_t *p_line, size_t i_pixel,
+                                          size_t i_pixels)
+{
+    size_t i_index = i_pixel * 2, i_end = (i_pixel + i_pixels) * 2;
+
+    /* leading components up to a word boundary */
+    while (i_index < i_end && i_index % 3) {
+        uint16_t pi_c[4];
+        int i;
+        rfc4175_422_10_get_pgroup(p_src, pi_c);
+        p_src += RFC_4175_422_10_PGROUP_SIZE;
+        for (i = 0; i < 4; i++)
+            rfc4175_v210_set_component(p_line, i_index++, pi_c[i]);
+    }
+
+    /* 3 pgroups (12 components) go to 4 words */
+    for ( ; i_index + 12 <= i_end; i_index += 12) {
+        uint8_t *p = p_line + (i_index / 3) * 4;
+        uint16_t pi_c[12];
+        int i;
+        rfc4175_422_10_get_pgroup(p_src, pi_c);
+        rfc4175_422_10_get_pgroup(p_src + 5, pi_c + 4);
+        rfc4175_422_10_get_pgroup(p_src + 10, pi_c + 8);
+        p_src += 3 * RFC_4175_422_10_PGROUP_SIZE;
+        for (i = 0; i < 4; i++) {
+            uint32_t i_word = pi_c[3 * i] | ((uint32_t)pi_c[3 * i + 1] << 10) |
+                              ((uint32_t)pi_c[3 * i + 2] << 20);
+            p[4 * i] = i_word;
+            p[4 * i + 1] = i_word >> 8;
+            p[4 * i + 2] = i_word >> 16;
+            p[4 * i + 3] = i_word >> 24;
+        }
+    }
+
+    while (i_index < i_end) {
+        uint16_t pi_c[4];
+        int i;
+        rfc4175_422_10_get_pgroup(p_src, pi_c);
+        p_src += RFC_4175_422_10_PGROUP_SIZE;
+        for (i = 0; i < 4; i++)
+            rfc4175_v210_set_component(p_line, i_index++, pi_c[i]);
+    }
+}
+
+static inline void rfc4175_422_10_from_v210(uint8_t *p_dst,
+                                            const uint8_t *p_line,
+                                            size_t i_pixel, size_t i_pixels)
+{
+    size_t i_index = i_pixel * 2, i_end = (i_pixel + i_pixels) * 2;
+
+    for ( ; i_index < i_end; i_index += 4) {
+        uint16_t i_u = rfc4175_v210_get_component(p_line, i_index);
+        uint16_t i_y0 = rfc4175_v210_get_component(p_line, i_index + 1);
+        uint16_t i_v = rfc4175_v210_get_component(p_line, i_index + 2);
+        uint16_t i_y1 = rfc4175_v210_get_component(p_line, i_index + 3);
+        p_dst[0] = i_u >> 2;
+        p_dst[1] = (i_u << 6) | (i_y0 >> 4);
+        p_dst[2] = (i_y0 << 4) | (i_v >> 6);
+        p_dst[3] = (i_v << 2) | (i_y1 >> 8);
+        p_dst[4] = i_y1;
+        p_dst += RFC_4175_422_10_PGROUP_SIZE;
+    }
+}
+
+/*****************************************************************************
+ * Whole payloads
+ *****************************************************************************
+ * Scatter all the segments of an RTP payload to a picture, either planar
+ * (strides in samples) or v210 (stride in bytes). Segments outside of the
+ * picture are ignored. Return the number of segments, or -1 if the payload
+ * is invalid.
+ *****************************************************************************/
+static inline int rfc4175_422_10_unpack_planar(const uint8_t *p_payload,
+                                               size_t i_size,
+                                               uint16_t *pp_planes[3],
+                                               const size_t pi_strides[3],
+                                               unsigned int i_width,
+                                               unsigned int i_height)
+{
+    rfc4175_segment_t p_segments[RFC_4175_MAX_SEGMENTS];
+    int i, i_nb = rfc4175_get_segments(p_payload, i_size, p_segments,
+                                       RFC_4175_MAX_SEGMENTS);
+
+    for (i = 0; i < i_nb; i++) {
+        rfc4175_segment_t *p_seg = &p_segments[i];
+        size_t i_pixels = p_seg->i_length / RFC_4175_422_10_PGROUP_SIZE *
+                          RFC_4175_422_10_PGROUP_PIXELS;
+        size_t i_offset = p_seg->i_offset & ~1;
+
+        if (p_seg->i_line >= i_height || i_offset + i_pixels > i_width)
+            continue;
+        rfc4175_422_10_to_planar(p_seg->p_data,
+                pp_planes[0] + p_seg->i_line * pi_strides[0] + i_offset,
+                pp_planes[1] + p_seg->i_line * pi_strides[1] + i_offset / 2,
+                pp_planes[2] + p_seg->i_line * pi_strides[2] + i_offset / 2,
+                i_pixels);
+    }
+    return i_nb;
+}
+
+static inline int rfc4175_422_10_unpack_v210(const uint8_t *p_payload,
+                                             size_t i_size, uint8_t *p_picture,
+                                             size_t i_stride,
+                                             unsigned int i_width,
+                                             unsigned int i_height)
+{
+    rfc4175_segment_t p_segments[RFC_4175_MAX_SEGMENTS];
+    int i, i_nb = rfc4175_get_segments(p_payload, i_size, p_segments,
+                                       RFC_4175_MAX_SEGMENTS);
+
+    for (i = 0; i < i_nb; i++) {
+        rfc4175_segment_t *p_seg = &p_segments[i];
+        size_t i_pixels = p_seg->i_length / RFC_4175_422_10_PGROUP_SIZE *
+                          RFC_4175_422_10_PGROUP_PIXELS;
+        size_t i_offset = p_seg->i_offset & ~1;
+
+        if (p_seg->i_line >= i_height || i_offset + i_pixels > i_width)
+            continue;
+        rfc4175_422_10_to_v210(p_seg->p_data,
+                               p_picture + p_seg->i_line * i_stride,
+                               i_offset, i_pixels);
+    }
+    return i_nb;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,268 @@
+/*****************************************************************************
+ * rfc4175_tx.h: RFC 4175 packetizer
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 4175 Uncompressed
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The packetizer slices frames made of contiguous lines of pixel groups
+ * (see rfc4175_pgroup.h to pack them from planar or v210 pictures) into RTP
+ * packets, filling each packet with as many pixel groups as possible, so
+ * that a packet may span several lines. The layout only depends on the video
+ * format, so the headers of all the packets of a frame are computed once in
+ * caller-allocated templates; for each packet only the sequence number,
+ * timestamp and marker remain to be set. The pixel data is not copied: the
+ * data of a packet is a contiguous range of the frame, which is handed to
+ * the caller along with the header, ready to be sent from two iovecs with
+ * sendmmsg() or writev().
+ *
+ * Typical use:
+ *
+ *   i_nb = rfc4175tx_get_nb_packets(i_width, i_height, 5, 2, 1448);
+ *   p_templates = malloc(i_nb * sizeof(rfc4175tx_template_t));
+ *   rfc4175tx_init(&tx, p_templates, i_width, i_height, 5, 2, 1448, 96, ssrc);
+ *   for (i = 0; i < i_nb; i += i_batch) {
+ *       i_batch = rfc4175tx_packets(&tx, p_frame, i_ts, i, p_packets, 64);
+ *       send(p_packets, i_batch);
+ *   }
+ */
+
+#ifndef __BITSTREAM_IETF_RFC4175_TX_H__
+#define __BITSTREAM_IETF_RFC4175_TX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy, memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rfc4175.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RFC4175TX_MAX_SEGMENTS  4
+#define RFC4175TX_HEADER_MAX    (RTP_HEADER_SIZE + RFC_4175_EXT_SEQ_NUM_LEN + \
+                                 RFC4175TX_MAX_SEGMENTS * RFC_4175_HEADER_LEN)
+
+typedef struct rfc4175tx_template_t {
+    uint8_t p_header[RFC4175TX_HEADER_MAX];
+    uint8_t i_header_size;
+    uint16_t i_data_size;
+    uint32_t i_data_offset;
+} rfc4175tx_template_t;
+
+typedef struct rfc4175tx_packet_t {
+    uint8_t p_header[RFC4175TX_HEADER_MAX];
+    size_t i_header_size;
+    const uint8_t *p_data;
+    size_t i_data_size;
+} rfc4175tx_packet_t;
+
+typedef struct rfc4175tx_t {
+    rfc4175tx_template_t *p_templates;
+    unsigned int i_nb_packets;
+    size_t i_frame_size;
+    uint32_t i_seqnum;
+} rfc4175tx_t;
+
+/*****************************************************************************
+ * rfc4175tx_layout
+ *****************************************************************************
+ * Slices a frame and fills the templates if p_templates is not NULL.
+ * i_payload_size is the maximum RTP payload size, at most 0xffff.
+ * Returns the number of packets per frame, or 0 if the format is invalid.
+ *****************************************************************************/
+static inline unsigned int rfc4175tx_layout(rfc4175tx_template_t *p_templates,
+                                            unsigned int i_width,
+                                            unsigned int i_height,
+                                            unsigned int i_pgroup_size,
+                                            unsigned int i_pgroup_pixels,
+                                            size_t i_payload_size)
+{
+    size_t i_line_size = i_width / i_pgroup_pixels * i_pgroup_size;
+    unsigned int i_line = 0, i_offset = 0, i_nb = 0;
+    uint32_t i_data_offset = 0;
+
+    if (!i_width || !i_height || !i_pgroup_size || !i_pgroup_pixels ||
+        i_width % i_pgroup_pixels || i_height > 0x8000 ||
+        i_width > 0x8000 || i_line_size > 0xffff ||
+        i_payload_size > 0xffff ||
+        i_payload_size < RFC_4175_EXT_SEQ_NUM_LEN + RFC_4175_HEADER_LEN +
+                         i_pgroup_size)
+        return 0;
+
+    while (i_line < i_height) {
+        size_t i_avail = i_payload_size - RFC_4175_EXT_SEQ_NUM_LEN;
+        uint8_t *p_header = NULL;
+        unsigned int i_segments = 0;
+        size_t i_data_size = 0;
+
+        if (p_templates != NULL) {
+            memset(p_templates[i_nb].p_header, 0, RFC4175TX_HEADER_MAX);
+            p_header = p_templates[i_nb].p_header + RTP_HEADER_SIZE +
+                       RFC_4175_EXT_SEQ_NUM_LEN;
+        }
+
+        while (i_line < i_height && i_segments < RFC4175TX_MAX_SEGMENTS &&
+               i_avail >= RFC_4175_HEADER_LEN + i_pgroup_size) {
+            size_t i_size = (i_width - i_offset) / i_pgroup_pixels *
+                            i_pgroup_size;
+            size_t i_max = (i_avail - RFC_4175_HEADER_LEN) / i_pgroup_size *
+                           i_pgroup_size;
+            if (i_size > i_max)
+                i_size = i_max;
+
+            if (p_header != NULL) {
+                if (i_segments)
+                    rfc4175_set_line_continuation(p_header -
+                                                  RFC_4175_HEADER_LEN, 1);
+                rfc4175_set_line_length(p_header, i_size);
+                rfc4175_set_line_number(p_header, i_line);
+                rfc4175_set_line_offset(p_header, i_offset);
+                p_header += RFC_4175_HEADER_LEN;
+            }
+
+            i_segments++;
+            i_data_size += i_size;
+            i_avail -= RFC_4175_HEADER_LEN + i_size;
+            i_offset += i_size / i_pgroup_size * i_pgroup_pixels;
+            if (i_offset >= i_width) {
+                i_offset = 0;
+                i_line++;
+            }
+        }
+
+        if (p_templates != NULL) {
+            rfc4175tx_template_t *p_template = &p_templates[i_nb];
+            rtp_set_hdr(p_template->p_header);
+            p_template->i_header_size = RTP_HEADER_SIZE +
+                RFC_4175_EXT_SEQ_NUM_LEN + i_segments * RFC_4175_HEADER_LEN;
+            p_template->i_data_size = i_data_size;
+            p_template->i_data_offset = i_data_offset;
+        }
+        i_data_offset += i_data_size;
+        i_nb++;
+    }
+
+    if (p_templates != NULL)
+        rtp_set_marker(p_templates[i_nb - 1].p_header);
+    return i_nb;
+}
+
+static inline unsigned int rfc4175tx_get_nb_packets(unsigned int i_width,
+        unsigned int i_height, unsigned int i_pgroup_size,
+        unsigned int i_pgroup_pixels, size_t i_payload_size)
+{
+    return rfc4175tx_layout(NULL, i_width, i_height, i_pgroup_size,
+                            i_pgroup_pixels, i_payload_size);
+}
+
+/*****************************************************************************
+ * rfc4175tx_init
+ *****************************************************************************
+ * p_templates must hold rfc4175tx_get_nb_packets() templates, and
+ * i_payload_size is the maximum size of the RTP payload. Returns false if
+ * the format is invalid.
+ *****************************************************************************/
+static inline bool rfc4175tx_init(rfc4175tx_t *p_tx,
+                                  rfc4175tx_template_t *p_templates,
+                                  unsigned int i_width, unsigned int i_height,
+                                  unsigned int i_pgroup_size,
+                                  unsigned int i_pgroup_pixels,
+                                  size_t i_payload_size, uint8_t i_type,
+                                  uint32_t i_ssrc)
+{
+    unsigned int i;
+
+    p_tx->p_templates = p_templates;
+    p_tx->i_seqnum = 0;
+    p_tx->i_nb_packets = rfc4175tx_layout(p_templates, i_width, i_height,
+                                          i_pgroup_size, i_pgroup_pixels,
+                                          i_payload_size);
+    p_tx->i_frame_size = (size_t)i_width / i_pgroup_pixels * i_pgroup_size *
+                         i_height;
+
+    for (i = 0; i < p_tx->i_nb_packets; i++) {
+        rtp_set_type(p_templates[i].p_header, i_type);
+        rtp_set_int_ssrc(p_templates[i].p_header, i_ssrc);
+    }
+    return p_tx->i_nb_packets != 0;
+}
+
+/* sets the 32-bit sequence number of the next packet */
+static inline void rfc4175tx_set_seqnum(rfc4175tx_t *p_tx, uint32_t i_seqnum)
+{
+    p_tx->i_seqnum = i_seqnum;
+}
+
+/*****************************************************************************
+ * rfc4175tx_packets
+ *****************************************************************************
+ * Prepares at most i_max packets of the frame p_frame (i_frame_size bytes
+ * of contiguous pixel groups), starting at packet i_first, and returns the
+ * number of packets prepared. p_frame must stay valid until they are sent.
+ *****************************************************************************/
+static inline unsigned int rfc4175tx_packets(rfc4175tx_t *p_tx,
+                                             const uint8_t *p_frame,
+                                             uint32_t i_timestamp,
+                                             unsigned int i_first,
+                                             rfc4175tx_packet_t *p_packets,
+                                             unsigned int i_max)
+{
+    unsigned int i;
+
+    if (i_first >= p_tx->i_nb_packets)
+        return 0;
+    if (i_max > p_tx->i_nb_packets - i_first)
+        i_max = p_tx->i_nb_packets - i_first;
+
+    for (i = 0; i < i_max; i++) {
+        const rfc4175tx_template_t *p_template =
+            &p_tx->p_templates[i_first + i];
+        rfc4175tx_packet_t *p_packet = &p_packets[i];
+        uint32_t i_seqnum = p_tx->i_seqnum++;
+
+        memcpy(p_packet->p_header, p_template->p_header,
+               p_template->i_header_size);
+        rtp_set_seqnum(p_packet->p_header, i_seqnum & 0xffff);
+        rtp_set_timestamp(p_packet->p_header, i_timestamp);
+        rfc4175_set_extended_sequence_number(p_packet->p_header +
+                                             RTP_HEADER_SIZE, i_seqnum >> 16);
+        p_packet->i_header_size = p_template->i_header_size;
+        p_packet->p_data = p_frame + p_template->i_data_offset;
+        p_packet->i_data_size = p_template->i_data_size;
+    }
+    return i_max;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -38,6 +38,10 @@
 #define __BITSTREAM_IETF_RFC8331_H__
 
 #include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <stddef.h>   /* size_t */
+#include <string.h>   /* memset */
+#include <bitstream/smpte/291.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -45,6 +49,7 @@ extern "C"
 #endif
 
 #define RFC_8331_HEADER_LEN 8
+#define RFC_8331_ANC_HEADER_LEN 4
 
 #define RFC_8331_F_PROGRESSIVE 0
 #define RFC_8331_F_FIELD_1 2
@@ -113,6 +118,195 @@ static inline uint8_t rfc8331_get_f(const uint8_t *buf)
     return buf[5] >> 6;
 }
 
+/*
+ * ANC data packets, 32-bit aligned, following the payload header:
+ *
+ * 0                   1                   2                   3
+ * 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |C|   Line_Number       |   Horizontal_Offset   |S|  StreamNum  |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |         DID       |        SDID       |  Data_Count       | ...
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  User_Data_Words... | Checksum_Word     | word_align            |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
+
+static inline void rfc8331_anc_set_c(uint8_t *p_anc, bool c)
+{
+    p_anc[0] = (p_anc[0] & 0x7f) | (c ? 0x80 : 0);
+}
+
+static inline bool rfc8331_anc_get_c(const uint8_t *p_anc)
+{
+    return !!(p_anc[0] & 0x80);
+}
+
+static inline void rfc8331_anc_set_line_number(uint8_t *p_anc, uint16_t line)
+{
+    p_anc[0] = (p_anc[0] & 0x80) | ((line >> 4) & 0x7f);
+    p_anc[1] = (p_anc[1] & 0x0f) | ((line & 0xf) << 4);
+}
+
+static inline uint16_t rfc8331_anc_get_line_number(const uint8_t *p_anc)
+{
+    return ((p_anc[0] & 0x7f) << 4) | (p_anc[1] >> 4);
+}
+
+static inline void rfc8331_anc_set_horizontal_offset(uint8_t *p_anc,
+                                                     uint16_t offset)
+{
+    p_anc[1] = (p_anc[1] & 0xf0) | ((offset >> 8) & 0xf);
+    p_anc[2] = offset & 0xff;
+}
+
+static inline uint16_t rfc8331_anc_get_horizontal_offset(const uint8_t *p_anc)
+{
+    return ((p_anc[1] & 0xf) << 8) | p_anc[2];
+}
+
+static inline void rfc8331_anc_set_s(uint8_t *p_anc, bool s)
+{
+    p_anc[3] = (p_anc[3] & 0x7f) | (s ? 0x80 : 0);
+}
+
+static inline bool rfc8331_anc_get_s(const uint8_t *p_anc)
+{
+    return !!(p_anc[3] & 0x80);
+}
+
+static inline void rfc8331_anc_set_stream_num(uint8_t *p_anc, uint8_t num)
+{
+    p_anc[3] = (p_anc[3] & 0x80) | (num & 0x7f);
+}
+
+static inline uint8_t rfc8331_anc_get_stream_num(const uint8_t *p_anc)
+{
+    return p_anc[3] & 0x7f;
+}
+
+/*
+ * The 10-bit words (DID, SDID, Data_Count, UDW..., Checksum_Word) start on
+ * a byte boundary and come in groups of 4 words in 5 bytes: word n of a
+ * group starts in byte n of the group, at 2 * n bits.
+ */
+static inline uint16_t rfc8331_anc_get_word(const uint8_t *p_anc,
+                                            unsigned int i_word)
+{
+    const uint8_t *p = p_anc + RFC_8331_ANC_HEADER_LEN + 5 * (i_word / 4) +
+                       i_word % 4;
+    return (((p[0] << 8) | p[1]) >> (6 - 2 * (i_word % 4))) & 0x3ff;
+}
+
+static inline void rfc8331_anc_set_word(uint8_t *p_anc, unsigned int i_word,
+                                        uint16_t i_value)
+{
+    uint8_t *p = p_anc + RFC_8331_ANC_HEADER_LEN + 5 * (i_word / 4) +
+                 i_word % 4;
+    uint8_t i_shift = 6 - 2 * (i_word % 4);
+    uint16_t i_mask = 0x3ff << i_shift;
+    uint16_t i_bits = (((p[0] << 8) | p[1]) & ~i_mask) |
+                      ((i_value << i_shift) & i_mask);
+    p[0] = i_bits >> 8;
+    p[1] = i_bits & 0xff;
+}
+
+static inline uint8_t rfc8331_anc_get_data_count(const uint8_t *p_anc)
+{
+    return rfc8331_anc_get_word(p_anc, 2) & 0xff;
+}
+
+/* size of an ANC data packet carrying i_dc user data words */
+static inline size_t rfc8331_anc_size(uint8_t i_dc)
+{
+    return RFC_8331_ANC_HEADER_LEN + ((4 + i_dc) * 10 + 31) / 32 * 4;
+}
+
+/*****************************************************************************
+ * rfc8331_anc_next
+ *****************************************************************************
+ * Iterates over the ANC data packets of a payload (starting with the payload
+ * header): pass NULL as p_anc to get the first one. Returns NULL at the end
+ * of the payload, or if a packet overflows it.
+ *****************************************************************************/
+static inline const uint8_t *rfc8331_anc_next(const uint8_t *p_payload,
+                                              size_t i_size,
+                                              const uint8_t *p_anc)
+{
+    const uint8_t *p_end;
+
+    if (i_size < RFC_8331_HEADER_LEN)
+        return NULL;
+    if ((size_t)RFC_8331_HEADER_LEN + rfc8331_get_length(p_payload) < i_size)
+        i_size = (size_t)RFC_8331_HEADER_LEN + rfc8331_get_length(p_payload);
+    p_end = p_payload + i_size;
+
+    if (p_anc == NULL)
+        p_anc = p_payload + RFC_8331_HEADER_LEN;
+    else
+        p_anc += rfc8331_anc_size(rfc8331_anc_get_data_count(p_anc));
+
+    if (p_anc + rfc8331_anc_size(0) > p_end ||
+        p_anc + rfc8331_anc_size(rfc8331_anc_get_data_count(p_anc)) > p_end)
+        return NULL;
+    return p_anc;
+}
+
+/*****************************************************************************
+ * rfc8331_anc_to_s291
+ *****************************************************************************
+ * Unpacks an ANC data packet to SMPTE 291 layout (ADF, DID, SDID, DC, UDW,
+ * CS) in p_s291, which must hold S291_HEADER_SIZE + 255 + S291_FOOTER_SIZE
+ * words. Returns false if the parity of the header words or the checksum is
+ * wrong.
+ *****************************************************************************/
+static inline bool rfc8331_anc_to_s291(const uint8_t *p_anc, uint16_t *p_s291)
+{
+    unsigned int i, i_nb;
+
+    p_s291[0] = S291_ADF1;
+    p_s291[1] = S291_ADF2;
+    p_s291[2] = S291_ADF3;
+    p_s291[5] = rfc8331_anc_get_word(p_anc, 2);
+    i_nb = 4 + (p_s291[5] & 0xff);
+    for (i = 0; i < i_nb; i++)
+        p_s291[3 + i] = rfc8331_anc_get_word(p_anc, i);
+
+    for (i = 3; i < S291_HEADER_SIZE; i++)
+        if (s291_parity(p_s291[i] & 0xff) != (p_s291[i] & 0x300))
+            return false;
+    return s291_check_cs(p_s291);
+}
+
+/*****************************************************************************
+ * rfc8331_anc_from_s291
+ *****************************************************************************
+ * Packs a SMPTE 291 packet (DID, SDID, DC, UDW, CS, the ADF is ignored) to
+ * an ANC data packet of rfc8331_anc_size(DC) bytes, and returns its size.
+ * The parity and checksum words must have been set, for instance with
+ * s291_set_udw_parity() and s291_set_cs(). i_stream is only meaningful if
+ * s is set, and 0 is then a valid stream number.
+ *****************************************************************************/
+static inline size_t rfc8331_anc_from_s291(uint8_t *p_anc,
+                                           const uint16_t *p_s291, bool c,
+                                           uint16_t i_line, uint16_t i_offset,
+                                           bool s, uint8_t i_stream)
+{
+    uint8_t i_dc = s291_get_dc(p_s291);
+    size_t i_size = rfc8331_anc_size(i_dc);
+    unsigned int i;
+
+    memset(p_anc, 0, i_size);
+    rfc8331_anc_set_c(p_anc, c);
+    rfc8331_anc_set_line_number(p_anc, i_line);
+    rfc8331_anc_set_horizontal_offset(p_anc, i_offset);
+    rfc8331_anc_set_s(p_anc, s);
+    rfc8331_anc_set_stream_num(p_anc, i_stream);
+    for (i = 0; i < 4u + i_dc; i++)
+        rfc8331_anc_set_word(p_anc, i, p_s291[3 + i]);
+    return i_size;
+}
+
 #ifdef __cplusplus
 }
 #endif
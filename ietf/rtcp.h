@@ -68,6 +68,20 @@ static inline void rtcp_set_length(uint8_t *p_rtcp,
     p_rtcp[3] = length & 0xff;
 }
 
+static inline uint32_t rtcp_get_int_ssrc(const uint8_t *p_rtcp)
+{
+    return ((uint32_t)p_rtcp[4] << 24) | (p_rtcp[5] << 16) |
+           (p_rtcp[6] << 8) | p_rtcp[7];
+}
+
+static inline void rtcp_set_int_ssrc(uint8_t *p_rtcp, uint32_t i_ssrc)
+{
+    p_rtcp[4] = (i_ssrc >> 24) & 0xff;
+    p_rtcp[5] = (i_ssrc >> 16) & 0xff;
+    p_rtcp[6] = (i_ssrc >> 8) & 0xff;
+    p_rtcp[7] = i_ssrc & 0xff;
+}
+
 # include <bitstream/ietf/rtcp_sr.h>
 
 #endif /* !__BITSTREAM_IETF_RTCP_H__ */
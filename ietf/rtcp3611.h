@@ -34,6 +34,7 @@
 #define __BITSTREAM_IETF_RTCP3611_H__
 
 #include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
 
 #ifdef __cplusplus
 extern "C"
@@ -95,13 +96,176 @@ static inline void rtcp_xr_set_length(uint8_t *p_rtcp_xr_b,
     p_rtcp_xr_b[3] = length & 0xff;
 }
 
-/* Loss RLE Report Block
- * TODO */
+/* Loss RLE and Duplicate RLE Report Blocks
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |     BT=1|2    | rsvd. |   T   |         block length          |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                        SSRC of source                         |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |          begin_seq            |             end_seq           |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |          chunk 1              |             chunk 2           |
+ * :                              ...                              :
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
 #define RTCP_XR_LRLER_BT 1
-
-/* Duplicate RLE Report Block
- * TODO */
 #define RTCP_XR_DRLER_BT 2
+#define RTCP_XR_RLE_HEADER_SIZE 12
+#define RTCP_XR_RLE_RUN_MAX 0x3fff
+#define RTCP_XR_RLE_VECTOR_BITS 15
+
+static inline void rtcp_xr_rle_set_thinning(uint8_t *p_rtcp_xr_rle,
+                                            uint8_t thinning)
+{
+    p_rtcp_xr_rle[1] = thinning & 0xf;
+}
+
+static inline uint8_t rtcp_xr_rle_get_thinning(const uint8_t *p_rtcp_xr_rle)
+{
+    return p_rtcp_xr_rle[1] & 0xf;
+}
+
+static inline void rtcp_xr_rle_set_ssrc_source(uint8_t *p_rtcp_xr_rle,
+                                               uint32_t ssrc)
+{
+    p_rtcp_xr_rle[4] = (ssrc >> 24) & 0xff;
+    p_rtcp_xr_rle[5] = (ssrc >> 16) & 0xff;
+    p_rtcp_xr_rle[6] = (ssrc >>  8) & 0xff;
+    p_rtcp_xr_rle[7] =  ssrc        & 0xff;
+}
+
+static inline uint32_t rtcp_xr_rle_get_ssrc_source(const uint8_t *p_rtcp_xr_rle)
+{
+    return ((uint32_t)p_rtcp_xr_rle[4] << 24) | (p_rtcp_xr_rle[5] << 16) |
+        (p_rtcp_xr_rle[6] << 8) | p_rtcp_xr_rle[7];
+}
+
+static inline void rtcp_xr_rle_set_begin_seq(uint8_t *p_rtcp_xr_rle,
+                                             uint16_t begin_seq)
+{
+    p_rtcp_xr_rle[8] = begin_seq >> 8;
+    p_rtcp_xr_rle[9] = begin_seq & 0xff;
+}
+
+static inline uint16_t rtcp_xr_rle_get_begin_seq(const uint8_t *p_rtcp_xr_rle)
+{
+    return (p_rtcp_xr_rle[8] << 8) | p_rtcp_xr_rle[9];
+}
+
+static inline void rtcp_xr_rle_set_end_seq(uint8_t *p_rtcp_xr_rle,
+                                           uint16_t end_seq)
+{
+    p_rtcp_xr_rle[10] = end_seq >> 8;
+    p_rtcp_xr_rle[11] = end_seq & 0xff;
+}
+
+static inline uint16_t rtcp_xr_rle_get_end_seq(const uint8_t *p_rtcp_xr_rle)
+{
+    return (p_rtcp_xr_rle[10] << 8) | p_rtcp_xr_rle[11];
+}
+
+/* returns the number of chunks, including null chunks */
+static inline uint16_t rtcp_xr_rle_get_nb_chunks(const uint8_t *p_rtcp_xr_rle)
+{
+    return 2 * (rtcp_xr_get_length(p_rtcp_xr_rle) - 2);
+}
+
+static inline void rtcp_xr_rle_set_chunk(uint8_t *p_rtcp_xr_rle, uint16_t n,
+                                         uint16_t chunk)
+{
+    p_rtcp_xr_rle[RTCP_XR_RLE_HEADER_SIZE + 2 * n] = chunk >> 8;
+    p_rtcp_xr_rle[RTCP_XR_RLE_HEADER_SIZE + 2 * n + 1] = chunk & 0xff;
+}
+
+static inline uint16_t rtcp_xr_rle_get_chunk(const uint8_t *p_rtcp_xr_rle,
+                                             uint16_t n)
+{
+    return (p_rtcp_xr_rle[RTCP_XR_RLE_HEADER_SIZE + 2 * n] << 8) |
+        p_rtcp_xr_rle[RTCP_XR_RLE_HEADER_SIZE + 2 * n + 1];
+}
+
+/* chunk = 0: null chunk
+ * chunk & 0x8000: bit vector of 15 packets, first one in bit 14
+ * otherwise: run of (chunk & 0x3fff) packets of type !!(chunk & 0x4000) */
+static inline uint16_t rtcp_xr_rle_run_chunk(bool type, uint16_t length)
+{
+    return (type ? 0x4000 : 0) | (length & 0x3fff);
+}
+
+static inline uint16_t rtcp_xr_rle_vector_chunk(uint16_t bits)
+{
+    return 0x8000 | (bits & 0x7fff);
+}
+
+/*****************************************************************************
+ * rtcp_xr_rle_encode
+ *****************************************************************************
+ * Writes the chunks of a RLE block for i_nb packets from bit i_first of
+ * p_bitmap (bit n of a uint64_t word set if packet n was received, or
+ * duplicated), at most i_max_chunks of them. Returns the number of packets
+ * encoded, which is less than i_nb if the chunks did not fit, and sets the
+ * block length.
+ *****************************************************************************/
+static inline uint32_t rtcp_xr_rle_encode(uint8_t *p_rtcp_xr_rle,
+                                          const uint64_t *p_bitmap,
+                                          uint32_t i_first, uint32_t i_nb,
+                                          uint16_t i_max_chunks)
+{
+    uint32_t i = 0;
+    uint16_t i_chunks = 0;
+
+#define RTCP_XR_RLE_BIT(n) \
+    ((p_bitmap[(i_first + (n)) / 64] >> ((i_first + (n)) % 64)) & 1)
+
+    while (i < i_nb && i_chunks < i_max_chunks) {
+        uint64_t i_bit = RTCP_XR_RLE_BIT(i);
+        uint32_t i_run = 1;
+
+        /* measure the run, a word at a time when possible */
+        while (i + i_run < i_nb && i_run < RTCP_XR_RLE_RUN_MAX) {
+            uint32_t i_pos = i_first + i + i_run;
+            if (!(i_pos % 64) && i + i_run + 64 <= i_nb &&
+                i_run + 64 <= RTCP_XR_RLE_RUN_MAX &&
+                p_bitmap[i_pos / 64] == (i_bit ? UINT64_MAX : 0)) {
+                i_run += 64;
+                continue;
+            }
+            if (RTCP_XR_RLE_BIT(i + i_run) != i_bit)
+                break;
+            i_run++;
+        }
+
+        if (i_run >= RTCP_XR_RLE_VECTOR_BITS || i + i_run == i_nb) {
+            rtcp_xr_rle_set_chunk(p_rtcp_xr_rle, i_chunks++,
+                                  rtcp_xr_rle_run_chunk(i_bit, i_run));
+            i += i_run;
+        } else {
+            uint16_t i_bits = 0;
+            uint32_t j;
+            for (j = 0; j < RTCP_XR_RLE_VECTOR_BITS; j++) {
+                i_bits <<= 1;
+                if (i + j < i_nb)
+                    i_bits |= RTCP_XR_RLE_BIT(i + j);
+            }
+            rtcp_xr_rle_set_chunk(p_rtcp_xr_rle, i_chunks++,
+                                  rtcp_xr_rle_vector_chunk(i_bits));
+            i += RTCP_XR_RLE_VECTOR_BITS;
+        }
+    }
+#undef RTCP_XR_RLE_BIT
+
+    if (i > i_nb) {
+        /* the last bit vector went past the end: the extra packets were
+         * reported as lost (not duplicated) */
+        i = i_nb;
+    }
+    if (i_chunks & 1)
+        rtcp_xr_rle_set_chunk(p_rtcp_xr_rle, i_chunks++, 0);
+    rtcp_xr_set_length(p_rtcp_xr_rle, 2 + i_chunks / 2);
+    return i;
+}
 
 /* Packet Receipt Times Report Block
  * TODO */
@@ -195,8 +359,143 @@ static inline void rtcp_xr_dlrr_set_dlrr(uint8_t *p_rtcp_xr_dlrr,
 }
 
 /* Statistics Summary Report Block
- * TODO */
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |     BT=6      |L|D|J|ToH|rsvd.|       block length = 9        |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                        SSRC of source                         |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |          begin_seq            |             end_seq           |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                        lost_packets                           |
+ * |                        dup_packets                            |
+ * |                         min_jitter                            |
+ * |                         max_jitter                            |
+ * |                         mean_jitter                           |
+ * |                         dev_jitter                            |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | min_ttl_or_hl | max_ttl_or_hl |mean_ttl_or_hl | dev_ttl_or_hl |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
 #define RTCP_XR_SSR_BT 6
+#define RTCP_XR_SSR_SIZE 40
+
+#define RTCP_XR_SSR_FLAG_LOST       0x80
+#define RTCP_XR_SSR_FLAG_DUP        0x40
+#define RTCP_XR_SSR_FLAG_JITTER     0x20
+#define RTCP_XR_SSR_TOH_IPV4        0x08
+#define RTCP_XR_SSR_TOH_IPV6        0x10
+
+/* begin_seq, end_seq and SSRC of source are shared with RLE blocks */
+static inline void rtcp_xr_ssr_set_flags(uint8_t *p_rtcp_xr_ssr, uint8_t flags)
+{
+    p_rtcp_xr_ssr[1] = flags;
+}
+
+static inline uint8_t rtcp_xr_ssr_get_flags(const uint8_t *p_rtcp_xr_ssr)
+{
+    return p_rtcp_xr_ssr[1];
+}
+
+static inline void rtcp_xr_ssr_set_lost_packets(uint8_t *p_rtcp_xr_ssr,
+                                      uint32_t lost_packets)
+{
+    p_rtcp_xr_ssr[12] = (lost_packets >> 24) & 0xff;
+    p_rtcp_xr_ssr[13] = (lost_packets >> 16) & 0xff;
+    p_rtcp_xr_ssr[14] = (lost_packets >>  8) & 0xff;
+    p_rtcp_xr_ssr[15] =  lost_packets        & 0xff;
+}
+
+static inline uint32_t rtcp_xr_ssr_get_lost_packets(const uint8_t *p_rtcp_xr_ssr)
+{
+    return ((uint32_t)p_rtcp_xr_ssr[12] << 24) | (p_rtcp_xr_ssr[13] << 16) |
+        (p_rtcp_xr_ssr[14] << 8) | p_rtcp_xr_ssr[15];
+}
+
+static inline void rtcp_xr_ssr_set_dup_packets(uint8_t *p_rtcp_xr_ssr,
+                                      uint32_t dup_packets)
+{
+    p_rtcp_xr_ssr[16] = (dup_packets >> 24) & 0xff;
+    p_rtcp_xr_ssr[17] = (dup_packets >> 16) & 0xff;
+    p_rtcp_xr_ssr[18] = (dup_packets >>  8) & 0xff;
+    p_rtcp_xr_ssr[19] =  dup_packets        & 0xff;
+}
+
+static inline uint32_t rtcp_xr_ssr_get_dup_packets(const uint8_t *p_rtcp_xr_ssr)
+{
+    return ((uint32_t)p_rtcp_xr_ssr[16] << 24) | (p_rtcp_xr_ssr[17] << 16) |
+        (p_rtcp_xr_ssr[18] << 8) | p_rtcp_xr_ssr[19];
+}
+
+static inline void rtcp_xr_ssr_set_min_jitter(uint8_t *p_rtcp_xr_ssr,
+                                      uint32_t min_jitter)
+{
+    p_rtcp_xr_ssr[20] = (min_jitter >> 24) & 0xff;
+    p_rtcp_xr_ssr[21] = (min_jitter >> 16) & 0xff;
+    p_rtcp_xr_ssr[22] = (min_jitter >>  8) & 0xff;
+    p_rtcp_xr_ssr[23] =  min_jitter        & 0xff;
+}
+
+static inline uint32_t rtcp_xr_ssr_get_min_jitter(const uint8_t *p_rtcp_xr_ssr)
+{
+    return ((uint32_t)p_rtcp_xr_ssr[20] << 24) | (p_rtcp_xr_ssr[21] << 16) |
+        (p_rtcp_xr_ssr[22] << 8) | p_rtcp_xr_ssr[23];
+}
+
+static inline void rtcp_xr_ssr_set_max_jitter(uint8_t *p_rtcp_xr_ssr,
+                                      uint32_t max_jitter)
+{
+    p_rtcp_xr_ssr[24] = (max_jitter >> 24) & 0xff;
+    p_rtcp_xr_ssr[25] = (max_jitter >> 16) & 0xff;
+    p_rtcp_xr_ssr[26] = (max_jitter >>  8) & 0xff;
+    p_rtcp_xr_ssr[27] =  max_jitter        & 0xff;
+}
+
+static inline uint32_t rtcp_xr_ssr_get_max_jitter(const uint8_t *p_rtcp_xr_ssr)
+{
+    return ((uint32_t)p_rtcp_xr_ssr[24] << 24) | (p_rtcp_xr_ssr[25] << 16) |
+        (p_rtcp_xr_ssr[26] << 8) | p_rtcp_xr_ssr[27];
+}
+
+static inline void rtcp_xr_ssr_set_mean_jitter(uint8_t *p_rtcp_xr_ssr,
+                                      uint32_t mean_jitter)
+{
+    p_rtcp_xr_ssr[28] = (mean_jitter >> 24) & 0xff;
+    p_rtcp_xr_ssr[29] = (mean_jitter >> 16) & 0xff;
+    p_rtcp_xr_ssr[30] = (mean_jitter >>  8) & 0xff;
+    p_rtcp_xr_ssr[31] =  mean_jitter        & 0xff;
+}
+
+static inline uint32_t rtcp_xr_ssr_get_mean_jitter(const uint8_t *p_rtcp_xr_ssr)
+{
+    return ((uint32_t)p_rtcp_xr_ssr[28] << 24) | (p_rtcp_xr_ssr[29] << 16) |
+        (p_rtcp_xr_ssr[30] << 8) | p_rtcp_xr_ssr[31];
+}
+
+static inline void rtcp_xr_ssr_set_dev_jitter(uint8_t *p_rtcp_xr_ssr,
+                                      uint32_t dev_jitter)
+{
+    p_rtcp_xr_ssr[32] = (dev_jitter >> 24) & 0xff;
+    p_rtcp_xr_ssr[33] = (dev_jitter >> 16) & 0xff;
+    p_rtcp_xr_ssr[34] = (dev_jitter >>  8) & 0xff;
+    p_rtcp_xr_ssr[35] =  dev_jitter        & 0xff;
+}
+
+static inline uint32_t rtcp_xr_ssr_get_dev_jitter(const uint8_t *p_rtcp_xr_ssr)
+{
+    return ((uint32_t)p_rtcp_xr_ssr[32] << 24) | (p_rtcp_xr_ssr[33] << 16) |
+        (p_rtcp_xr_ssr[34] << 8) | p_rtcp_xr_ssr[35];
+}
+
+static inline void rtcp_xr_ssr_set_ttl(uint8_t *p_rtcp_xr_ssr, uint8_t min,
+                                       uint8_t max, uint8_t mean, uint8_t dev)
+{
+    p_rtcp_xr_ssr[36] = min;
+    p_rtcp_xr_ssr[37] = max;
+    p_rtcp_xr_ssr[38] = mean;
+    p_rtcp_xr_ssr[39] = dev;
+}
 
 /* VoIP Metrics Report Block
  * TODO */
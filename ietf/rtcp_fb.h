@@ -40,7 +40,8 @@ static inline void rtcp_fb_set_int_ssrc_pkt_sender(uint8_t *p_rtcp_fb, uint32_t
 
 static inline uint32_t rtcp_fb_get_int_ssrc_pkt_sender(const uint8_t *p_rtcp_fb)
 {
-    return (p_rtcp_fb[4] << 24) | (p_rtcp_fb[5] << 16) | (p_rtcp_fb[6] << 8) | p_rtcp_fb[7];
+    return ((uint32_t)p_rtcp_fb[4] << 24) | (p_rtcp_fb[5] << 16) |
+           (p_rtcp_fb[6] << 8) | p_rtcp_fb[7];
 }
 
 static inline void rtcp_fb_set_ssrc_media_src(uint8_t *p_rtcp_fb,
@@ -52,6 +53,21 @@ static inline void rtcp_fb_set_ssrc_media_src(uint8_t *p_rtcp_fb,
     p_rtcp_fb[11] = pi_ssrc[3];
 }
 
+static inline void rtcp_fb_set_int_ssrc_media_src(uint8_t *p_rtcp_fb,
+                                                  uint32_t i_ssrc)
+{
+    p_rtcp_fb[8] = (i_ssrc >> 24) & 0xff;
+    p_rtcp_fb[9] = (i_ssrc >> 16) & 0xff;
+    p_rtcp_fb[10] = (i_ssrc >> 8) & 0xff;
+    p_rtcp_fb[11] = i_ssrc & 0xff;
+}
+
+static inline uint32_t rtcp_fb_get_int_ssrc_media_src(const uint8_t *p_rtcp_fb)
+{
+    return ((uint32_t)p_rtcp_fb[8] << 24) | (p_rtcp_fb[9] << 16) |
+           (p_rtcp_fb[10] << 8) | p_rtcp_fb[11];
+}
+
 static inline void rtcp_fb_get_ssrc_pkt_sender(const uint8_t *p_rtcp_fb,
                                                uint8_t pi_ssrc[4])
 {
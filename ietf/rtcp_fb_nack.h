@@ -0,0 +1,417 @@
+/*****************************************************************************
+ * rtcp_fb_nack.h: RTCP generic NACK based retransmission
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 4585 Extended RTP Profile for RTCP-Based Feedback (July 2006)
+ *  - IETF RFC 4588 RTP Retransmission Payload Format (July 2006)
+ */
+
+/*
+ * Receiver side, rtcpnack_t tracks missing sequence numbers in a window of
+ * caller-allocated slots (a power of two). A packet is requested once it
+ * has been missing for i_reorder_delay, then again after RTT, 2 RTT, 4 RTT...
+ * until i_max_tries requests were made. Requests are grouped in generic
+ * NACK FCIs (a packet ID and a bitmask of the 16 following packets), and
+ * NACK packets are sent at most every i_min_interval. Dates are in the
+ * caller's clock units.
+ *
+ * Sender side, rtcpnack_store_t keeps the last packets sent, indexed by
+ * sequence number in a ring of caller-allocated slots, and looks up the
+ * packets requested by a NACK packet.
+ *
+ * Typical use:
+ *
+ *   rtcpnack_input(&nack, rtp_get_seqnum(p_rtp), i_now);
+ *   if ((i_size = rtcpnack_build(&nack, i_now, p_buf, sizeof(p_buf))))
+ *       send(p_buf, i_size);
+ *
+ *   p_old = rtcpnack_store_put(&store, p_rtp, i_size, i_now);
+ *   free(p_old);
+ *   ...
+ *   i_nb = rtcpnack_store_nack(&store, p_rtcp, i_rtcp_size, i_now,
+ *                              pp_rtp, pi_sizes, MAX);
+ */
+
+#ifndef __BITSTREAM_IETF_RTCP_FB_NACK_H__
+#define __BITSTREAM_IETF_RTCP_FB_NACK_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rtcp.h>
+#include <bitstream/ietf/rtcp_fb.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTCPNACK_FCI_MAX        64
+
+/*****************************************************************************
+ * Receiver loss tracker
+ *****************************************************************************/
+typedef struct rtcpnack_slot_t {
+    uint64_t i_seqnum;
+    uint64_t i_date;
+    uint8_t i_tries;
+    bool b_missing;
+} rtcpnack_slot_t;
+
+typedef struct rtcpnack_t {
+    rtcpnack_slot_t *p_slots;
+    uint64_t i_mask;
+    uint32_t i_ssrc;
+    uint32_t i_media_ssrc;
+
+    uint64_t i_rtt;
+    uint64_t i_reorder_delay;
+    uint64_t i_min_interval;
+    unsigned int i_max_tries;
+
+    bool b_started;
+    uint64_t i_highest;
+    uint64_t i_first;
+    uint64_t i_nb_missing;
+    uint64_t i_last_nack;
+
+    /* statistics */
+    uint64_t i_lost;
+    uint64_t i_recovered;
+    uint64_t i_abandoned;
+    uint64_t i_requests;
+    uint64_t i_nack_sent;
+} rtcpnack_t;
+
+/*****************************************************************************
+ * rtcpnack_init
+ *****************************************************************************
+ * i_nb_slots must be a power of two, and bounds the age of the packets that
+ * may be requested.
+ *****************************************************************************/
+static inline void rtcpnack_init(rtcpnack_t *p_nack, rtcpnack_slot_t *p_slots,
+                                 uint64_t i_nb_slots, uint32_t i_ssrc,
+                                 uint32_t i_media_ssrc, uint64_t i_rtt,
+                                 uint64_t i_reorder_delay,
+                                 uint64_t i_min_interval,
+                                 unsigned int i_max_tries)
+{
+    memset(p_nack, 0, sizeof(rtcpnack_t));
+    memset(p_slots, 0, i_nb_slots * sizeof(rtcpnack_slot_t));
+    p_nack->p_slots = p_slots;
+    p_nack->i_mask = i_nb_slots - 1;
+    p_nack->i_ssrc = i_ssrc;
+    p_nack->i_media_ssrc = i_media_ssrc;
+    p_nack->i_rtt = i_rtt;
+    p_nack->i_reorder_delay = i_reorder_delay;
+    p_nack->i_min_interval = i_min_interval;
+    p_nack->i_max_tries = i_max_tries;
+}
+
+/* updates the round-trip time, for instance from RTCP LSR/DLSR */
+static inline void rtcpnack_set_rtt(rtcpnack_t *p_nack, uint64_t i_rtt)
+{
+    p_nack->i_rtt = i_rtt;
+}
+
+/* stores sequence number i_seqnum in its slot, with its state */
+static inline void rtcpnack_slot_set(rtcpnack_t *p_nack, uint64_t i_seqnum,
+                                     bool b_missing, uint64_t i_date)
+{
+    rtcpnack_slot_t *p_slot = &p_nack->p_slots[i_seqnum & p_nack->i_mask];
+
+    if (p_slot->b_missing) {
+        /* too old to be requested any more */
+        p_nack->i_abandoned++;
+        p_nack->i_nb_missing--;
+    }
+    p_slot->i_seqnum = i_seqnum;
+    p_slot->i_date = i_date;
+    p_slot->i_tries = 0;
+    p_slot->b_missing = b_missing;
+    if (b_missing)
+        p_nack->i_nb_missing++;
+}
+
+/*****************************************************************************
+ * rtcpnack_input
+ *****************************************************************************
+ * Accounts for a received RTP packet.
+ *****************************************************************************/
+static inline void rtcpnack_input(rtcpnack_t *p_nack, uint16_t i_seqnum,
+                                  uint64_t i_date)
+{
+    uint64_t i_seq;
+
+    if (!p_nack->b_started) {
+        p_nack->b_started = true;
+        p_nack->i_highest = p_nack->i_first = rtp_seqnum_extend(0, i_seqnum);
+        rtcpnack_slot_set(p_nack, p_nack->i_highest, false, i_date);
+        return;
+    }
+
+    i_seq = rtp_seqnum_extend(p_nack->i_highest, i_seqnum);
+    if (i_seq > p_nack->i_highest) {
+        uint64_t i_missing = i_seq - p_nack->i_highest - 1;
+        uint64_t i;
+
+        p_nack->i_lost += i_missing;
+        if (i_missing > p_nack->i_mask)
+            i_missing = p_nack->i_mask;
+        for (i = i_seq - i_missing; i < i_seq; i++)
+            rtcpnack_slot_set(p_nack, i, true,
+                              i_date + p_nack->i_reorder_delay);
+        rtcpnack_slot_set(p_nack, i_seq, false, i_date);
+        p_nack->i_highest = i_seq;
+        if (p_nack->i_first + p_nack->i_mask < i_seq)
+            p_nack->i_first = i_seq - p_nack->i_mask;
+    } else if (i_seq + p_nack->i_mask >= p_nack->i_highest) {
+        rtcpnack_slot_t *p_slot = &p_nack->p_slots[i_seq & p_nack->i_mask];
+        if (p_slot->i_seqnum == i_seq && p_slot->b_missing) {
+            p_slot->b_missing = false;
+            p_nack->i_nb_missing--;
+            if (p_slot->i_tries)
+                p_nack->i_recovered++;
+            p_nack->i_lost--;
+        }
+    }
+}
+
+/* returns true if i_seq is to be requested at date i_now */
+static inline bool rtcpnack_due(const rtcpnack_t *p_nack, uint64_t i_seq,
+                                uint64_t i_now)
+{
+    const rtcpnack_slot_t *p_slot = &p_nack->p_slots[i_seq & p_nack->i_mask];
+    return p_slot->b_missing && p_slot->i_seqnum == i_seq &&
+           p_slot->i_date <= i_now;
+}
+
+/* schedules the next request of i_seq, with exponential backoff */
+static inline void rtcpnack_request(rtcpnack_t *p_nack, uint64_t i_seq,
+                                    uint64_t i_now)
+{
+    rtcpnack_slot_t *p_slot = &p_nack->p_slots[i_seq & p_nack->i_mask];
+
+    p_nack->i_requests++;
+    if (++p_slot->i_tries >= p_nack->i_max_tries) {
+        /* last chance */
+        p_slot->b_missing = false;
+        p_nack->i_nb_missing--;
+        p_nack->i_abandoned++;
+        return;
+    }
+    p_slot->i_date = i_now + (p_nack->i_rtt << (p_slot->i_tries - 1 < 4 ?
+                                                p_slot->i_tries - 1 : 4));
+}
+
+/*****************************************************************************
+ * rtcpnack_build
+ *****************************************************************************
+ * Writes a generic NACK packet to p_buf for the packets due at date i_now,
+ * and returns its size, or 0 if there is nothing to request yet.
+ *****************************************************************************/
+static inline size_t rtcpnack_build(rtcpnack_t *p_nack, uint64_t i_now,
+                                    uint8_t *p_buf, size_t i_buf_size)
+{
+    size_t i_size = RTCP_FB_HEADER_SIZE;
+    uint64_t i_seq;
+
+    if (!p_nack->i_nb_missing || (p_nack->i_last_nack &&
+         i_now < p_nack->i_last_nack + p_nack->i_min_interval))
+        return 0;
+
+    /* skip what was received or given up at the head of the window */
+    while (p_nack->i_first < p_nack->i_highest &&
+           !p_nack->p_slots[p_nack->i_first & p_nack->i_mask].b_missing)
+        p_nack->i_first++;
+
+    for (i_seq = p_nack->i_first; i_seq < p_nack->i_highest &&
+         i_size + RTCP_FB_FCI_GENERIC_NACK_SIZE <= i_buf_size &&
+         i_size < RTCP_FB_HEADER_SIZE +
+                  RTCPNACK_FCI_MAX * RTCP_FB_FCI_GENERIC_NACK_SIZE; i_seq++) {
+        uint8_t *p_fci = p_buf + i_size;
+        uint16_t i_blp = 0;
+        unsigned int i;
+
+        if (!rtcpnack_due(p_nack, i_seq, i_now))
+            continue;
+
+        for (i = 0; i < 16 && i_seq + 1 + i < p_nack->i_highest; i++)
+            if (rtcpnack_due(p_nack, i_seq + 1 + i, i_now)) {
+                i_blp |= 1 << i;
+                rtcpnack_request(p_nack, i_seq + 1 + i, i_now);
+            }
+        rtcpnack_request(p_nack, i_seq, i_now);
+
+        rtcp_fb_nack_set_packet_id(p_fci, i_seq & 0xffff);
+        rtcp_fb_nack_set_bitmask_lost(p_fci, i_blp);
+        i_size += RTCP_FB_FCI_GENERIC_NACK_SIZE;
+        i_seq += 16;
+    }
+    if (i_size == RTCP_FB_HEADER_SIZE)
+        return 0;
+
+    rtcp_set_rtp_version(p_buf);
+    rtcp_fb_set_fmt(p_buf, RTCP_PT_RTPFB_GENERIC_NACK);
+    rtcp_set_pt(p_buf, RTCP_PT_RTPFB);
+    rtcp_set_length(p_buf, i_size / 4 - 1);
+    rtcp_fb_set_int_ssrc_pkt_sender(p_buf, p_nack->i_ssrc);
+    rtcp_fb_set_int_ssrc_media_src(p_buf, p_nack->i_media_ssrc);
+    p_nack->i_last_nack = i_now;
+    p_nack->i_nack_sent++;
+    return i_size;
+}
+
+/*****************************************************************************
+ * Sender retransmission store
+ *****************************************************************************/
+typedef struct rtcpnack_store_slot_t {
+    uint8_t *p_rtp;
+    size_t i_size;
+    uint64_t i_date;
+    uint64_t i_resent;
+} rtcpnack_store_slot_t;
+
+typedef struct rtcpnack_store_t {
+    rtcpnack_store_slot_t *p_slots;
+    uint16_t i_mask;
+    uint64_t i_min_resend;
+
+    /* statistics */
+    uint64_t i_requested;
+    uint64_t i_resent;
+    uint64_t i_missed;
+} rtcpnack_store_t;
+
+/*****************************************************************************
+ * rtcpnack_store_init
+ *****************************************************************************
+ * i_nb_slots must be a power of two, at most 65536. A packet is not sent
+ * again less than i_min_resend after its previous retransmission.
+ *****************************************************************************/
+static inline void rtcpnack_store_init(rtcpnack_store_t *p_store,
+                                       rtcpnack_store_slot_t *p_slots,
+                                       uint32_t i_nb_slots,
+                                       uint64_t i_min_resend)
+{
+    memset(p_store, 0, sizeof(rtcpnack_store_t));
+    memset(p_slots, 0, i_nb_slots * sizeof(rtcpnack_store_slot_t));
+    p_store->p_slots = p_slots;
+    p_store->i_mask = i_nb_slots - 1;
+    p_store->i_min_resend = i_min_resend;
+}
+
+/* keeps a packet sent, and returns the packet it replaces (or NULL), which
+ * the caller may release */
+static inline uint8_t *rtcpnack_store_put(rtcpnack_store_t *p_store,
+                                          uint8_t *p_rtp, size_t i_size,
+                                          uint64_t i_date)
+{
+    rtcpnack_store_slot_t *p_slot =
+        &p_store->p_slots[rtp_get_seqnum(p_rtp) & p_store->i_mask];
+    uint8_t *p_old = p_slot->p_rtp;
+
+    p_slot->p_rtp = p_rtp;
+    p_slot->i_size = i_size;
+    p_slot->i_date = i_date;
+    p_slot->i_resent = 0;
+    return p_old;
+}
+
+/* returns the packet of sequence number i_seqnum, or NULL */
+static inline uint8_t *rtcpnack_store_get(rtcpnack_store_t *p_store,
+                                          uint16_t i_seqnum, size_t *pi_size)
+{
+    rtcpnack_store_slot_t *p_slot = &p_store->p_slots[i_seqnum & p_store->i_mask];
+
+    if (p_slot->p_rtp == NULL || rtp_get_seqnum(p_slot->p_rtp) != i_seqnum)
+        return NULL;
+    *pi_size = p_slot->i_size;
+    return p_slot->p_rtp;
+}
+
+/*****************************************************************************
+ * rtcpnack_store_nack
+ *****************************************************************************
+ * Looks up the packets requested by a generic NACK packet, and stores at
+ * most i_max of them in pp_rtp/pi_sizes for the caller to send again.
+ * Returns the number of packets stored.
+ *****************************************************************************/
+static inline unsigned int rtcpnack_store_nack(rtcpnack_store_t *p_store,
+                                               const uint8_t *p_rtcp,
+                                               size_t i_size, uint64_t i_now,
+                                               uint8_t **pp_rtp,
+                                               size_t *pi_sizes,
+                                               unsigned int i_max)
+{
+    const uint8_t *p_fci = p_rtcp + RTCP_FB_HEADER_SIZE;
+    unsigned int i_nb = 0;
+    size_t i_length;
+
+    if (i_size < RTCP_FB_HEADER_SIZE || rtcp_get_pt(p_rtcp) != RTCP_PT_RTPFB ||
+        rtcp_fb_get_fmt(p_rtcp) != RTCP_PT_RTPFB_GENERIC_NACK)
+        return 0;
+    i_length = 4 * ((size_t)rtcp_get_length(p_rtcp) + 1);
+    if (i_length < i_size)
+        i_size = i_length;
+
+    for ( ; p_fci + RTCP_FB_FCI_GENERIC_NACK_SIZE <= p_rtcp + i_size;
+          p_fci += RTCP_FB_FCI_GENERIC_NACK_SIZE) {
+        uint16_t i_pid = rtcp_fb_nack_get_packet_id(p_fci);
+        uint32_t i_mask = 1 | ((uint32_t)rtcp_fb_nack_get_bitmask_lost(p_fci) << 1);
+        unsigned int i;
+
+        for (i = 0; i < 17 && i_nb < i_max; i++) {
+            rtcpnack_store_slot_t *p_slot;
+            uint16_t i_seqnum = i_pid + i;
+            if (!(i_mask & (1 << i)))
+                continue;
+            p_store->i_requested++;
+            p_slot = &p_store->p_slots[i_seqnum & p_store->i_mask];
+            if (p_slot->p_rtp == NULL ||
+                rtp_get_seqnum(p_slot->p_rtp) != i_seqnum) {
+                p_store->i_missed++;
+                continue;
+            }
+            if (p_slot->i_resent && i_now < p_slot->i_resent +
+                                            p_store->i_min_resend)
+                continue;
+            p_slot->i_resent = i_now;
+            pp_rtp[i_nb] = p_slot->p_rtp;
+            pi_sizes[i_nb] = p_slot->i_size;
+            i_nb++;
+        }
+    }
+    p_store->i_resent += i_nb;
+    return i_nb;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
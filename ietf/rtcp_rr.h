@@ -5,6 +5,7 @@
 # include <bitstream/ietf/rtcp.h>
 
 # define RTCP_RR_SIZE 32
+# define RTCP_RR_BLOCK_SIZE 24
 
 # define RTCP_PT_RR 201
 
@@ -13,6 +14,22 @@ static inline void rtcp_rr_set_pt(uint8_t *p_rtcp_rr)
     rtcp_set_pt(p_rtcp_rr, RTCP_PT_RR);
 }
 
+/* report block n is accessed with p_rtcp_rr + n * RTCP_RR_BLOCK_SIZE */
+static inline uint32_t rtcp_rr_get_int_ssrc_source(const uint8_t *p_rtcp_rr)
+{
+    return ((uint32_t)p_rtcp_rr[8] << 24) | (p_rtcp_rr[9] << 16) |
+           (p_rtcp_rr[10] << 8) | p_rtcp_rr[11];
+}
+
+static inline void rtcp_rr_set_int_ssrc_source(uint8_t *p_rtcp_rr,
+        uint32_t i_ssrc)
+{
+    p_rtcp_rr[8] = (i_ssrc >> 24) & 0xff;
+    p_rtcp_rr[9] = (i_ssrc >> 16) & 0xff;
+    p_rtcp_rr[10] = (i_ssrc >> 8) & 0xff;
+    p_rtcp_rr[11] = i_ssrc & 0xff;
+}
+
 static inline uint8_t rtcp_rr_get_fraction_lost(const uint8_t *p_rtcp_rr)
 {
     return p_rtcp_rr[12];
@@ -8,6 +8,8 @@
 
 # define RTCP_PT_SDES 202
 
+# define RTCP_SDES_CNAME 1
+
 static inline void rtcp_sdes_set_pt(uint8_t *p_rtcp_rr)
 {
     rtcp_set_pt(p_rtcp_rr, RTCP_PT_SDES);
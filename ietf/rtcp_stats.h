@@ -0,0 +1,412 @@
+/*****************************************************************************
+ * rtcp_stats.h: RTCP receiver report statistics
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * Reception statistics are kept per SSRC in a flat, open-addressing hash
+ * table of caller-allocated entries (a power of two, which should be at
+ * least twice the expected number of sources), so that each RTP packet
+ * costs one lookup and a few additions. They follow RFC 3550 appendix A:
+ * sequence number validation (A.1), loss (A.3), interarrival jitter (A.8)
+ * and LSR/DLSR from sender reports. Compound RR + SDES packets are written
+ * at the randomized interval of A.7. Dates are in microseconds.
+ *
+ * Typical use:
+ *
+ *   rtcpstats_input(&s, p_rtp, i_now);
+ *   ...
+ *   if (rtcp_get_pt(p_rtcp) == RTCP_PT_SR)
+ *       rtcpstats_sr(&s, p_rtcp, i_now);
+ *   ...
+ *   if ((i_size = rtcpstats_report(&s, i_now, p_buf, sizeof(p_buf))))
+ *       send(p_buf, i_size);
+ */
+
+#ifndef __BITSTREAM_IETF_RTCP_STATS_H__
+#define __BITSTREAM_IETF_RTCP_STATS_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset, memmove */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rtcp.h>
+#include <bitstream/ietf/rtcp_rr.h>
+#include <bitstream/ietf/rtcp_sdes.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTCPSTATS_MAX_DROPOUT       3000
+#define RTCPSTATS_MAX_MISORDER      100
+#define RTCPSTATS_MAX_BLOCKS        31
+#define RTCPSTATS_MIN_INTERVAL      5000000 /* us */
+#define RTCPSTATS_CNAME_MAX         255
+
+typedef struct rtcpstats_source_t {
+    bool b_used;
+    uint32_t i_ssrc;
+
+    /* sequence numbers, extended as by rtp_seqnum_extend() */
+    uint64_t i_base_seq;
+    uint64_t i_max_seq;
+    uint32_t i_bad_seq;
+    uint64_t i_received;
+    uint64_t i_expected_prior;
+    uint64_t i_received_prior;
+
+    /* jitter, in timestamp units * 16 */
+    uint32_t i_transit;
+    uint32_t i_jitter;
+
+    /* last sender report */
+    uint32_t i_lsr;
+    uint64_t i_lsr_date;
+
+    uint64_t i_last_date;
+    bool b_reported;
+} rtcpstats_source_t;
+
+typedef struct rtcpstats_t {
+    rtcpstats_source_t *p_sources;
+    uint32_t i_mask;
+    uint32_t i_nb_sources;
+
+    uint32_t i_ssrc;
+    uint64_t i_clock_rate;
+    char psz_cname[RTCPSTATS_CNAME_MAX + 1];
+
+    /* RTCP bandwidth in bytes per second, or 0 for the minimum interval */
+    uint64_t i_rtcp_bw;
+    uint64_t i_avg_rtcp_size;
+    uint64_t i_next_report;
+    uint32_t i_report_pos;
+    uint32_t i_seed;
+} rtcpstats_t;
+
+/*****************************************************************************
+ * rtcpstats_init
+ *****************************************************************************
+ * i_nb_sources must be a power of two. i_clock_rate is the RTP timestamp
+ * frequency, i_ssrc and psz_cname identify our reports.
+ *****************************************************************************/
+static inline void rtcpstats_init(rtcpstats_t *p_stats,
+                                  rtcpstats_source_t *p_sources,
+                                  uint32_t i_nb_sources, uint32_t i_ssrc,
+                                  const char *psz_cname, uint64_t i_clock_rate,
+                                  uint64_t i_rtcp_bw, uint64_t i_now)
+{
+    memset(p_stats, 0, sizeof(rtcpstats_t));
+    memset(p_sources, 0, i_nb_sources * sizeof(rtcpstats_source_t));
+    p_stats->p_sources = p_sources;
+    p_stats->i_mask = i_nb_sources - 1;
+    p_stats->i_ssrc = i_ssrc;
+    strncpy(p_stats->psz_cname, psz_cname, RTCPSTATS_CNAME_MAX);
+    p_stats->i_clock_rate = i_clock_rate;
+    p_stats->i_rtcp_bw = i_rtcp_bw;
+    p_stats->i_avg_rtcp_size = 128;
+    p_stats->i_seed = i_ssrc | 1;
+    /* half the minimum interval for the first report */
+    p_stats->i_next_report = i_now + RTCPSTATS_MIN_INTERVAL / 2;
+}
+
+static inline uint32_t rtcpstats_hash(const rtcpstats_t *p_stats,
+                                      uint32_t i_ssrc)
+{
+    return (i_ssrc * UINT32_C(0x9e3779b1)) & p_stats->i_mask;
+}
+
+/*****************************************************************************
+ * rtcpstats_find
+ *****************************************************************************
+ * Returns the state of a source, creating it if b_create is set, or NULL if
+ * it is unknown or the table is full.
+ *****************************************************************************/
+static inline rtcpstats_source_t *rtcpstats_find(rtcpstats_t *p_stats,
+                                                 uint32_t i_ssrc,
+                                                 bool b_create)
+{
+    uint32_t i = rtcpstats_hash(p_stats, i_ssrc);
+
+    for ( ; ; ) {
+        rtcpstats_source_t *p_source = &p_stats->p_sources[i];
+        if (!p_source->b_used) {
+            /* keep one entry free to end lookups */
+            if (!b_create || p_stats->i_nb_sources == p_stats->i_mask)
+                return NULL;
+            memset(p_source, 0, sizeof(rtcpstats_source_t));
+            p_source->b_used = true;
+            p_source->i_ssrc = i_ssrc;
+            p_stats->i_nb_sources++;
+            return p_source;
+        }
+        if (p_source->i_ssrc == i_ssrc)
+            return p_source;
+        i = (i + 1) & p_stats->i_mask;
+    }
+}
+
+/* removes a source, moving back the entries of its cluster */
+static inline void rtcpstats_remove(rtcpstats_t *p_stats,
+                                    rtcpstats_source_t *p_source)
+{
+    uint32_t i = p_source - p_stats->p_sources, j = i;
+
+    for ( ; ; ) {
+        uint32_t k;
+        p_stats->p_sources[i].b_used = false;
+        for ( ; ; ) {
+            j = (j + 1) & p_stats->i_mask;
+            if (!p_stats->p_sources[j].b_used) {
+                p_stats->i_nb_sources--;
+                return;
+            }
+            k = rtcpstats_hash(p_stats, p_stats->p_sources[j].i_ssrc);
+            /* move j to i unless its home k lies cyclically in ]i, j] */
+            if (i <= j ? (i >= k || k > j) : (i >= k && k > j))
+                break;
+        }
+        p_stats->p_sources[i] = p_stats->p_sources[j];
+        i = j;
+    }
+}
+
+/* forgets the sources not heard from since i_timeout */
+static inline void rtcpstats_expire(rtcpstats_t *p_stats, uint64_t i_now,
+                                    uint64_t i_timeout)
+{
+    uint32_t i = 0;
+
+    while (i <= p_stats->i_mask) {
+        rtcpstats_source_t *p_source = &p_stats->p_sources[i];
+        if (p_source->b_used && p_source->i_last_date + i_timeout < i_now)
+            rtcpstats_remove(p_stats, p_source); /* examine i again */
+        else
+            i++;
+    }
+}
+
+static inline void rtcpstats_restart(rtcpstats_source_t *p_source,
+                                     uint16_t i_seqnum)
+{
+    p_source->i_base_seq = p_source->i_max_seq =
+        rtp_seqnum_extend(0, i_seqnum);
+    p_source->i_bad_seq = UINT32_MAX;
+    p_source->i_received = 0;
+    p_source->i_expected_prior = p_source->i_received_prior = 0;
+}
+
+/*****************************************************************************
+ * rtcpstats_input
+ *****************************************************************************
+ * Accounts for a received RTP packet. Returns false if its sequence number
+ * is invalid (see RFC 3550 A.1), or if the table is full.
+ *****************************************************************************/
+static inline bool rtcpstats_input(rtcpstats_t *p_stats, const uint8_t *p_rtp,
+                                   uint64_t i_date)
+{
+    rtcpstats_source_t *p_source;
+    uint16_t i_seqnum = rtp_get_seqnum(p_rtp);
+    uint32_t i_arrival, i_transit;
+    uint64_t i_seq;
+    int32_t i_d;
+
+    p_source = rtcpstats_find(p_stats, rtp_get_int_ssrc(p_rtp), true);
+    if (p_source == NULL)
+        return false;
+    if (!p_source->i_max_seq)
+        rtcpstats_restart(p_source, i_seqnum);
+
+    i_seq = rtp_seqnum_extend(p_source->i_max_seq, i_seqnum);
+    if (i_seq > p_source->i_max_seq) {
+        if (i_seq - p_source->i_max_seq < RTCPSTATS_MAX_DROPOUT)
+            p_source->i_max_seq = i_seq;
+        else if (i_seqnum == p_source->i_bad_seq)
+            /* two sequential packets: the source restarted */
+            rtcpstats_restart(p_source, i_seqnum);
+        else {
+            p_source->i_bad_seq = (uint16_t)(i_seqnum + 1);
+            return false;
+        }
+    } else if (p_source->i_max_seq - i_seq > RTCPSTATS_MAX_MISORDER &&
+               p_source->i_max_seq - i_seq < 0x10000 - RTCPSTATS_MAX_DROPOUT) {
+        if (i_seqnum == p_source->i_bad_seq)
+            rtcpstats_restart(p_source, i_seqnum);
+        else {
+            p_source->i_bad_seq = (uint16_t)(i_seqnum + 1);
+            return false;
+        }
+    } else if (i_seq < p_source->i_base_seq)
+        p_source->i_base_seq = i_seq;
+    p_source->i_received++;
+
+    /* interarrival jitter, in timestamp units */
+    i_arrival = (i_date / 1000000) * p_stats->i_clock_rate +
+                (i_date % 1000000) * p_stats->i_clock_rate / 1000000;
+    i_transit = i_arrival - rtp_get_timestamp(p_rtp);
+    if (p_source->i_last_date) {
+        i_d = (int32_t)(i_transit - p_source->i_transit);
+        if (i_d < 0)
+            i_d = -i_d;
+        p_source->i_jitter += i_d - ((p_source->i_jitter + 8) >> 4);
+    }
+    p_source->i_transit = i_transit;
+    p_source->i_last_date = i_date;
+    p_source->b_reported = true;
+    return true;
+}
+
+/* records a sender report for LSR/DLSR */
+static inline void rtcpstats_sr(rtcpstats_t *p_stats, const uint8_t *p_rtcp_sr,
+                                uint64_t i_date)
+{
+    rtcpstats_source_t *p_source =
+        rtcpstats_find(p_stats, rtcp_get_int_ssrc(p_rtcp_sr), false);
+
+    if (p_source == NULL)
+        return;
+    p_source->i_lsr = (rtcp_sr_get_ntp_time_msw(p_rtcp_sr) << 16) |
+                      (rtcp_sr_get_ntp_time_lsw(p_rtcp_sr) >> 16);
+    p_source->i_lsr_date = i_date;
+}
+
+/* writes a report block for a source */
+static inline void rtcpstats_block(rtcpstats_source_t *p_source,
+                                   uint8_t *p_block, uint64_t i_date)
+{
+    uint64_t i_expected = p_source->i_max_seq - p_source->i_base_seq + 1;
+    int64_t i_lost = (int64_t)(i_expected - p_source->i_received);
+    uint64_t i_expected_interval = i_expected - p_source->i_expected_prior;
+    uint64_t i_received_interval = p_source->i_received -
+                                   p_source->i_received_prior;
+    int64_t i_lost_interval = (int64_t)(i_expected_interval -
+                                        i_received_interval);
+
+    p_source->i_expected_prior = i_expected;
+    p_source->i_received_prior = p_source->i_received;
+
+    rtcp_rr_set_int_ssrc_source(p_block, p_source->i_ssrc);
+    rtcp_rr_set_fraction_lost(p_block,
+        !i_expected_interval || i_lost_interval <= 0 ? 0 :
+        (i_lost_interval << 8) / i_expected_interval);
+    rtcp_rr_set_cumulative_packets_lost(p_block,
+        i_lost > 0x7fffff ? 0x7fffff : i_lost < -0x800000 ? -0x800000 :
+        (int32_t)i_lost);
+    rtcp_rr_set_highest_seqnum(p_block,
+                               (uint32_t)(p_source->i_max_seq - 0x10000));
+    rtcp_rr_set_inter_arrival_jitter(p_block, p_source->i_jitter >> 4);
+    rtcp_rr_set_last_sr(p_block, p_source->i_lsr);
+    rtcp_rr_set_delay_since_last_sr(p_block, !p_source->i_lsr_date ? 0 :
+        ((i_date - p_source->i_lsr_date) << 16) / 1000000);
+}
+
+/* returns a pseudo-random interval within [0.5, 1.5] * T / (e - 3/2) */
+static inline uint64_t rtcpstats_interval(rtcpstats_t *p_stats)
+{
+    uint64_t i_interval = RTCPSTATS_MIN_INTERVAL;
+
+    if (p_stats->i_rtcp_bw) {
+        /* receivers get 75 % of the RTCP bandwidth */
+        uint64_t i_t = p_stats->i_avg_rtcp_size * (p_stats->i_nb_sources + 1) *
+                       4000000 / (3 * p_stats->i_rtcp_bw);
+        if (i_t > i_interval)
+            i_interval = i_t;
+    }
+    p_stats->i_seed ^= p_stats->i_seed << 13;
+    p_stats->i_seed ^= p_stats->i_seed >> 17;
+    p_stats->i_seed ^= p_stats->i_seed << 5;
+    i_interval = i_interval / 2 + i_interval * (p_stats->i_seed & 0xffff) / 0x10000;
+    return i_interval * 1000 / 1218;
+}
+
+/*****************************************************************************
+ * rtcpstats_report
+ *****************************************************************************
+ * Writes a compound RR + SDES packet to p_buf if one is due at date i_now,
+ * and returns its size, or 0. Up to RTCPSTATS_MAX_BLOCKS sources heard
+ * since the previous report are included, in turn if there are more.
+ *****************************************************************************/
+static inline size_t rtcpstats_report(rtcpstats_t *p_stats, uint64_t i_now,
+                                      uint8_t *p_buf, size_t i_buf_size)
+{
+    size_t i_cname = strlen(p_stats->psz_cname);
+    size_t i_sdes_size = (RTCP_SDES_SIZE + i_cname + 4) & ~(size_t)3;
+    size_t i_size = RTCP_RR_SIZE - RTCP_RR_BLOCK_SIZE;
+    uint32_t i, i_nb = 0;
+    uint8_t *p_sdes;
+
+    if (i_now < p_stats->i_next_report)
+        return 0;
+    if (i_buf_size < i_size + RTCPSTATS_MAX_BLOCKS * RTCP_RR_BLOCK_SIZE +
+                     i_sdes_size)
+        return 0;
+
+    for (i = 0; i <= p_stats->i_mask && i_nb < RTCPSTATS_MAX_BLOCKS; i++) {
+        rtcpstats_source_t *p_source = &p_stats->p_sources[
+            (p_stats->i_report_pos + i) & p_stats->i_mask];
+        if (!p_source->b_used || !p_source->b_reported)
+            continue;
+        p_source->b_reported = false;
+        rtcpstats_block(p_source, p_buf + i_nb * RTCP_RR_BLOCK_SIZE, i_now);
+        i_nb++;
+    }
+    p_stats->i_report_pos = (p_stats->i_report_pos + i) & p_stats->i_mask;
+    i_size += i_nb * RTCP_RR_BLOCK_SIZE;
+
+    rtcp_set_rtp_version(p_buf);
+    rtcp_set_rc(p_buf, i_nb);
+    rtcp_rr_set_pt(p_buf);
+    rtcp_set_length(p_buf, i_size / 4 - 1);
+    rtcp_set_int_ssrc(p_buf, p_stats->i_ssrc);
+
+    /* CNAME item, then null octets up to a 32-bit boundary */
+    p_sdes = p_buf + i_size;
+    memset(p_sdes, 0, i_sdes_size);
+    rtcp_set_rtp_version(p_sdes);
+    rtcp_set_rc(p_sdes, 1);
+    rtcp_sdes_set_pt(p_sdes);
+    rtcp_set_length(p_sdes, i_sdes_size / 4 - 1);
+    rtcp_set_int_ssrc(p_sdes, p_stats->i_ssrc);
+    rtcp_sdes_set_cname(p_sdes, RTCP_SDES_CNAME);
+    rtcp_sdes_set_name_length(p_sdes, i_cname);
+    memcpy(p_sdes + RTCP_SDES_SIZE, p_stats->psz_cname, i_cname);
+    i_size += i_sdes_size;
+
+    p_stats->i_avg_rtcp_size = (p_stats->i_avg_rtcp_size * 15 +
+                                i_size + 28) / 16; /* with UDP/IP headers */
+    p_stats->i_next_report = i_now + rtcpstats_interval(p_stats);
+    return i_size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,310 @@
+/*****************************************************************************
+ * rtcp_xr_stats.h: RTCP XR loss, duplicate and statistics reports
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 3611 RTP Control Protocol Extended Reports (November 2003)
+ */
+
+/*
+ * Reception of a source over a reporting interval is recorded in two
+ * caller-allocated bitmaps (one bit per sequence number, received and
+ * duplicated), from which Loss RLE, Duplicate RLE and Statistics Summary
+ * report blocks are generated. i_nb_bits bounds the number of packets per
+ * interval; when a packet does not fit, rtcpxr_input() fails and a report
+ * must be generated first. Dates are in microseconds.
+ *
+ * Typical use:
+ *
+ *   if (!rtcpxr_input(&xr, p_rtp, i_now)) {
+ *       send(p_buf, rtcpxr_report(&xr, p_buf, sizeof(p_buf)));
+ *       rtcpxr_input(&xr, p_rtp, i_now);
+ *   }
+ */
+
+#ifndef __BITSTREAM_IETF_RTCP_XR_STATS_H__
+#define __BITSTREAM_IETF_RTCP_XR_STATS_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rtcp.h>
+#include <bitstream/ietf/rtcp3611.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct rtcpxr_t {
+    uint64_t *p_received;
+    uint64_t *p_duplicate;
+    uint32_t i_nb_bits;
+    uint32_t i_ssrc;
+    uint32_t i_source_ssrc;
+    uint64_t i_clock_rate;
+
+    bool b_started;
+    uint64_t i_begin;
+    uint64_t i_end;
+
+    /* jitter, in timestamp units */
+    bool b_transit;
+    uint32_t i_transit;
+    uint32_t i_min_jitter;
+    uint32_t i_max_jitter;
+    uint64_t i_sum_jitter;
+    uint64_t i_sum2_jitter;
+    uint32_t i_nb_jitter;
+} rtcpxr_t;
+
+/*****************************************************************************
+ * rtcpxr_init
+ *****************************************************************************
+ * p_received and p_duplicate hold i_nb_bits bits each, a multiple of 64.
+ *****************************************************************************/
+static inline void rtcpxr_init(rtcpxr_t *p_xr, uint64_t *p_received,
+                               uint64_t *p_duplicate, uint32_t i_nb_bits,
+                               uint32_t i_ssrc, uint32_t i_source_ssrc,
+                               uint64_t i_clock_rate)
+{
+    memset(p_xr, 0, sizeof(rtcpxr_t));
+    memset(p_received, 0, i_nb_bits / 8);
+    memset(p_duplicate, 0, i_nb_bits / 8);
+    p_xr->p_received = p_received;
+    p_xr->p_duplicate = p_duplicate;
+    p_xr->i_nb_bits = i_nb_bits;
+    p_xr->i_ssrc = i_ssrc;
+    p_xr->i_source_ssrc = i_source_ssrc;
+    p_xr->i_clock_rate = i_clock_rate;
+    p_xr->i_min_jitter = UINT32_MAX;
+}
+
+/*****************************************************************************
+ * rtcpxr_input
+ *****************************************************************************
+ * Records a received RTP packet. Returns false if it is beyond the current
+ * interval, in which case it was not recorded. Packets preceding the
+ * interval are ignored.
+ *****************************************************************************/
+static inline bool rtcpxr_input(rtcpxr_t *p_xr, const uint8_t *p_rtp,
+                                uint64_t i_date)
+{
+    uint64_t i_seq, i_bit, i_mask;
+    uint32_t i_arrival, i_transit;
+
+    if (!p_xr->b_started) {
+        p_xr->b_started = true;
+        p_xr->i_begin = p_xr->i_end =
+            rtp_seqnum_extend(0, rtp_get_seqnum(p_rtp));
+    }
+    i_seq = rtp_seqnum_extend(p_xr->i_end ? p_xr->i_end - 1 : 0,
+                              rtp_get_seqnum(p_rtp));
+    if (i_seq < p_xr->i_begin)
+        return true;
+    if (i_seq - p_xr->i_begin >= p_xr->i_nb_bits)
+        return false;
+
+    i_bit = i_seq - p_xr->i_begin;
+    i_mask = UINT64_C(1) << (i_bit % 64);
+    if (p_xr->p_received[i_bit / 64] & i_mask) {
+        p_xr->p_duplicate[i_bit / 64] |= i_mask;
+        return true;
+    }
+    p_xr->p_received[i_bit / 64] |= i_mask;
+    if (i_seq >= p_xr->i_end)
+        p_xr->i_end = i_seq + 1;
+
+    /* RFC 3611 4.6 jitter is the relative transit time |D(i-1, i)| of
+     * RFC 3550 6.4.1 between consecutive packets, without smoothing */
+    i_arrival = (i_date / 1000000) * p_xr->i_clock_rate +
+                (i_date % 1000000) * p_xr->i_clock_rate / 1000000;
+    i_transit = i_arrival - rtp_get_timestamp(p_rtp);
+    if (p_xr->b_transit) {
+        int32_t i_d = (int32_t)(i_transit - p_xr->i_transit);
+        uint32_t i_jitter = i_d < 0 ? -(uint32_t)i_d : (uint32_t)i_d;
+        if (i_jitter < p_xr->i_min_jitter)
+            p_xr->i_min_jitter = i_jitter;
+        if (i_jitter > p_xr->i_max_jitter)
+            p_xr->i_max_jitter = i_jitter;
+        p_xr->i_sum_jitter += i_jitter;
+        p_xr->i_sum2_jitter += (uint64_t)i_jitter * i_jitter;
+        p_xr->i_nb_jitter++;
+    }
+    p_xr->b_transit = true;
+    p_xr->i_transit = i_transit;
+    return true;
+}
+
+/* integer square root */
+static inline uint32_t rtcpxr_sqrt(uint64_t i_x)
+{
+    uint64_t i_r = 0, i_bit = UINT64_C(1) << 62;
+
+    while (i_bit > i_x)
+        i_bit >>= 2;
+    while (i_bit) {
+        if (i_x >= i_r + i_bit) {
+            i_x -= i_r + i_bit;
+            i_r = (i_r >> 1) + i_bit;
+        } else
+            i_r >>= 1;
+        i_bit >>= 2;
+    }
+    return i_r;
+}
+
+/* returns the number of bits set among the first i_nb of p_bitmap */
+static inline uint32_t rtcpxr_count(const uint64_t *p_bitmap, uint32_t i_nb)
+{
+    uint32_t i, i_count = 0;
+
+    for (i = 0; i < i_nb / 64; i++) {
+        uint64_t i_word = p_bitmap[i];
+        for ( ; i_word; i_count++)
+            i_word &= i_word - 1;
+    }
+    for (i = i_nb / 64 * 64; i < i_nb; i++)
+        i_count += (p_bitmap[i / 64] >> (i % 64)) & 1;
+    return i_count;
+}
+
+/* writes the header shared by RLE and statistics summary blocks */
+static inline void rtcpxr_block(rtcpxr_t *p_xr, uint8_t *p_block, uint8_t i_bt,
+                                uint64_t i_end)
+{
+    memset(p_block, 0, RTCP_XR_RLE_HEADER_SIZE);
+    rtcp_xr_set_bt(p_block, i_bt);
+    rtcp_xr_rle_set_ssrc_source(p_block, p_xr->i_source_ssrc);
+    rtcp_xr_rle_set_begin_seq(p_block, p_xr->i_begin & 0xffff);
+    rtcp_xr_rle_set_end_seq(p_block, i_end & 0xffff);
+}
+
+/*****************************************************************************
+ * rtcpxr_report
+ *****************************************************************************
+ * Writes an XR packet with Loss RLE, Duplicate RLE and Statistics Summary
+ * blocks for the current interval to p_buf, starts the next interval, and
+ * returns the size of the packet, or 0 if there was nothing to report. The
+ * interval is cut short if the RLE blocks do not fit in the buffer.
+ *****************************************************************************/
+static inline size_t rtcpxr_report(rtcpxr_t *p_xr, uint8_t *p_buf,
+                                   size_t i_buf_size)
+{
+    uint32_t i_nb = p_xr->i_end - p_xr->i_begin, i;
+    uint16_t i_max_chunks;
+    size_t i_size = RTCP_XR_HEADER_SIZE;
+    uint8_t *p_block;
+
+    if (!i_nb || i_buf_size < RTCP_XR_HEADER_SIZE + 2 *
+                              (RTCP_XR_RLE_HEADER_SIZE + 4) + RTCP_XR_SSR_SIZE)
+        return 0;
+    i_buf_size = (i_buf_size - RTCP_XR_HEADER_SIZE - RTCP_XR_SSR_SIZE -
+                  2 * RTCP_XR_RLE_HEADER_SIZE) / 4;
+    i_max_chunks = i_buf_size < 0xfffe ? i_buf_size & ~1 : 0xfffe;
+
+    /* loss RLE, which may shorten the interval, then duplicate RLE */
+    p_block = p_buf + i_size;
+    rtcpxr_block(p_xr, p_block, RTCP_XR_LRLER_BT, p_xr->i_end);
+    i_nb = rtcp_xr_rle_encode(p_block, p_xr->p_received, 0, i_nb,
+                              i_max_chunks);
+    rtcp_xr_rle_set_end_seq(p_block, (p_xr->i_begin + i_nb) & 0xffff);
+    i_size += 4 * (rtcp_xr_get_length(p_block) + 1);
+
+    p_block = p_buf + i_size;
+    rtcpxr_block(p_xr, p_block, RTCP_XR_DRLER_BT, p_xr->i_begin + i_nb);
+    i_nb = rtcp_xr_rle_encode(p_block, p_xr->p_duplicate, 0, i_nb,
+                              i_max_chunks);
+    rtcp_xr_rle_set_end_seq(p_block, (p_xr->i_begin + i_nb) & 0xffff);
+    i_size += 4 * (rtcp_xr_get_length(p_block) + 1);
+
+    p_block = p_buf + i_size;
+    memset(p_block, 0, RTCP_XR_SSR_SIZE);
+    rtcpxr_block(p_xr, p_block, RTCP_XR_SSR_BT, p_xr->i_begin + i_nb);
+    rtcp_xr_set_length(p_block, RTCP_XR_SSR_SIZE / 4 - 1);
+    rtcp_xr_ssr_set_flags(p_block, RTCP_XR_SSR_FLAG_LOST |
+                                   RTCP_XR_SSR_FLAG_DUP |
+                                   (p_xr->i_nb_jitter ?
+                                    RTCP_XR_SSR_FLAG_JITTER : 0));
+    rtcp_xr_ssr_set_lost_packets(p_block,
+                                 i_nb - rtcpxr_count(p_xr->p_received, i_nb));
+    rtcp_xr_ssr_set_dup_packets(p_block,
+                                rtcpxr_count(p_xr->p_duplicate, i_nb));
+    if (p_xr->i_nb_jitter) {
+        uint64_t i_mean = p_xr->i_sum_jitter / p_xr->i_nb_jitter;
+        uint64_t i_var = p_xr->i_sum2_jitter / p_xr->i_nb_jitter -
+                         i_mean * i_mean;
+        rtcp_xr_ssr_set_min_jitter(p_block, p_xr->i_min_jitter);
+        rtcp_xr_ssr_set_max_jitter(p_block, p_xr->i_max_jitter);
+        rtcp_xr_ssr_set_mean_jitter(p_block, i_mean);
+        rtcp_xr_ssr_set_dev_jitter(p_block, rtcpxr_sqrt(i_var));
+    }
+    i_size += RTCP_XR_SSR_SIZE;
+
+    rtcp_set_rtp_version(p_buf);
+    rtcp_set_pt(p_buf, RTCP_PT_XR);
+    rtcp_set_length(p_buf, i_size / 4 - 1);
+    rtcp_set_int_ssrc(p_buf, p_xr->i_ssrc);
+
+    /* start the next interval, moving unreported bits to the front */
+    if (i_nb < p_xr->i_end - p_xr->i_begin) {
+        uint32_t i_left = p_xr->i_end - p_xr->i_begin - i_nb;
+        for (i = 0; i < i_left; i++) {
+            uint32_t k = i_nb + i;
+            uint64_t i_mask = UINT64_C(1) << (i % 64);
+            p_xr->p_received[i / 64] &= ~i_mask;
+            p_xr->p_duplicate[i / 64] &= ~i_mask;
+            if ((p_xr->p_received[k / 64] >> (k % 64)) & 1)
+                p_xr->p_received[i / 64] |= i_mask;
+            if ((p_xr->p_duplicate[k / 64] >> (k % 64)) & 1)
+                p_xr->p_duplicate[i / 64] |= i_mask;
+        }
+        memset(p_xr->p_received + (i_left + 63) / 64, 0,
+               (p_xr->i_nb_bits - (i_left + 63) / 64 * 64) / 8);
+        memset(p_xr->p_duplicate + (i_left + 63) / 64, 0,
+               (p_xr->i_nb_bits - (i_left + 63) / 64 * 64) / 8);
+        if (i_left % 64) {
+            uint64_t i_keep = (UINT64_C(1) << (i_left % 64)) - 1;
+            p_xr->p_received[i_left / 64] &= i_keep;
+            p_xr->p_duplicate[i_left / 64] &= i_keep;
+        }
+    } else {
+        memset(p_xr->p_received, 0, (i_nb + 63) / 64 * 8);
+        memset(p_xr->p_duplicate, 0, (i_nb + 63) / 64 * 8);
+    }
+    p_xr->i_begin += i_nb;
+    p_xr->i_min_jitter = UINT32_MAX;
+    p_xr->i_max_jitter = 0;
+    p_xr->i_sum_jitter = p_xr->i_sum2_jitter = 0;
+    p_xr->i_nb_jitter = 0;
+    return i_size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -36,6 +36,7 @@
 #include <stdlib.h>
 #include <stdint.h>   /* uint8_t, uint16_t, etc... */
 #include <stdbool.h>  /* bool */
+#include <bitstream/common.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -139,6 +140,13 @@ static inline uint16_t rtp_get_seqnum(const uint8_t *p_rtp)
     return (p_rtp[2] << 8) | p_rtp[3];
 }
 
+/* returns the extended sequence number of i_seqnum closest to i_last, or
+ * of the first packet if i_last is 0 (see bitstream_extend_seq()) */
+static inline uint64_t rtp_seqnum_extend(uint64_t i_last, uint16_t i_seqnum)
+{
+    return bitstream_extend_seq(i_last, i_seqnum, UINT64_C(0x10000));
+}
+
 static inline void rtp_set_timestamp(uint8_t *p_rtp, uint32_t i_timestamp)
 {
     p_rtp[4] = (i_timestamp >> 24) & 0xff;
@@ -227,6 +235,29 @@ static inline size_t rtp_payload_size(uint8_t *p_rtp, size_t i_rtp_size)
     return i_payload_size - i_padding_size;
 }
 
+/* returns true if the CSRCs, the extension and the padding of the packet
+ * fit in i_rtp_size bytes, so that rtp_payload() and rtp_payload_size()
+ * may be trusted */
+static inline bool rtp_check_size(const uint8_t *p_rtp, size_t i_rtp_size)
+{
+    size_t i_header_size = RTP_HEADER_SIZE;
+
+    if (i_rtp_size < RTP_HEADER_SIZE)
+        return false;
+    i_header_size += 4 * rtp_get_cc(p_rtp);
+    if (rtp_check_extension(p_rtp)) {
+        if (i_rtp_size < i_header_size + RTP_EXTENSION_SIZE)
+            return false;
+        i_header_size += 4 * (1 + (size_t)rtpx_get_length(p_rtp +
+                                                          i_header_size));
+    }
+    if (i_header_size > i_rtp_size)
+        return false;
+    return !rtp_check_padding(p_rtp) ||
+           (i_rtp_size > i_header_size &&
+            p_rtp[i_rtp_size - 1] <= i_rtp_size - i_header_size);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,285 @@
+/*****************************************************************************
+ * rtp3640_rx.h: RTP depacketizer for MPEG-4 AAC (AAC-hbr)
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 3640 RTP Payload Format for Transport of MPEG-4 ES
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The depacketizer handles the AAC-hbr mode of mpeg4-generic, that is AU
+ * headers made of a 13-bit AU-size and a 3-bit AU-Index(-delta), without
+ * auxiliary data. A packet carrying several access units is split without
+ * copying; the timestamp of each access unit is derived from the RTP
+ * timestamp and the AU-Index-delta fields, so that interleaved streams may
+ * be reordered by the caller. Fragments of an access unit larger than a
+ * packet are reassembled in a caller-allocated buffer; if a fragment is
+ * missing, the access unit is dropped.
+ *
+ * Typical use:
+ *
+ *   rtp3640rx_init(&rx, p_buffer, 8192, 1024);
+ *   if (rtp3640rx_input(&rx, p_rtp, i_size) == RTP3640RX_OK)
+ *       while (rtp3640rx_next(&rx, &p_au, &i_au_size, &i_ts))
+ *           output(p_au, i_au_size, i_ts);
+ */
+
+#ifndef __BITSTREAM_IETF_RTP3640_RX_H__
+#define __BITSTREAM_IETF_RTP3640_RX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy, memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rtp3640.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTP3640RX_OK            0
+#define RTP3640RX_INVALID       1
+
+typedef struct rtp3640rx_t {
+    uint8_t *p_buffer;
+    size_t i_buffer_size;
+    uint32_t i_au_duration;
+
+    bool b_started;
+    uint64_t i_seqnum;
+    uint32_t i_timestamp;
+
+    /* access units of the current packet */
+    const uint8_t *p_header;
+    const uint8_t *p_data;
+    unsigned int i_nb_aus;
+    unsigned int i_au;
+    uint32_t i_au_timestamp;
+
+    /* fragmented access unit */
+    bool b_fragment;
+    bool b_skip;
+    bool b_complete;
+    size_t i_fragment_size;
+    uint16_t i_fragment_au_size;
+
+    /* statistics */
+    uint64_t i_packets;
+    uint64_t i_lost;
+    uint64_t i_invalid;
+    uint64_t i_aus;
+    uint64_t i_dropped_aus;
+} rtp3640rx_t;
+
+/*****************************************************************************
+ * rtp3640rx_init
+ *****************************************************************************
+ * p_buffer receives fragmented access units, which are dropped if they are
+ * larger than i_buffer_size. i_au_duration is the duration of an access
+ * unit in RTP clock units (1024 for AAC).
+ *****************************************************************************/
+static inline void rtp3640rx_init(rtp3640rx_t *p_rx, uint8_t *p_buffer,
+                                  size_t i_buffer_size, uint32_t i_au_duration)
+{
+    memset(p_rx, 0, sizeof(rtp3640rx_t));
+    p_rx->p_buffer = p_buffer;
+    p_rx->i_buffer_size = i_buffer_size;
+    p_rx->i_au_duration = i_au_duration;
+}
+
+static inline void rtp3640rx_drop_fragment(rtp3640rx_t *p_rx)
+{
+    if (p_rx->b_fragment) {
+        p_rx->b_fragment = false;
+        p_rx->i_dropped_aus++;
+    }
+}
+
+/*****************************************************************************
+ * rtp3640rx_input
+ *****************************************************************************
+ * Parses a packet, whose access units are then returned by rtp3640rx_next().
+ * The packet must stay valid until then. Returns RTP3640RX_INVALID if the
+ * packet is malformed.
+ *****************************************************************************/
+static inline int rtp3640rx_input(rtp3640rx_t *p_rx, uint8_t *p_rtp,
+                                  size_t i_size)
+{
+    const uint8_t *p_payload, *p_header;
+    size_t i_payload_size, i_data_size, i_total = 0;
+    uint16_t i_headers_length;
+    unsigned int i, i_nb_aus;
+    uint32_t i_timestamp;
+    uint64_t i_seqnum;
+    bool b_new, b_gap = false;
+
+    p_rx->i_nb_aus = p_rx->i_au = 0;
+    p_rx->b_complete = false;
+
+    if (!rtp_check_size(p_rtp, i_size) || !rtp_check_hdr(p_rtp))
+        goto invalid;
+    p_payload = rtp_payload(p_rtp);
+    i_payload_size = rtp_payload_size(p_rtp, i_size);
+    if (i_payload_size < RTP3640_AU_HEADERS_LENGTH_SIZE)
+        goto invalid;
+
+    i_headers_length = rtp3640_get_au_headers_length(p_payload);
+    if (!i_headers_length || i_headers_length % 16)
+        goto invalid;
+    i_nb_aus = i_headers_length / 16;
+    p_header = p_payload + RTP3640_AU_HEADERS_LENGTH_SIZE;
+    if (i_payload_size - RTP3640_AU_HEADERS_LENGTH_SIZE <
+        i_nb_aus * RTP3640_AU_HEADER_AAC_HBR_SIZE)
+        goto invalid;
+    i_data_size = i_payload_size - RTP3640_AU_HEADERS_LENGTH_SIZE -
+                  i_nb_aus * RTP3640_AU_HEADER_AAC_HBR_SIZE;
+    for (i = 0; i < i_nb_aus; i++)
+        i_total += rtp3640_get_aac_hbr_au_size(p_header +
+                                               i * RTP3640_AU_HEADER_AAC_HBR_SIZE);
+    if (i_total > i_data_size && i_nb_aus > 1)
+        goto invalid;
+
+    /* sequence */
+    i_timestamp = rtp_get_timestamp(p_rtp);
+    if (!p_rx->b_started) {
+        p_rx->b_started = true;
+        i_seqnum = rtp_seqnum_extend(0, rtp_get_seqnum(p_rtp));
+        b_new = true;
+    } else {
+        i_seqnum = rtp_seqnum_extend(p_rx->i_seqnum, rtp_get_seqnum(p_rtp));
+        if (i_seqnum != p_rx->i_seqnum + 1) {
+            if (i_seqnum > p_rx->i_seqnum)
+                p_rx->i_lost += i_seqnum - p_rx->i_seqnum - 1;
+            b_gap = true;
+        }
+        b_new = i_timestamp != p_rx->i_timestamp;
+    }
+    p_rx->i_seqnum = i_seqnum;
+    p_rx->i_timestamp = i_timestamp;
+    p_rx->i_packets++;
+
+    if (i_total > i_data_size) {
+        /* fragment of an access unit */
+        uint16_t i_au_size = i_total;
+
+        if (b_new || b_gap || !p_rx->b_fragment ||
+            i_au_size != p_rx->i_fragment_au_size) {
+            bool b_dropped = p_rx->b_fragment;
+
+            rtp3640rx_drop_fragment(p_rx);
+            if (!b_new) {
+                /* a previous fragment was lost, skip the access unit */
+                if (!b_dropped && !p_rx->b_skip)
+                    p_rx->i_dropped_aus++;
+                p_rx->b_skip = true;
+                return RTP3640RX_OK;
+            }
+            p_rx->b_skip = false;
+            if (i_au_size > p_rx->i_buffer_size) {
+                p_rx->i_dropped_aus++;
+                return RTP3640RX_OK;
+            }
+            p_rx->b_fragment = true;
+            p_rx->i_fragment_size = 0;
+            p_rx->i_fragment_au_size = i_au_size;
+        }
+
+        if (i_data_size > i_au_size - p_rx->i_fragment_size) {
+            rtp3640rx_drop_fragment(p_rx);
+            goto invalid;
+        }
+        memcpy(p_rx->p_buffer + p_rx->i_fragment_size,
+               p_header + RTP3640_AU_HEADER_AAC_HBR_SIZE, i_data_size);
+        p_rx->i_fragment_size += i_data_size;
+        if (p_rx->i_fragment_size == i_au_size) {
+            p_rx->b_fragment = false;
+            p_rx->b_complete = true;
+            p_rx->i_au_timestamp = i_timestamp;
+        }
+        return RTP3640RX_OK;
+    }
+
+    if (p_rx->b_fragment && !b_new && !b_gap) {
+        /* the last fragment, with an unexpected size */
+        rtp3640rx_drop_fragment(p_rx);
+        goto invalid;
+    }
+    rtp3640rx_drop_fragment(p_rx);
+    p_rx->b_skip = false;
+
+    p_rx->p_header = p_header;
+    p_rx->p_data = p_header + i_nb_aus * RTP3640_AU_HEADER_AAC_HBR_SIZE;
+    p_rx->i_nb_aus = i_nb_aus;
+    p_rx->i_au_timestamp = i_timestamp;
+    return RTP3640RX_OK;
+
+invalid:
+    p_rx->i_invalid++;
+    return RTP3640RX_INVALID;
+}
+
+/*****************************************************************************
+ * rtp3640rx_next
+ *****************************************************************************
+ * Returns the next access unit of the last packet, with its timestamp, or
+ * false if there are none left.
+ *****************************************************************************/
+static inline bool rtp3640rx_next(rtp3640rx_t *p_rx, const uint8_t **pp_au,
+                                  size_t *pi_size, uint32_t *pi_timestamp)
+{
+    const uint8_t *p_header;
+
+    if (p_rx->b_complete) {
+        p_rx->b_complete = false;
+        *pp_au = p_rx->p_buffer;
+        *pi_size = p_rx->i_fragment_size;
+        *pi_timestamp = p_rx->i_au_timestamp;
+        p_rx->i_aus++;
+        return true;
+    }
+    if (p_rx->i_au >= p_rx->i_nb_aus)
+        return false;
+
+    p_header = p_rx->p_header + p_rx->i_au * RTP3640_AU_HEADER_AAC_HBR_SIZE;
+    if (p_rx->i_au)
+        /* AU-Index-delta */
+        p_rx->i_au_timestamp += (rtp3640_get_aac_hbr_au_index(p_header) + 1) *
+                                p_rx->i_au_duration;
+    *pp_au = p_rx->p_data;
+    *pi_size = rtp3640_get_aac_hbr_au_size(p_header);
+    *pi_timestamp = p_rx->i_au_timestamp;
+    p_rx->p_data += *pi_size;
+    p_rx->i_au++;
+    p_rx->i_aus++;
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
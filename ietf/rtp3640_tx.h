@@ -0,0 +1,246 @@
+/*****************************************************************************
+ * rtp3640_tx.h: RTP packetizer for MPEG-4 AAC (AAC-hbr)
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 3640 RTP Payload Format for Transport of MPEG-4 ES
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ *  - ISO/IEC 13818-7:2006(E) (MPEG-2 Advanced Audio Coding)
+ */
+
+/*
+ * The packetizer aggregates consecutive AAC frames, stripped of their ADTS
+ * header, into AAC-hbr packets of at most i_payload_size bytes of payload
+ * and i_max_aus access units, which bounds the added latency. A frame
+ * larger than a packet is fragmented. The frames are not copied until the
+ * packet is written, so they must stay valid until rtp3640tx_flush(). The
+ * stream is not interleaved.
+ *
+ * Typical use:
+ *
+ *   rtp3640tx_init(&tx, 1448, 8, 96, ssrc);
+ *   while ((i_ret = rtp3640tx_put_adts(&tx, p_adts, i_size, i_ts))
+ *           == RTP3640TX_FULL)
+ *       while ((i_packet_size = rtp3640tx_flush(&tx, p_packet)))
+ *           send(p_packet, i_packet_size);
+ */
+
+#ifndef __BITSTREAM_IETF_RTP3640_TX_H__
+#define __BITSTREAM_IETF_RTP3640_TX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy, memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rtp3640.h>
+#include <bitstream/mpeg/aac.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTP3640TX_OK            0
+#define RTP3640TX_FULL          1
+#define RTP3640TX_INVALID       2
+
+#define RTP3640TX_MAX_AUS       64
+#define RTP3640TX_AU_SIZE_MAX   0x1fff
+
+typedef struct rtp3640tx_au_t {
+    const uint8_t *p_data;
+    uint16_t i_size;
+} rtp3640tx_au_t;
+
+typedef struct rtp3640tx_t {
+    size_t i_payload_size;
+    unsigned int i_max_aus;
+    uint8_t i_type;
+    uint32_t i_ssrc;
+    uint16_t i_seqnum;
+
+    /* pending access units */
+    rtp3640tx_au_t p_aus[RTP3640TX_MAX_AUS];
+    unsigned int i_nb_aus;
+    size_t i_size;
+    uint32_t i_timestamp;
+    size_t i_fragment_offset;
+} rtp3640tx_t;
+
+/*****************************************************************************
+ * rtp3640tx_init
+ *****************************************************************************
+ * i_payload_size is the maximum size of the RTP payload, and i_max_aus the
+ * maximum number of access units per packet (at most RTP3640TX_MAX_AUS).
+ *****************************************************************************/
+static inline void rtp3640tx_init(rtp3640tx_t *p_tx, size_t i_payload_size,
+                                  unsigned int i_max_aus, uint8_t i_type,
+                                  uint32_t i_ssrc)
+{
+    memset(p_tx, 0, sizeof(rtp3640tx_t));
+    p_tx->i_payload_size = i_payload_size;
+    p_tx->i_max_aus = i_max_aus && i_max_aus <= RTP3640TX_MAX_AUS ?
+                      i_max_aus : RTP3640TX_MAX_AUS;
+    p_tx->i_type = i_type;
+    p_tx->i_ssrc = i_ssrc;
+    p_tx->i_size = RTP3640_AU_HEADERS_LENGTH_SIZE;
+}
+
+/* sets the sequence number of the next packet */
+static inline void rtp3640tx_set_seqnum(rtp3640tx_t *p_tx, uint16_t i_seqnum)
+{
+    p_tx->i_seqnum = i_seqnum;
+}
+
+/*****************************************************************************
+ * rtp3640tx_put
+ *****************************************************************************
+ * Queues a raw access unit. Returns RTP3640TX_FULL if the access unit does
+ * not fit in the current packet, which must be flushed before putting the
+ * access unit again.
+ *****************************************************************************/
+static inline int rtp3640tx_put(rtp3640tx_t *p_tx, const uint8_t *p_au,
+                                size_t i_size, uint32_t i_timestamp)
+{
+    if (!i_size || i_size > RTP3640TX_AU_SIZE_MAX)
+        return RTP3640TX_INVALID;
+    if (p_tx->i_nb_aus &&
+        (p_tx->i_nb_aus >= p_tx->i_max_aus ||
+         p_tx->i_size + RTP3640_AU_HEADER_AAC_HBR_SIZE + i_size >
+             p_tx->i_payload_size))
+        return RTP3640TX_FULL;
+
+    if (!p_tx->i_nb_aus)
+        p_tx->i_timestamp = i_timestamp;
+    p_tx->p_aus[p_tx->i_nb_aus].p_data = p_au;
+    p_tx->p_aus[p_tx->i_nb_aus].i_size = i_size;
+    p_tx->i_nb_aus++;
+    p_tx->i_size += RTP3640_AU_HEADER_AAC_HBR_SIZE + i_size;
+    return RTP3640TX_OK;
+}
+
+/*****************************************************************************
+ * rtp3640tx_put_adts
+ *****************************************************************************
+ * Queues the AAC frame of the ADTS frame p_adts (at most i_size bytes,
+ * the caller moves to the next one with adts_get_length()). Frames made of
+ * several raw data blocks are rejected.
+ *****************************************************************************/
+static inline int rtp3640tx_put_adts(rtp3640tx_t *p_tx, const uint8_t *p_adts,
+                                     size_t i_size, uint32_t i_timestamp)
+{
+    size_t i_header_size = ADTS_HEADER_SIZE;
+    uint16_t i_length;
+
+    if (i_size < ADTS_HEADER_SIZE || p_adts[0] != 0xff ||
+        (p_adts[1] & 0xf6) != 0xf0 || adts_get_num_blocks(p_adts))
+        return RTP3640TX_INVALID;
+    if (!adts_get_protection_absent(p_adts))
+        i_header_size += ADTS_CRC_SIZE;
+    i_length = adts_get_length(p_adts);
+    if (i_length <= i_header_size || i_length > i_size)
+        return RTP3640TX_INVALID;
+    return rtp3640tx_put(p_tx, p_adts + i_header_size,
+                         i_length - i_header_size, i_timestamp);
+}
+
+/*****************************************************************************
+ * rtp3640tx_flush
+ *****************************************************************************
+ * Writes the next packet of the queued access units to p_packet, which
+ * must hold RTP_HEADER_SIZE + i_payload_size bytes, and returns its size,
+ * or 0 if there is nothing left to send.
+ *****************************************************************************/
+static inline size_t rtp3640tx_flush(rtp3640tx_t *p_tx, uint8_t *p_packet)
+{
+    uint8_t *p_payload = p_packet + RTP_HEADER_SIZE;
+    uint8_t *p_data;
+    unsigned int i;
+    size_t i_size;
+
+    if (!p_tx->i_nb_aus ||
+        p_tx->i_payload_size <= RTP3640_AU_HEADERS_LENGTH_SIZE +
+                                RTP3640_AU_HEADER_AAC_HBR_SIZE)
+        return 0;
+
+    memset(p_packet, 0, RTP_HEADER_SIZE);
+    rtp_set_hdr(p_packet);
+    rtp_set_type(p_packet, p_tx->i_type);
+    rtp_set_seqnum(p_packet, p_tx->i_seqnum++);
+    rtp_set_timestamp(p_packet, p_tx->i_timestamp);
+    rtp_set_int_ssrc(p_packet, p_tx->i_ssrc);
+    rtp3640_set_au_headers_length(p_payload, p_tx->i_nb_aus * 16);
+    p_data = p_payload + RTP3640_AU_HEADERS_LENGTH_SIZE +
+             p_tx->i_nb_aus * RTP3640_AU_HEADER_AAC_HBR_SIZE;
+
+    if (p_tx->i_size > p_tx->i_payload_size) {
+        /* fragment of a single access unit */
+        const rtp3640tx_au_t *p_au = &p_tx->p_aus[0];
+
+        i_size = p_tx->i_payload_size - RTP3640_AU_HEADERS_LENGTH_SIZE -
+                 RTP3640_AU_HEADER_AAC_HBR_SIZE;
+        if (i_size > p_au->i_size - p_tx->i_fragment_offset)
+            i_size = p_au->i_size - p_tx->i_fragment_offset;
+        p_payload[2] = p_payload[3] = 0;
+        rtp3640_set_aac_hbr_au_size(p_payload + 2, p_au->i_size);
+        memcpy(p_data, p_au->p_data + p_tx->i_fragment_offset, i_size);
+        p_tx->i_fragment_offset += i_size;
+        if (p_tx->i_fragment_offset < p_au->i_size)
+            return RTP_HEADER_SIZE + RTP3640_AU_HEADERS_LENGTH_SIZE +
+                   RTP3640_AU_HEADER_AAC_HBR_SIZE + i_size;
+
+        /* last fragment */
+        rtp_set_marker(p_packet);
+        p_tx->i_fragment_offset = 0;
+        p_tx->i_nb_aus = 0;
+        p_tx->i_size = RTP3640_AU_HEADERS_LENGTH_SIZE;
+        return RTP_HEADER_SIZE + RTP3640_AU_HEADERS_LENGTH_SIZE +
+               RTP3640_AU_HEADER_AAC_HBR_SIZE + i_size;
+    }
+
+    for (i = 0; i < p_tx->i_nb_aus; i++) {
+        const rtp3640tx_au_t *p_au = &p_tx->p_aus[i];
+        uint8_t *p_header = p_payload + RTP3640_AU_HEADERS_LENGTH_SIZE +
+                            i * RTP3640_AU_HEADER_AAC_HBR_SIZE;
+
+        /* AU-Index and AU-Index-delta are 0 */
+        p_header[0] = p_header[1] = 0;
+        rtp3640_set_aac_hbr_au_size(p_header, p_au->i_size);
+        memcpy(p_data, p_au->p_data, p_au->i_size);
+        p_data += p_au->i_size;
+    }
+    rtp_set_marker(p_packet);
+
+    i_size = RTP_HEADER_SIZE + p_tx->i_size;
+    p_tx->i_nb_aus = 0;
+    p_tx->i_size = RTP3640_AU_HEADERS_LENGTH_SIZE;
+    return i_size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,380 @@
+/*****************************************************************************
+ * rtp6184_rx.h: RTP depacketizer for H.264 Video
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 6184 RTP Payload Format for H.264 Video (May 2011)
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The depacketizer rebuilds Annex-B access units from single NAL unit,
+ * STAP-A and FU-A packets (non-interleaved mode), without copying: an
+ * access unit is kept as a caller-allocated scatter list of segments
+ * pointing to start codes and to the payloads of the packets, which must
+ * therefore stay valid until rtp6184rx_release(). To avoid copying the
+ * first fragment of a FU-A, the reconstructed NAL unit header is written
+ * over the FU header of the packet. Packets must be given in sequence
+ * number order (see rtp_reorder.h); when a packet is missing, the FU-A
+ * being reassembled is dropped and the access unit is flagged as corrupt.
+ * An access unit ends with a packet having the marker bit set, or with a
+ * packet having a different timestamp.
+ *
+ * Typical use:
+ *
+ *   rtp6184rx_init(&rx, p_segments, 1024);
+ *   while ((i_ret = rtp6184rx_input(&rx, p_rtp, i_size)) == RTP6184RX_BUSY) {
+ *       output_au(&rx);
+ *       rtp6184rx_release(&rx);
+ *   }
+ *   if (i_ret == RTP6184RX_AU) {
+ *       output_au(&rx);
+ *       rtp6184rx_release(&rx);
+ *   }
+ */
+
+#ifndef __BITSTREAM_IETF_RTP6184_RX_H__
+#define __BITSTREAM_IETF_RTP6184_RX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy, memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rtp6184.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTP6184RX_OK            0
+#define RTP6184RX_AU            1
+#define RTP6184RX_BUSY          2
+#define RTP6184RX_INVALID       3
+
+#define RTP6184RX_START_CODE_SIZE   4
+
+typedef struct rtp6184rx_segment_t {
+    const uint8_t *p_data;
+    size_t i_size;
+} rtp6184rx_segment_t;
+
+typedef struct rtp6184rx_t {
+    rtp6184rx_segment_t *p_segments;
+    unsigned int i_max_segments;
+    unsigned int i_nb_segments;
+    size_t i_au_size;
+
+    bool b_started;
+    uint64_t i_seqnum;
+    uint32_t i_timestamp;
+    bool b_au;
+    bool b_corrupt;
+
+    /* FU-A being reassembled */
+    bool b_fu;
+    unsigned int i_fu_segment;
+    size_t i_fu_au_size;
+
+    /* statistics */
+    uint64_t i_packets;
+    uint64_t i_lost;
+    uint64_t i_invalid;
+    uint64_t i_aus;
+    uint64_t i_corrupt_aus;
+    uint64_t i_dropped_fus;
+} rtp6184rx_t;
+
+static inline const uint8_t *rtp6184rx_start_code(void)
+{
+    static const uint8_t p_start_code[RTP6184RX_START_CODE_SIZE] =
+        { 0x00, 0x00, 0x00, 0x01 };
+    return p_start_code;
+}
+
+/*****************************************************************************
+ * rtp6184rx_init
+ *****************************************************************************
+ * i_max_segments bounds the number of segments of an access unit: two per
+ * NAL unit, plus one per additional fragment.
+ *****************************************************************************/
+static inline void rtp6184rx_init(rtp6184rx_t *p_rx,
+                                  rtp6184rx_segment_t *p_segments,
+                                  unsigned int i_max_segments)
+{
+    memset(p_rx, 0, sizeof(rtp6184rx_t));
+    p_rx->p_segments = p_segments;
+    p_rx->i_max_segments = i_max_segments;
+}
+
+static inline bool rtp6184rx_append(rtp6184rx_t *p_rx, const uint8_t *p_data,
+                                    size_t i_size)
+{
+    rtp6184rx_segment_t *p_segment;
+
+    if (p_rx->i_nb_segments >= p_rx->i_max_segments) {
+        p_rx->b_corrupt = true;
+        return false;
+    }
+    p_segment = &p_rx->p_segments[p_rx->i_nb_segments++];
+    p_segment->p_data = p_data;
+    p_segment->i_size = i_size;
+    p_rx->i_au_size += i_size;
+    return true;
+}
+
+static inline bool rtp6184rx_append_nal(rtp6184rx_t *p_rx,
+                                        const uint8_t *p_nal, size_t i_size)
+{
+    if (p_rx->i_nb_segments + 2 > p_rx->i_max_segments) {
+        p_rx->b_corrupt = true;
+        return false;
+    }
+    rtp6184rx_append(p_rx, rtp6184rx_start_code(), RTP6184RX_START_CODE_SIZE);
+    return rtp6184rx_append(p_rx, p_nal, i_size);
+}
+
+/* drops the FU-A being reassembled */
+static inline void rtp6184rx_drop_fu(rtp6184rx_t *p_rx)
+{
+    if (!p_rx->b_fu)
+        return;
+    p_rx->b_fu = false;
+    p_rx->b_corrupt = true;
+    p_rx->i_nb_segments = p_rx->i_fu_segment;
+    p_rx->i_au_size = p_rx->i_fu_au_size;
+    p_rx->i_dropped_fus++;
+}
+
+/* ends the current access unit, returns true if it is not empty */
+static inline bool rtp6184rx_end(rtp6184rx_t *p_rx)
+{
+    rtp6184rx_drop_fu(p_rx);
+    if (!p_rx->i_nb_segments) {
+        p_rx->b_corrupt = false;
+        return false;
+    }
+    p_rx->b_au = true;
+    p_rx->i_aus++;
+    if (p_rx->b_corrupt)
+        p_rx->i_corrupt_aus++;
+    return true;
+}
+
+static inline bool rtp6184rx_check_stap(const uint8_t *p_payload,
+                                        size_t i_size)
+{
+    size_t i_offset = 1;
+
+    if (i_size < 1 + RTP_6184_STAP_HEADER_SIZE + 1)
+        return false;
+    while (i_offset < i_size) {
+        uint16_t i_nal_size;
+        if (i_size - i_offset < RTP_6184_STAP_HEADER_SIZE)
+            return false;
+        i_nal_size = rtp_6184_stap_get_size(p_payload + i_offset);
+        i_offset += RTP_6184_STAP_HEADER_SIZE;
+        if (!i_nal_size || i_size - i_offset < i_nal_size)
+            return false;
+        i_offset += i_nal_size;
+    }
+    return true;
+}
+
+/*****************************************************************************
+ * rtp6184rx_input
+ *****************************************************************************
+ * Returns RTP6184RX_OK if the packet has been added to the current access
+ * unit, or RTP6184RX_AU if it also completed it. RTP6184RX_BUSY means that
+ * an access unit is complete and the packet was not consumed: it must be
+ * input again after rtp6184rx_release(). RTP6184RX_INVALID means that the
+ * packet was not consumed because it is malformed or of an unsupported
+ * type. The packet must stay valid until rtp6184rx_release() unless it was
+ * not consumed.
+ *****************************************************************************/
+static inline int rtp6184rx_input(rtp6184rx_t *p_rx, uint8_t *p_rtp,
+                                  size_t i_size)
+{
+    uint32_t i_timestamp;
+    uint8_t *p_payload;
+    size_t i_payload_size;
+    uint64_t i_seqnum;
+    uint8_t i_type;
+
+    if (p_rx->b_au)
+        return RTP6184RX_BUSY;
+
+    if (!rtp_check_size(p_rtp, i_size) || !rtp_check_hdr(p_rtp) ||
+        !(i_payload_size = rtp_payload_size(p_rtp, i_size))) {
+        p_rx->i_invalid++;
+        return RTP6184RX_INVALID;
+    }
+    p_payload = rtp_payload(p_rtp);
+    i_timestamp = rtp_get_timestamp(p_rtp);
+
+    if (p_rx->b_started && i_timestamp != p_rx->i_timestamp &&
+        rtp6184rx_end(p_rx))
+        return RTP6184RX_BUSY;
+
+    /* sequence */
+    if (!p_rx->b_started) {
+        p_rx->b_started = true;
+        i_seqnum = rtp_seqnum_extend(0, rtp_get_seqnum(p_rtp));
+    } else {
+        i_seqnum = rtp_seqnum_extend(p_rx->i_seqnum, rtp_get_seqnum(p_rtp));
+        if (i_seqnum != p_rx->i_seqnum + 1) {
+            if (i_seqnum > p_rx->i_seqnum)
+                p_rx->i_lost += i_seqnum - p_rx->i_seqnum - 1;
+            rtp6184rx_drop_fu(p_rx);
+            p_rx->b_corrupt = true;
+        }
+    }
+    p_rx->i_seqnum = i_seqnum;
+    p_rx->i_timestamp = i_timestamp;
+    p_rx->i_packets++;
+
+    i_type = p_payload[0] & 0x1f;
+    if (i_type >= 1 && i_type <= 23) {
+        rtp6184rx_drop_fu(p_rx);
+        rtp6184rx_append_nal(p_rx, p_payload, i_payload_size);
+
+    } else if (i_type == RTP_6184_STAP_A) {
+        size_t i_offset = 1;
+
+        if (!rtp6184rx_check_stap(p_payload, i_payload_size))
+            goto invalid;
+        rtp6184rx_drop_fu(p_rx);
+        while (i_offset < i_payload_size) {
+            uint16_t i_nal_size = rtp_6184_stap_get_size(p_payload + i_offset);
+            i_offset += RTP_6184_STAP_HEADER_SIZE;
+            if (!rtp6184rx_append_nal(p_rx, p_payload + i_offset, i_nal_size))
+                break;
+            i_offset += i_nal_size;
+        }
+
+    } else if (i_type == RTP_6184_FU_A) {
+        uint8_t i_fu_header;
+
+        if (i_payload_size < 3)
+            goto invalid;
+        i_fu_header = p_payload[1];
+
+        if (rtp_6184_fu_check_start(i_fu_header)) {
+            rtp6184rx_drop_fu(p_rx);
+            p_rx->b_fu = true;
+            p_rx->i_fu_segment = p_rx->i_nb_segments;
+            p_rx->i_fu_au_size = p_rx->i_au_size;
+            /* rebuild the NAL unit header in place */
+            p_payload[1] = (p_payload[0] & 0xe0) | (i_fu_header & 0x1f);
+            if (!rtp6184rx_append_nal(p_rx, p_payload + 1, i_payload_size - 1))
+                rtp6184rx_drop_fu(p_rx);
+        } else if (!p_rx->b_fu) {
+            /* the first fragment was lost */
+            p_rx->b_corrupt = true;
+        } else if (!rtp6184rx_append(p_rx, p_payload + 2, i_payload_size - 2))
+            rtp6184rx_drop_fu(p_rx);
+
+        if (rtp_6184_fu_check_end(i_fu_header))
+            p_rx->b_fu = false;
+
+    } else
+        goto invalid;
+
+    if (rtp_check_marker(p_rtp) && rtp6184rx_end(p_rx))
+        return RTP6184RX_AU;
+    return RTP6184RX_OK;
+
+invalid:
+    /* the packet is not referenced, but may have carried NAL units */
+    rtp6184rx_drop_fu(p_rx);
+    p_rx->b_corrupt = true;
+    p_rx->i_invalid++;
+    if (rtp_check_marker(p_rtp) && rtp6184rx_end(p_rx))
+        return RTP6184RX_AU;
+    return RTP6184RX_INVALID;
+}
+
+/* returns the segments of the complete access unit */
+static inline const rtp6184rx_segment_t *
+    rtp6184rx_get_segments(const rtp6184rx_t *p_rx, unsigned int *pi_nb)
+{
+    *pi_nb = p_rx->i_nb_segments;
+    return p_rx->p_segments;
+}
+
+static inline size_t rtp6184rx_get_au_size(const rtp6184rx_t *p_rx)
+{
+    return p_rx->i_au_size;
+}
+
+static inline uint32_t rtp6184rx_get_timestamp(const rtp6184rx_t *p_rx)
+{
+    return p_rx->i_timestamp;
+}
+
+/* returns true if NAL units of the access unit were lost */
+static inline bool rtp6184rx_check_corrupt(const rtp6184rx_t *p_rx)
+{
+    return p_rx->b_corrupt;
+}
+
+/*****************************************************************************
+ * rtp6184rx_flatten
+ *****************************************************************************
+ * Copies the complete access unit to p_buffer, which must hold
+ * rtp6184rx_get_au_size() bytes, and returns its size.
+ *****************************************************************************/
+static inline size_t rtp6184rx_flatten(const rtp6184rx_t *p_rx,
+                                       uint8_t *p_buffer)
+{
+    unsigned int i;
+
+    for (i = 0; i < p_rx->i_nb_segments; i++) {
+        memcpy(p_buffer, p_rx->p_segments[i].p_data,
+               p_rx->p_segments[i].i_size);
+        p_buffer += p_rx->p_segments[i].i_size;
+    }
+    return p_rx->i_au_size;
+}
+
+/*****************************************************************************
+ * rtp6184rx_release
+ *****************************************************************************
+ * Releases the complete access unit; the packets consumed until then are
+ * no longer referenced.
+ *****************************************************************************/
+static inline void rtp6184rx_release(rtp6184rx_t *p_rx)
+{
+    p_rx->b_au = false;
+    p_rx->b_corrupt = false;
+    p_rx->i_nb_segments = 0;
+    p_rx->i_au_size = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,244 @@
+/*****************************************************************************
+ * rtp6184_tx.h: RTP packetizer for H.264 Video
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 6184 RTP Payload Format for H.264 Video (May 2011)
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The packetizer splits Annex-B access units into RTP packets in
+ * non-interleaved mode: a NAL unit fitting in i_payload_size bytes is sent
+ * as a single NAL unit packet, and larger ones are fragmented into FU-A
+ * packets of maximum size. The NAL unit data is not copied: each packet is
+ * made of a header (RTP header, plus FU indicator and FU header) and of a
+ * contiguous range of the access unit, ready to be sent from two iovecs
+ * with sendmmsg() or writev(). STAP-A aggregation would require copying,
+ * so it is not used. The marker bit is set on the last packet of the
+ * access unit.
+ *
+ * Typical use:
+ *
+ *   rtp6184tx_init(&tx, 1448, 96, ssrc);
+ *   rtp6184tx_au(&tx, p_au, i_au_size, i_ts);
+ *   while ((i_nb = rtp6184tx_packets(&tx, p_packets, 64)))
+ *       send(p_packets, i_nb);
+ */
+
+#ifndef __BITSTREAM_IETF_RTP6184_TX_H__
+#define __BITSTREAM_IETF_RTP6184_TX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/ietf/rtp6184.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTP6184TX_FU_HEADER_SIZE    2
+#define RTP6184TX_HEADER_MAX        (RTP_HEADER_SIZE + RTP6184TX_FU_HEADER_SIZE)
+
+typedef struct rtp6184tx_packet_t {
+    uint8_t p_header[RTP6184TX_HEADER_MAX];
+    size_t i_header_size;
+    const uint8_t *p_data;
+    size_t i_data_size;
+} rtp6184tx_packet_t;
+
+typedef struct rtp6184tx_t {
+    size_t i_payload_size;
+    uint8_t i_type;
+    uint32_t i_ssrc;
+    uint16_t i_seqnum;
+
+    /* access unit being packetized */
+    const uint8_t *p_next;
+    const uint8_t *p_end;
+    uint32_t i_timestamp;
+    const uint8_t *p_nal;
+    size_t i_nal_size;
+    size_t i_nal_offset;
+} rtp6184tx_t;
+
+/* returns the first start code (00 00 01) in [p, p_end[, or p_end */
+static inline const uint8_t *rtp6184tx_find_start_code(const uint8_t *p,
+                                                       const uint8_t *p_end)
+{
+    if (p_end - p < 3)
+        return p_end;
+    for (p += 2; p < p_end; ) {
+        if (*p > 1)
+            p += 3;
+        else if (!*p)
+            p++;
+        else {
+            if (!p[-1] && !p[-2])
+                return p - 2;
+            p += 3;
+        }
+    }
+    return p_end;
+}
+
+/* moves to the next non-empty NAL unit of the access unit */
+static inline void rtp6184tx_next_nal(rtp6184tx_t *p_tx)
+{
+    const uint8_t *p_start, *p_stop;
+
+    p_tx->p_nal = NULL;
+    p_tx->i_nal_size = p_tx->i_nal_offset = 0;
+    while (p_tx->p_next < p_tx->p_end) {
+        p_start = rtp6184tx_find_start_code(p_tx->p_next, p_tx->p_end);
+        if (p_start == p_tx->p_end) {
+            p_tx->p_next = p_tx->p_end;
+            return;
+        }
+        p_start += 3;
+        p_stop = rtp6184tx_find_start_code(p_start, p_tx->p_end);
+        p_tx->p_next = p_stop;
+        /* trailing zeros belong to the next start code */
+        while (p_stop > p_start && !p_stop[-1])
+            p_stop--;
+        if (p_stop > p_start) {
+            p_tx->p_nal = p_start;
+            p_tx->i_nal_size = p_stop - p_start;
+            return;
+        }
+    }
+}
+
+/*****************************************************************************
+ * rtp6184tx_init
+ *****************************************************************************
+ * i_payload_size is the maximum size of the RTP payload.
+ *****************************************************************************/
+static inline void rtp6184tx_init(rtp6184tx_t *p_tx, size_t i_payload_size,
+                                  uint8_t i_type, uint32_t i_ssrc)
+{
+    memset(p_tx, 0, sizeof(rtp6184tx_t));
+    p_tx->i_payload_size = i_payload_size;
+    p_tx->i_type = i_type;
+    p_tx->i_ssrc = i_ssrc;
+}
+
+/* sets the sequence number of the next packet */
+static inline void rtp6184tx_set_seqnum(rtp6184tx_t *p_tx, uint16_t i_seqnum)
+{
+    p_tx->i_seqnum = i_seqnum;
+}
+
+/*****************************************************************************
+ * rtp6184tx_au
+ *****************************************************************************
+ * Starts packetizing the Annex-B access unit p_au, which must stay valid
+ * until its packets are sent.
+ *****************************************************************************/
+static inline void rtp6184tx_au(rtp6184tx_t *p_tx, const uint8_t *p_au,
+                                size_t i_au_size, uint32_t i_timestamp)
+{
+    p_tx->p_next = p_au;
+    p_tx->p_end = p_au + i_au_size;
+    p_tx->i_timestamp = i_timestamp;
+    rtp6184tx_next_nal(p_tx);
+}
+
+/*****************************************************************************
+ * rtp6184tx_packets
+ *****************************************************************************
+ * Prepares at most i_max packets of the current access unit and returns
+ * the number of packets prepared, or 0 when the access unit is complete.
+ *****************************************************************************/
+static inline unsigned int rtp6184tx_packets(rtp6184tx_t *p_tx,
+                                             rtp6184tx_packet_t *p_packets,
+                                             unsigned int i_max)
+{
+    unsigned int i;
+
+    if (p_tx->i_payload_size <= RTP6184TX_FU_HEADER_SIZE)
+        return 0;
+
+    for (i = 0; i < i_max && p_tx->p_nal != NULL; i++) {
+        rtp6184tx_packet_t *p_packet = &p_packets[i];
+        uint8_t *p_header = p_packet->p_header;
+        const uint8_t *p_nal = p_tx->p_nal;
+        size_t i_left = p_tx->i_nal_size - p_tx->i_nal_offset;
+        bool b_end;
+
+        memset(p_header, 0, RTP6184TX_HEADER_MAX);
+        rtp_set_hdr(p_header);
+        rtp_set_type(p_header, p_tx->i_type);
+        rtp_set_seqnum(p_header, p_tx->i_seqnum++);
+        rtp_set_timestamp(p_header, p_tx->i_timestamp);
+        rtp_set_int_ssrc(p_header, p_tx->i_ssrc);
+        p_packet->i_header_size = RTP_HEADER_SIZE;
+
+        if (!p_tx->i_nal_offset && i_left <= p_tx->i_payload_size) {
+            /* single NAL unit packet */
+            p_packet->p_data = p_nal;
+            p_packet->i_data_size = i_left;
+            b_end = true;
+        } else {
+            size_t i_size = p_tx->i_payload_size - RTP6184TX_FU_HEADER_SIZE;
+            uint8_t *p_fu = p_header + RTP_HEADER_SIZE;
+
+            p_fu[0] = (p_nal[0] & 0xe0) | RTP_6184_FU_A;
+            p_fu[1] = p_nal[0] & 0x1f;
+            if (!p_tx->i_nal_offset) {
+                /* the NAL unit header is carried by the FU indicator */
+                rtp_6184_fu_set_start(p_fu + 1);
+                p_tx->i_nal_offset = 1;
+                i_left--;
+            }
+            if (i_size > i_left)
+                i_size = i_left;
+            b_end = i_size == i_left;
+            if (b_end)
+                rtp_6184_fu_set_end(p_fu + 1);
+
+            p_packet->i_header_size += RTP6184TX_FU_HEADER_SIZE;
+            p_packet->p_data = p_nal + p_tx->i_nal_offset;
+            p_packet->i_data_size = i_size;
+            p_tx->i_nal_offset += i_size;
+        }
+
+        if (b_end) {
+            rtp6184tx_next_nal(p_tx);
+            if (p_tx->p_nal == NULL)
+                rtp_set_marker(p_header);
+        }
+    }
+    return i;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,275 @@
+/*****************************************************************************
+ * rtp_flow.h: Prebuilt Ethernet/IPv4/UDP/RTP headers
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IEEE Std 802.3-2012 (December 2012)
+ *  - IETF RFC 791 INTERNET PROTOCOL (September 1981)
+ *  - IETF RFC 768 User Datagram Protocol (August 1980)
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * A flow template holds the Ethernet (optionally VLAN-tagged), IPv4, UDP
+ * and RTP headers of an RTP stream, to write complete frames for raw
+ * sockets (AF_PACKET, TPACKET rings). The template is filled once with the
+ * usual ethernet_set_*(), ip_set_*(), udp_set_*() and rtp_set_*() setters,
+ * and rtpflow_prepare() then sums its constant fields. For each frame, the
+ * template is copied and only the IP length, identification and checksum,
+ * the UDP length and checksum, and the RTP marker, sequence number and
+ * timestamp are patched; the checksums are derived from the precomputed
+ * sums, and the payload is only summed if the UDP checksum is enabled.
+ *
+ * Typical use:
+ *
+ *   rtpflow_init(&flow, true);
+ *   ethernet_set_dstaddr(rtpflow_ethernet(&flow), p_dst_mac);
+ *   ethernet_vlan_set_id(rtpflow_ethernet(&flow), 100);
+ *   ip_set_dstaddr(rtpflow_ip(&flow), i_group);
+ *   udp_set_dstport(rtpflow_udp(&flow), 5004);
+ *   rtp_set_type(rtpflow_rtp(&flow), RTP_TYPE_TS);
+ *   ...
+ *   rtpflow_prepare(&flow, false);
+ *   for each packet:
+ *       i_size = rtpflow_write(&flow, p_slot, p_payload, i_payload_size,
+ *                              i_timestamp, false);
+ */
+
+#ifndef __BITSTREAM_IETF_RTP_FLOW_H__
+#define __BITSTREAM_IETF_RTP_FLOW_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy, memset */
+#include <bitstream/ieee/ethernet.h>
+#include <bitstream/ietf/ip.h>
+#include <bitstream/ietf/udp.h>
+#include <bitstream/ietf/rtp.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTPFLOW_HEADER_MAX  (ETHERNET_HEADER_LEN + ETHERNET_VLAN_LEN + \
+                             IP_HEADER_MINSIZE + UDP_HEADER_SIZE + \
+                             RTP_HEADER_SIZE)
+
+typedef struct rtpflow_t {
+    uint8_t p_header[RTPFLOW_HEADER_MAX];
+    size_t i_header_size;
+    size_t i_ip_offset;
+    size_t i_udp_offset;
+    size_t i_rtp_offset;
+
+    /* sums of the constant fields */
+    uint64_t i_ip_sum;
+    uint64_t i_udp_sum;
+    bool b_udp_cksum;
+
+    uint16_t i_ip_id;
+    uint16_t i_seqnum;
+} rtpflow_t;
+
+/*****************************************************************************
+ * rtpflow_init
+ *****************************************************************************
+ * Lays out the template, with an 802.1Q tag if b_vlan is true, and sets
+ * the protocol fields: IPv4 without options, don't fragment, TTL 64, UDP,
+ * and RTP version 2.
+ *****************************************************************************/
+static inline void rtpflow_init(rtpflow_t *p_flow, bool b_vlan)
+{
+    uint8_t *p_ip;
+
+    memset(p_flow, 0, sizeof(rtpflow_t));
+    p_flow->i_ip_offset = ETHERNET_HEADER_LEN;
+    if (b_vlan) {
+        ethernet_set_lentype(p_flow->p_header, ETHERNET_TYPE_VLAN);
+        ethernet_vlan_set_lentype(p_flow->p_header, ETHERNET_TYPE_IP);
+        p_flow->i_ip_offset += ETHERNET_VLAN_LEN;
+    } else
+        ethernet_set_lentype(p_flow->p_header, ETHERNET_TYPE_IP);
+    p_flow->i_udp_offset = p_flow->i_ip_offset + IP_HEADER_MINSIZE;
+    p_flow->i_rtp_offset = p_flow->i_udp_offset + UDP_HEADER_SIZE;
+    p_flow->i_header_size = p_flow->i_rtp_offset + RTP_HEADER_SIZE;
+
+    p_ip = p_flow->p_header + p_flow->i_ip_offset;
+    ip_set_version(p_ip, 4);
+    ip_set_ihl(p_ip, IP_HEADER_MINSIZE / 4);
+    ip_set_flag_df(p_ip, 1);
+    ip_set_ttl(p_ip, 64);
+    ip_set_proto(p_ip, IP_PROTO_UDP);
+    rtp_set_hdr(p_flow->p_header + p_flow->i_rtp_offset);
+}
+
+static inline uint8_t *rtpflow_ethernet(rtpflow_t *p_flow)
+{
+    return p_flow->p_header;
+}
+
+static inline uint8_t *rtpflow_ip(rtpflow_t *p_flow)
+{
+    return p_flow->p_header + p_flow->i_ip_offset;
+}
+
+static inline uint8_t *rtpflow_udp(rtpflow_t *p_flow)
+{
+    return p_flow->p_header + p_flow->i_udp_offset;
+}
+
+static inline uint8_t *rtpflow_rtp(rtpflow_t *p_flow)
+{
+    return p_flow->p_header + p_flow->i_rtp_offset;
+}
+
+static inline size_t rtpflow_get_header_size(const rtpflow_t *p_flow)
+{
+    return p_flow->i_header_size;
+}
+
+/*****************************************************************************
+ * rtpflow_prepare
+ *****************************************************************************
+ * Must be called after the template has been filled, and after each later
+ * change. The variable fields of the template are ignored. The UDP
+ * checksum is computed if b_udp_cksum is true, and left to 0 (none)
+ * otherwise.
+ *****************************************************************************/
+static inline void rtpflow_prepare(rtpflow_t *p_flow, bool b_udp_cksum)
+{
+    uint8_t *p_ip = rtpflow_ip(p_flow);
+    uint8_t *p_udp = rtpflow_udp(p_flow);
+    uint8_t *p_rtp = rtpflow_rtp(p_flow);
+
+    p_flow->b_udp_cksum = b_udp_cksum;
+
+    /* the variable fields are zeroed in the template */
+    ip_set_len(p_ip, 0);
+    ip_set_id(p_ip, 0);
+    ip_set_cksum(p_ip, 0);
+    udp_set_len(p_udp, 0);
+    udp_set_cksum(p_udp, 0);
+    rtp_clear_marker(p_rtp);
+    rtp_set_seqnum(p_rtp, 0);
+    rtp_set_timestamp(p_rtp, 0);
+
+    p_flow->i_ip_sum = ip_cksum_partial(p_ip, IP_HEADER_MINSIZE, 0);
+    p_flow->i_udp_sum = ip_cksum_partial(p_udp,
+            UDP_HEADER_SIZE + RTP_HEADER_SIZE,
+            udp_cksum_pseudo(ip_get_srcaddr(p_ip), ip_get_dstaddr(p_ip), 0));
+}
+
+/* sets the IP identification of the next frame */
+static inline void rtpflow_set_id(rtpflow_t *p_flow, uint16_t i_id)
+{
+    p_flow->i_ip_id = i_id;
+}
+
+/* sets the RTP sequence number of the next frame */
+static inline void rtpflow_set_seqnum(rtpflow_t *p_flow, uint16_t i_seqnum)
+{
+    p_flow->i_seqnum = i_seqnum;
+}
+
+/*****************************************************************************
+ * rtpflow_write_header
+ *****************************************************************************
+ * Writes the headers at p_frame, in front of the i_payload_size bytes of
+ * payload already at p_frame + rtpflow_get_header_size(), and returns the
+ * size of the frame.
+ *****************************************************************************/
+static inline size_t rtpflow_write_header(rtpflow_t *p_flow, uint8_t *p_frame,
+                                          size_t i_payload_size,
+                                          uint32_t i_timestamp, bool b_marker)
+{
+    uint8_t *p_ip = p_frame + p_flow->i_ip_offset;
+    uint8_t *p_udp = p_frame + p_flow->i_udp_offset;
+    uint8_t *p_rtp = p_frame + p_flow->i_rtp_offset;
+    uint16_t i_udp_len = UDP_HEADER_SIZE + RTP_HEADER_SIZE + i_payload_size;
+    uint16_t i_ip_len = IP_HEADER_MINSIZE + i_udp_len;
+    uint16_t i_id = p_flow->i_ip_id++;
+    uint16_t i_seqnum = p_flow->i_seqnum++;
+    uint16_t i_cksum;
+
+    memcpy(p_frame, p_flow->p_header, p_flow->i_header_size);
+
+    i_cksum = ~ip_cksum_fold(p_flow->i_ip_sum + i_ip_len + i_id);
+    p_ip[2] = i_ip_len >> 8;
+    p_ip[3] = i_ip_len & 0xff;
+    p_ip[4] = i_id >> 8;
+    p_ip[5] = i_id & 0xff;
+    p_ip[10] = i_cksum >> 8;
+    p_ip[11] = i_cksum & 0xff;
+
+    p_udp[4] = i_udp_len >> 8;
+    p_udp[5] = i_udp_len & 0xff;
+
+    if (b_marker)
+        p_rtp[1] |= 0x80;
+    p_rtp[2] = i_seqnum >> 8;
+    p_rtp[3] = i_seqnum & 0xff;
+    p_rtp[4] = i_timestamp >> 24;
+    p_rtp[5] = (i_timestamp >> 16) & 0xff;
+    p_rtp[6] = (i_timestamp >> 8) & 0xff;
+    p_rtp[7] = i_timestamp & 0xff;
+
+    if (p_flow->b_udp_cksum) {
+        /* the length appears both in the pseudo-header and in the header */
+        uint64_t i_sum = p_flow->i_udp_sum + 2 * (uint64_t)i_udp_len +
+                         (b_marker ? 0x80 : 0) + i_seqnum + i_timestamp;
+        i_sum = ip_cksum_partial(p_rtp + RTP_HEADER_SIZE, i_payload_size,
+                                 i_sum);
+        i_cksum = ~ip_cksum_fold(i_sum);
+        if (!i_cksum)
+            i_cksum = 0xffff;
+        p_udp[6] = i_cksum >> 8;
+        p_udp[7] = i_cksum & 0xff;
+    }
+
+    return p_flow->i_header_size + i_payload_size;
+}
+
+/*****************************************************************************
+ * rtpflow_write
+ *****************************************************************************
+ * Writes a complete frame at p_frame (typically a slot of a TPACKET ring),
+ * copying the payload, and returns its size.
+ *****************************************************************************/
+static inline size_t rtpflow_write(rtpflow_t *p_flow, uint8_t *p_frame,
+                                   const uint8_t *p_payload,
+                                   size_t i_payload_size,
+                                   uint32_t i_timestamp, bool b_marker)
+{
+    memcpy(p_frame + p_flow->i_header_size, p_payload, i_payload_size);
+    return rtpflow_write_header(p_flow, p_frame, i_payload_size, i_timestamp,
+                                b_marker);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,272 @@
+/*****************************************************************************
+ * rtp_reorder.h: RTP reordering buffer
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The reordering buffer is a ring of caller-allocated slots, indexed by the
+ * extended sequence number modulo the (power of two) number of slots. It
+ * does not allocate nor copy: it keeps the pointers given by the caller and
+ * gives them back in sequence number order. Packets are released as soon as
+ * they are in order; a missing packet is waited for until the first packet
+ * received after it has been buffered for i_latency (in the caller's clock
+ * units), and then declared lost.
+ *
+ * Typical use:
+ *
+ *   while ((i_ret = rtpreorder_push(&r, p_rtp, i_size, i_now))
+ *           == RTPREORDER_FULL)
+ *       while ((p = rtpreorder_pop(&r, i_now, &i_psize)) != NULL)
+ *           output(p, i_psize);
+ *   if (i_ret != RTPREORDER_OK)
+ *       free(p_rtp);
+ *   while ((p = rtpreorder_pop(&r, i_now, &i_psize)) != NULL)
+ *       output(p, i_psize);
+ */
+
+#ifndef __BITSTREAM_IETF_RTP_REORDER_H__
+#define __BITSTREAM_IETF_RTP_REORDER_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/ietf/rtp.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RTPREORDER_OK           0
+#define RTPREORDER_LATE         1
+#define RTPREORDER_DUPLICATE    2
+#define RTPREORDER_FULL         3
+
+typedef struct rtpreorder_slot_t {
+    uint8_t *p_rtp;
+    size_t i_size;
+    uint64_t i_seqnum;
+    uint64_t i_date;
+} rtpreorder_slot_t;
+
+typedef struct rtpreorder_t {
+    rtpreorder_slot_t *p_slots;
+    uint64_t i_mask;
+    uint64_t i_latency;
+
+    bool b_started;
+    uint64_t i_next;
+    uint64_t i_highest;
+    uint64_t i_first;
+    uint64_t i_force;
+    uint64_t i_count;
+    uint64_t i_late_run;
+
+    /* statistics */
+    uint64_t i_received;
+    uint64_t i_delivered;
+    uint64_t i_lost;
+    uint64_t i_late;
+    uint64_t i_duplicate;
+    uint64_t i_reordered;
+    uint64_t i_max_depth;
+    uint32_t i_last_timestamp;
+} rtpreorder_t;
+
+/*****************************************************************************
+ * rtpreorder_init
+ *****************************************************************************
+ * i_nb_slots must be a power of two, and bounds the reordering window.
+ *****************************************************************************/
+static inline void rtpreorder_init(rtpreorder_t *p_reorder,
+                                   rtpreorder_slot_t *p_slots,
+                                   uint64_t i_nb_slots, uint64_t i_latency)
+{
+    memset(p_reorder, 0, sizeof(rtpreorder_t));
+    memset(p_slots, 0, i_nb_slots * sizeof(rtpreorder_slot_t));
+    p_reorder->p_slots = p_slots;
+    p_reorder->i_mask = i_nb_slots - 1;
+    p_reorder->i_latency = i_latency;
+}
+
+/*****************************************************************************
+ * rtpreorder_push
+ *****************************************************************************
+ * Returns RTPREORDER_OK if the packet has been buffered. Otherwise the
+ * caller keeps ownership of the packet: it was late or duplicate, or
+ * RTPREORDER_FULL if it is too far ahead, in which case the buffer must be
+ * drained with rtpreorder_pop() before pushing the packet again.
+ *****************************************************************************/
+static inline int rtpreorder_push(rtpreorder_t *p_reorder, uint8_t *p_rtp,
+                                  size_t i_size, uint64_t i_date)
+{
+    uint16_t i_seqnum = rtp_get_seqnum(p_rtp);
+    rtpreorder_slot_t *p_slot;
+    uint64_t i_ext;
+
+    if (!p_reorder->b_started || (p_reorder->i_late_run > p_reorder->i_mask
+                                   && !p_reorder->i_count)) {
+        /* (re)start beyond the sequence numbers used so far */
+        p_reorder->b_started = true;
+        p_reorder->i_late_run = 0;
+        p_reorder->i_next = p_reorder->i_highest = p_reorder->i_first =
+            p_reorder->i_force = rtp_seqnum_extend(p_reorder->i_highest +
+                                                   UINT64_C(0x10000),
+                                                   i_seqnum);
+    }
+
+    i_ext = rtp_seqnum_extend(p_reorder->i_highest, i_seqnum);
+
+    if (i_ext < p_reorder->i_next) {
+        if (++p_reorder->i_late_run > p_reorder->i_mask && p_reorder->i_count) {
+            /* the sender probably restarted, flush everything */
+            p_reorder->i_force = p_reorder->i_highest + 1;
+            return RTPREORDER_FULL;
+        }
+        p_reorder->i_received++;
+        p_reorder->i_late++;
+        return RTPREORDER_LATE;
+    }
+    p_reorder->i_late_run = 0;
+
+    if (i_ext - p_reorder->i_next > p_reorder->i_mask) {
+        p_reorder->i_force = i_ext - p_reorder->i_mask;
+        return RTPREORDER_FULL;
+    }
+
+    p_reorder->i_received++;
+    p_slot = &p_reorder->p_slots[i_ext & p_reorder->i_mask];
+    if (p_slot->p_rtp != NULL) {
+        p_reorder->i_duplicate++;
+        return RTPREORDER_DUPLICATE;
+    }
+
+    p_slot->p_rtp = p_rtp;
+    p_slot->i_size = i_size;
+    p_slot->i_seqnum = i_ext;
+    p_slot->i_date = i_date;
+    p_reorder->i_count++;
+
+    if (i_ext > p_reorder->i_highest)
+        p_reorder->i_highest = i_ext;
+    else if (i_ext < p_reorder->i_highest) {
+        p_reorder->i_reordered++;
+        if (p_reorder->i_highest - i_ext > p_reorder->i_max_depth)
+            p_reorder->i_max_depth = p_reorder->i_highest - i_ext;
+    }
+    if (i_ext < p_reorder->i_first)
+        p_reorder->i_first = i_ext;
+    return RTPREORDER_OK;
+}
+
+/* returns the extended sequence number of the first buffered packet */
+static inline uint64_t rtpreorder_first(rtpreorder_t *p_reorder)
+{
+    uint64_t i_first = p_reorder->i_first;
+    rtpreorder_slot_t *p_slot = &p_reorder->p_slots[i_first & p_reorder->i_mask];
+
+    if (i_first < p_reorder->i_next || p_slot->p_rtp == NULL ||
+        p_slot->i_seqnum != i_first) {
+        for (i_first = p_reorder->i_next; ; i_first++)
+            if (p_reorder->p_slots[i_first & p_reorder->i_mask].p_rtp != NULL)
+                break;
+        p_reorder->i_first = i_first;
+    }
+    return i_first;
+}
+
+/*****************************************************************************
+ * rtpreorder_pop
+ *****************************************************************************
+ * Returns the next packet to output in sequence order, or NULL if none is
+ * available at date i_now. Use UINT64_MAX as i_now to flush the buffer.
+ *****************************************************************************/
+static inline uint8_t *rtpreorder_pop(rtpreorder_t *p_reorder, uint64_t i_now,
+                                      size_t *pi_size)
+{
+    for ( ; ; ) {
+        rtpreorder_slot_t *p_slot;
+        uint64_t i_first, i_target;
+
+        if (!p_reorder->i_count) {
+            if (p_reorder->i_force > p_reorder->i_next) {
+                p_reorder->i_lost += p_reorder->i_force - p_reorder->i_next;
+                p_reorder->i_next = p_reorder->i_force;
+            }
+            return NULL;
+        }
+
+        p_slot = &p_reorder->p_slots[p_reorder->i_next & p_reorder->i_mask];
+        if (p_slot->p_rtp != NULL) {
+            uint8_t *p_rtp = p_slot->p_rtp;
+            *pi_size = p_slot->i_size;
+            p_slot->p_rtp = NULL;
+            p_reorder->i_count--;
+            p_reorder->i_next++;
+            p_reorder->i_delivered++;
+            p_reorder->i_last_timestamp = rtp_get_timestamp(p_rtp);
+            return p_rtp;
+        }
+
+        /* missing packet */
+        i_first = rtpreorder_first(p_reorder);
+        p_slot = &p_reorder->p_slots[i_first & p_reorder->i_mask];
+        if (i_now >= p_slot->i_date &&
+            i_now - p_slot->i_date >= p_reorder->i_latency)
+            i_target = i_first;
+        else if (p_reorder->i_force > p_reorder->i_next)
+            i_target = i_first < p_reorder->i_force ? i_first :
+                       p_reorder->i_force;
+        else
+            return NULL;
+
+        p_reorder->i_lost += i_target - p_reorder->i_next;
+        p_reorder->i_next = i_target;
+    }
+}
+
+/* returns the date at which rtpreorder_pop() may release a packet */
+static inline uint64_t rtpreorder_get_deadline(rtpreorder_t *p_reorder)
+{
+    rtpreorder_slot_t *p_slot;
+
+    if (!p_reorder->i_count)
+        return UINT64_MAX;
+    p_slot = &p_reorder->p_slots[p_reorder->i_next & p_reorder->i_mask];
+    if (p_slot->p_rtp != NULL)
+        return 0;
+    p_slot = &p_reorder->p_slots[rtpreorder_first(p_reorder) &
+                                 p_reorder->i_mask];
+    return p_slot->i_date + p_reorder->i_latency;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
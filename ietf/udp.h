@@ -28,12 +28,16 @@
 /*
  * Normative references:
  *  - IETF RFC 768 User Datagram Protocol (August 1980)
+ *  - IETF RFC 1624 Computation of the Internet Checksum via Incremental
+ *    Update (May 1994)
  */
 
 #ifndef __BITSTREAM_IETF_UDP_H__
 #define __BITSTREAM_IETF_UDP_H__
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <bitstream/ietf/ip.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -103,6 +107,72 @@ static inline uint8_t *udp_payload(uint8_t *p_udp)
     return p_udp + UDP_HEADER_SIZE;
 }
 
+/*****************************************************************************
+ * UDP checksum over IPv4
+ *****************************************************************************
+ * A checksum of 0 means that no checksum was computed, so a computed
+ * checksum of 0 is transmitted as 0xffff.
+ *****************************************************************************/
+/* returns the partial sum of the IPv4 pseudo-header */
+static inline uint64_t udp_cksum_pseudo(uint32_t i_srcaddr, uint32_t i_dstaddr,
+                                        uint16_t i_len)
+{
+    return (uint64_t)i_srcaddr + i_dstaddr + IP_PROTO_UDP + i_len;
+}
+
+/* computes the checksum of the datagram (of udp_get_len() bytes) */
+static inline uint16_t udp_cksum(const uint8_t *p_udp, uint32_t i_srcaddr,
+                                 uint32_t i_dstaddr)
+{
+    uint16_t i_len = udp_get_len(p_udp);
+    uint64_t i_sum = udp_cksum_pseudo(i_srcaddr, i_dstaddr, i_len);
+    uint16_t i_cksum;
+
+    /* the checksum field itself is skipped */
+    i_sum = ip_cksum_partial(p_udp, 6, i_sum);
+    if (i_len > UDP_HEADER_SIZE)
+        i_sum = ip_cksum_partial(p_udp + UDP_HEADER_SIZE,
+                                 i_len - UDP_HEADER_SIZE, i_sum);
+    i_cksum = ~ip_cksum_fold(i_sum);
+    return i_cksum ? i_cksum : 0xffff;
+}
+
+/* computes and sets the checksum of a datagram carried by p_ip */
+static inline void udp_set_cksum_ip(uint8_t *p_udp, const uint8_t *p_ip)
+{
+    udp_set_cksum(p_udp, udp_cksum(p_udp, ip_get_srcaddr(p_ip),
+                                   ip_get_dstaddr(p_ip)));
+}
+
+static inline bool udp_check_cksum_ip(const uint8_t *p_udp, const uint8_t *p_ip)
+{
+    return !udp_get_cksum(p_udp) ||
+           udp_get_cksum(p_udp) == udp_cksum(p_udp, ip_get_srcaddr(p_ip),
+                                             ip_get_dstaddr(p_ip));
+}
+
+/* updates the checksum after a 16-bit word of the datagram, or of the
+ * pseudo-header, changed from i_old to i_new */
+static inline void udp_update_cksum16(uint8_t *p_udp, uint16_t i_old,
+                                      uint16_t i_new)
+{
+    uint16_t i_cksum = udp_get_cksum(p_udp);
+    if (!i_cksum)
+        return;
+    i_cksum = ip_cksum_update16(i_cksum, i_old, i_new);
+    udp_set_cksum(p_udp, i_cksum ? i_cksum : 0xffff);
+}
+
+static inline void udp_update_cksum32(uint8_t *p_udp, uint32_t i_old,
+                                      uint32_t i_new)
+{
+    uint16_t i_cksum = udp_get_cksum(p_udp);
+    if (!i_cksum)
+        return;
+    i_cksum = ip_cksum_update32(i_cksum, i_old, i_new);
+    udp_set_cksum(p_udp, i_cksum ? i_cksum : 0xffff);
+}
+
 #ifdef __cplusplus
 }
 #endif
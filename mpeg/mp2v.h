@@ -598,7 +598,7 @@ static inline void mp2vgop_set_timecode(uint8_t *p_mp2vgop, uint32_t i_timecode)
     p_mp2vgop[7] |= (i_timecode << 7) & 0x80;
 }
 
-static inline uint16_t mp2vgop_get_timecode(const uint8_t *p_mp2vgop)
+static inline uint32_t mp2vgop_get_timecode(const uint8_t *p_mp2vgop)
 {
     return (p_mp2vgop[4] << 17) | (p_mp2vgop[5] << 9) | (p_mp2vgop[6] << 1) |
            (p_mp2vgop[7] >> 7);
@@ -0,0 +1,473 @@
+/*****************************************************************************
+ * mp2v_index.h: ISO/IEC 13818-2 (video) picture index
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - ISO/IEC 13818-2 (MPEG-2 video)
+ */
+
+/*
+ * The indexer is fed with chunks of elementary stream (typically PES
+ * payloads) and emits one fixed-size record per picture, in decoding order.
+ * Each picture record covers the access unit, that is the sequence and GOP
+ * headers immediately preceding the picture header, the picture itself and
+ * its slices. Records are stored big-endian and have no alignment
+ * requirement, so that an index file made of an index header followed by
+ * records may be written as is and mmap()ed later for random access.
+ */
+
+#ifndef __BITSTREAM_MPEG_MP2V_INDEX_H__
+#define __BITSTREAM_MPEG_MP2V_INDEX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memchr, memcpy, memset */
+#include <bitstream/mpeg/mp2v.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * MP2V index header
+ *****************************************************************************/
+#define MP2VIDX_HEADER_SIZE         8
+#define MP2VIDX_VERSION             1
+#define MP2VIDXR_SIZE               32
+
+static inline void mp2vidx_init(uint8_t *p_mp2vidx)
+{
+    p_mp2vidx[0] = 'M';
+    p_mp2vidx[1] = '2';
+    p_mp2vidx[2] = 'V';
+    p_mp2vidx[3] = 'I';
+    p_mp2vidx[4] = MP2VIDX_VERSION;
+    p_mp2vidx[5] = MP2VIDXR_SIZE;
+    p_mp2vidx[6] = 0x0;
+    p_mp2vidx[7] = 0x0;
+}
+
+static inline uint8_t mp2vidx_get_version(const uint8_t *p_mp2vidx)
+{
+    return p_mp2vidx[4];
+}
+
+static inline uint8_t mp2vidx_get_recordsize(const uint8_t *p_mp2vidx)
+{
+    return p_mp2vidx[5];
+}
+
+/*****************************************************************************
+ * MP2V index record
+ *****************************************************************************/
+#define MP2VIDXR_FLAG_SEQ           0x80
+#define MP2VIDXR_FLAG_GOP           0x40
+#define MP2VIDXR_FLAG_CLOSEDGOP     0x20
+#define MP2VIDXR_FLAG_BROKENLINK    0x10
+#define MP2VIDXR_CODINGTYPE_MASK    0x07
+
+static inline void mp2vidxr_init(uint8_t *p_mp2vidxr)
+{
+    memset(p_mp2vidxr, 0, MP2VIDXR_SIZE);
+}
+
+static inline void mp2vidxr_set_u64(uint8_t *p, uint64_t i_value)
+{
+    int i;
+    for (i = 7; i >= 0; i--) {
+        p[i] = i_value & 0xff;
+        i_value >>= 8;
+    }
+}
+
+static inline uint64_t mp2vidxr_get_u64(const uint8_t *p)
+{
+    uint64_t i_value = 0;
+    int i;
+    for (i = 0; i < 8; i++)
+        i_value = (i_value << 8) | p[i];
+    return i_value;
+}
+
+/* position given by the caller for the chunk containing the first byte */
+static inline void mp2vidxr_set_pos(uint8_t *p_mp2vidxr, uint64_t i_pos)
+{
+    mp2vidxr_set_u64(p_mp2vidxr, i_pos);
+}
+
+static inline uint64_t mp2vidxr_get_pos(const uint8_t *p_mp2vidxr)
+{
+    return mp2vidxr_get_u64(p_mp2vidxr);
+}
+
+/* offset of the first byte in the elementary stream */
+static inline void mp2vidxr_set_offset(uint8_t *p_mp2vidxr, uint64_t i_offset)
+{
+    mp2vidxr_set_u64(p_mp2vidxr + 8, i_offset);
+}
+
+static inline uint64_t mp2vidxr_get_offset(const uint8_t *p_mp2vidxr)
+{
+    return mp2vidxr_get_u64(p_mp2vidxr + 8);
+}
+
+static inline void mp2vidxr_set_size(uint8_t *p_mp2vidxr, uint32_t i_size)
+{
+    p_mp2vidxr[16] = i_size >> 24;
+    p_mp2vidxr[17] = (i_size >> 16) & 0xff;
+    p_mp2vidxr[18] = (i_size >> 8) & 0xff;
+    p_mp2vidxr[19] = i_size & 0xff;
+}
+
+static inline uint32_t mp2vidxr_get_size(const uint8_t *p_mp2vidxr)
+{
+    return ((uint32_t)p_mp2vidxr[16] << 24) | (p_mp2vidxr[17] << 16) |
+           (p_mp2vidxr[18] << 8) | p_mp2vidxr[19];
+}
+
+static inline void mp2vidxr_set_flags(uint8_t *p_mp2vidxr, uint8_t i_flags)
+{
+    p_mp2vidxr[20] &= MP2VIDXR_CODINGTYPE_MASK;
+    p_mp2vidxr[20] |= i_flags & ~MP2VIDXR_CODINGTYPE_MASK;
+}
+
+static inline uint8_t mp2vidxr_get_flags(const uint8_t *p_mp2vidxr)
+{
+    return p_mp2vidxr[20] & ~MP2VIDXR_CODINGTYPE_MASK;
+}
+
+static inline void mp2vidxr_set_codingtype(uint8_t *p_mp2vidxr,
+                                           uint8_t i_codingtype)
+{
+    p_mp2vidxr[20] &= ~MP2VIDXR_CODINGTYPE_MASK;
+    p_mp2vidxr[20] |= i_codingtype & MP2VIDXR_CODINGTYPE_MASK;
+}
+
+static inline uint8_t mp2vidxr_get_codingtype(const uint8_t *p_mp2vidxr)
+{
+    return p_mp2vidxr[20] & MP2VIDXR_CODINGTYPE_MASK;
+}
+
+static inline void mp2vidxr_set_temporalreference(uint8_t *p_mp2vidxr,
+                                                  uint16_t i_temporalreference)
+{
+    p_mp2vidxr[22] = (i_temporalreference >> 8) & 0x3;
+    p_mp2vidxr[23] = i_temporalreference & 0xff;
+}
+
+static inline uint16_t mp2vidxr_get_temporalreference(const uint8_t *p_mp2vidxr)
+{
+    return ((p_mp2vidxr[22] & 0x3) << 8) | p_mp2vidxr[23];
+}
+
+static inline void mp2vidxr_set_vbvdelay(uint8_t *p_mp2vidxr,
+                                         uint16_t i_vbvdelay)
+{
+    p_mp2vidxr[24] = i_vbvdelay >> 8;
+    p_mp2vidxr[25] = i_vbvdelay & 0xff;
+}
+
+static inline uint16_t mp2vidxr_get_vbvdelay(const uint8_t *p_mp2vidxr)
+{
+    return (p_mp2vidxr[24] << 8) | p_mp2vidxr[25];
+}
+
+/* time code of the last GOP header seen before this picture */
+static inline void mp2vidxr_set_timecode(uint8_t *p_mp2vidxr,
+                                         uint32_t i_timecode)
+{
+    p_mp2vidxr[26] = (i_timecode >> 24) & 0x1;
+    p_mp2vidxr[27] = (i_timecode >> 16) & 0xff;
+    p_mp2vidxr[28] = (i_timecode >> 8) & 0xff;
+    p_mp2vidxr[29] = i_timecode & 0xff;
+}
+
+static inline uint32_t mp2vidxr_get_timecode(const uint8_t *p_mp2vidxr)
+{
+    return ((p_mp2vidxr[26] & 0x1) << 24) | (p_mp2vidxr[27] << 16) |
+           (p_mp2vidxr[28] << 8) | p_mp2vidxr[29];
+}
+
+static inline bool mp2vidxr_is_randomaccess(const uint8_t *p_mp2vidxr)
+{
+    return mp2vidxr_get_codingtype(p_mp2vidxr) == MP2VPIC_TYPE_I &&
+           (mp2vidxr_get_flags(p_mp2vidxr) & MP2VIDXR_FLAG_SEQ);
+}
+
+/*****************************************************************************
+ * MP2V index lookup (on a mapped index file)
+ *****************************************************************************/
+static inline const uint8_t *mp2vidx_get_record(const uint8_t *p_mp2vidx,
+                                                uint64_t n)
+{
+    return p_mp2vidx + MP2VIDX_HEADER_SIZE + n * MP2VIDXR_SIZE;
+}
+
+static inline bool mp2vidx_validate(const uint8_t *p_mp2vidx, size_t i_size)
+{
+    return i_size >= MP2VIDX_HEADER_SIZE &&
+           !memcmp(p_mp2vidx, "M2VI", 4) &&
+           mp2vidx_get_version(p_mp2vidx) == MP2VIDX_VERSION &&
+           mp2vidx_get_recordsize(p_mp2vidx) == MP2VIDXR_SIZE &&
+           !((i_size - MP2VIDX_HEADER_SIZE) % MP2VIDXR_SIZE);
+}
+
+static inline uint64_t mp2vidx_get_count(size_t i_size)
+{
+    return (i_size - MP2VIDX_HEADER_SIZE) / MP2VIDXR_SIZE;
+}
+
+/* returns the last picture starting at or before the ES offset, or NULL */
+static inline const uint8_t *mp2vidx_find_offset(const uint8_t *p_mp2vidx,
+                                                 uint64_t i_count,
+                                                 uint64_t i_offset)
+{
+    uint64_t i_low = 0, i_high = i_count;
+
+    while (i_low < i_high) {
+        uint64_t i_mid = i_low + (i_high - i_low) / 2;
+        if (mp2vidxr_get_offset(mp2vidx_get_record(p_mp2vidx, i_mid))
+             <= i_offset)
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low ? mp2vidx_get_record(p_mp2vidx, i_low - 1) : NULL;
+}
+
+/* returns the closest random access point at or before picture n, or NULL */
+static inline const uint8_t *mp2vidx_find_randomaccess(const uint8_t *p_mp2vidx,
+                                                       uint64_t i_count,
+                                                       uint64_t n)
+{
+    if (n >= i_count)
+        n = i_count;
+    else
+        n++;
+    while (n) {
+        const uint8_t *p_mp2vidxr = mp2vidx_get_record(p_mp2vidx, --n);
+        if (mp2vidxr_is_randomaccess(p_mp2vidxr))
+            return p_mp2vidxr;
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * MP2V indexer
+ *****************************************************************************/
+typedef struct mp2vidx_t {
+    /* start code detection */
+    uint64_t i_offset;
+    uint8_t i_zeros;
+    bool b_prefix;
+
+    /* header being gathered */
+    uint8_t p_header[MP2VPIC_HEADER_SIZE];
+    uint8_t i_header_used;
+
+    /* positions of the current and previous chunks */
+    bool b_partial;
+    uint64_t i_pos;
+    uint64_t i_pos_offset;
+    uint64_t i_last_pos;
+
+    /* access unit being indexed */
+    bool b_au;
+    bool b_picture;
+    uint32_t i_timecode;
+    uint8_t p_record[MP2VIDXR_SIZE];
+} mp2vidx_t;
+
+static inline void mp2vidx_reset(mp2vidx_t *p_idx)
+{
+    memset(p_idx, 0, sizeof(mp2vidx_t));
+    p_idx->i_header_used = MP2VPIC_HEADER_SIZE;
+}
+
+static inline bool mp2vidx_end_au(mp2vidx_t *p_idx, uint64_t i_end,
+                                  uint8_t *p_mp2vidxr)
+{
+    bool b_ret = p_idx->b_picture;
+
+    if (b_ret) {
+        mp2vidxr_set_size(p_idx->p_record,
+                          i_end - mp2vidxr_get_offset(p_idx->p_record));
+        memcpy(p_mp2vidxr, p_idx->p_record, MP2VIDXR_SIZE);
+    }
+    p_idx->b_au = p_idx->b_picture = false;
+    return b_ret;
+}
+
+static inline void mp2vidx_parse_header(mp2vidx_t *p_idx)
+{
+    const uint8_t *p_header = p_idx->p_header;
+    uint8_t *p_record = p_idx->p_record;
+
+    if (p_header[3] == MP2VGOP_START_CODE) {
+        uint8_t i_flags = mp2vidxr_get_flags(p_record);
+        if (mp2vgop_get_closedgop(p_header))
+            i_flags |= MP2VIDXR_FLAG_CLOSEDGOP;
+        if (mp2vgop_get_brokenlink(p_header))
+            i_flags |= MP2VIDXR_FLAG_BROKENLINK;
+        mp2vidxr_set_flags(p_record, i_flags);
+        p_idx->i_timecode = mp2vgop_get_timecode(p_header);
+    } else {
+        mp2vidxr_set_codingtype(p_record, mp2vpic_get_codingtype(p_header));
+        mp2vidxr_set_temporalreference(p_record,
+                mp2vpic_get_temporalreference(p_header));
+        mp2vidxr_set_vbvdelay(p_record, mp2vpic_get_vbvdelay(p_header));
+        mp2vidxr_set_timecode(p_record, p_idx->i_timecode);
+    }
+}
+
+/*****************************************************************************
+ * mp2vidx_feed
+ *****************************************************************************
+ * Consumes elementary stream data from *pp_payload, and returns true when a
+ * picture record has been completed and copied to p_mp2vidxr. In that case
+ * the remaining data must be fed again with the same i_pos. i_pos is an
+ * opaque position (for instance the file offset of the TS packet) copied
+ * to the records of access units starting in this chunk; chunks are
+ * expected to be larger than a start code prefix.
+ *****************************************************************************/
+static inline bool mp2vidx_feed(mp2vidx_t *p_idx, const uint8_t **pp_payload,
+                                size_t *pi_length, uint64_t i_pos,
+                                uint8_t *p_mp2vidxr)
+{
+    const uint8_t *p_buf = *pp_payload;
+    const uint8_t *p_end = p_buf + *pi_length;
+    const uint8_t *p_chunk = p_buf;
+    uint64_t i_chunk_offset = p_idx->i_offset;
+    bool b_ret = false;
+
+    if (!p_idx->b_partial) {
+        p_idx->i_last_pos = p_idx->i_pos;
+        p_idx->i_pos = i_pos;
+        p_idx->i_pos_offset = i_chunk_offset;
+    }
+
+    while (p_buf < p_end && !b_ret) {
+        uint8_t i_code;
+        uint64_t i_start;
+
+        if (p_idx->i_header_used < MP2VPIC_HEADER_SIZE) {
+            size_t i_copy = MP2VPIC_HEADER_SIZE - p_idx->i_header_used;
+            if (i_copy > (size_t)(p_end - p_buf))
+                i_copy = p_end - p_buf;
+            memcpy(p_idx->p_header + p_idx->i_header_used, p_buf, i_copy);
+            p_idx->i_header_used += i_copy;
+            p_buf += i_copy;
+            if (p_idx->i_header_used == MP2VPIC_HEADER_SIZE)
+                mp2vidx_parse_header(p_idx);
+            continue;
+        }
+
+        if (!p_idx->b_prefix) {
+            if (*p_buf == 0x1 && p_idx->i_zeros >= 2)
+                p_idx->b_prefix = true;
+            else if (*p_buf == 0x0) {
+                if (p_idx->i_zeros < 2)
+                    p_idx->i_zeros++;
+            } else {
+                /* skip to the next candidate prefix */
+                const uint8_t *p_zero = (const uint8_t *)
+                    memchr(p_buf + 1, 0x0, p_end - p_buf - 1);
+                p_idx->i_zeros = 0;
+                p_buf = p_zero != NULL ? p_zero : p_end;
+                continue;
+            }
+            p_buf++;
+            continue;
+        }
+
+        /* start code value */
+        i_code = *p_buf++;
+        p_idx->b_prefix = false;
+        p_idx->i_zeros = 0;
+        i_start = i_chunk_offset + (p_buf - p_chunk) - 4;
+
+        switch (i_code) {
+        case MP2VSEQ_START_CODE:
+        case MP2VGOP_START_CODE:
+        case MP2VPIC_START_CODE:
+        case MP2VEND_START_CODE:
+            if (p_idx->b_picture)
+                b_ret = mp2vidx_end_au(p_idx, i_start, p_mp2vidxr);
+            if (i_code == MP2VEND_START_CODE)
+                break;
+
+            if (!p_idx->b_au) {
+                mp2vidxr_init(p_idx->p_record);
+                mp2vidxr_set_pos(p_idx->p_record,
+                        i_start >= p_idx->i_pos_offset ? p_idx->i_pos :
+                        p_idx->i_last_pos);
+                mp2vidxr_set_offset(p_idx->p_record, i_start);
+                p_idx->b_au = true;
+            }
+
+            if (i_code == MP2VSEQ_START_CODE)
+                mp2vidxr_set_flags(p_idx->p_record,
+                        mp2vidxr_get_flags(p_idx->p_record) |
+                        MP2VIDXR_FLAG_SEQ);
+            else {
+                if (i_code == MP2VGOP_START_CODE)
+                    mp2vidxr_set_flags(p_idx->p_record,
+                            mp2vidxr_get_flags(p_idx->p_record) |
+                            MP2VIDXR_FLAG_GOP);
+                else
+                    p_idx->b_picture = true;
+                mp2vstart_init(p_idx->p_header, i_code);
+                p_idx->i_header_used = 4;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    p_idx->i_offset = i_chunk_offset + (p_buf - p_chunk);
+    *pi_length -= p_buf - *pp_payload;
+    *pp_payload = p_buf;
+    p_idx->b_partial = !!*pi_length;
+    return b_ret;
+}
+
+/* flushes the last picture at the end of the stream */
+static inline bool mp2vidx_flush(mp2vidx_t *p_idx, uint8_t *p_mp2vidxr)
+{
+    bool b_ret = mp2vidx_end_au(p_idx, p_idx->i_offset, p_mp2vidxr);
+    p_idx->i_header_used = MP2VPIC_HEADER_SIZE;
+    p_idx->b_prefix = false;
+    p_idx->i_zeros = 0;
+    return b_ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,303 @@
+/*****************************************************************************
+ * ts_index.h: ISO/IEC 13818-1 transport stream random access index
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - ISO/IEC 13818-1:2007(E) (MPEG-2 systems)
+ */
+
+/*
+ * The indexer is fed with every TS packet of a recording, and emits one
+ * fixed-size record per random access point of the indexed PID, that is a
+ * packet with the random_access_indicator set and starting a PES with a PTS.
+ * Records carry the position of the packet, the last PCR seen on the PCR PID
+ * and the PTS. Both time stamps are extended past their 33-bit wraparound
+ * so that they grow monotonically across the recording, which allows a plain
+ * binary search on a mmap()ed index file (index header followed by records,
+ * big-endian and unaligned).
+ */
+
+#ifndef __BITSTREAM_MPEG_TS_INDEX_H__
+#define __BITSTREAM_MPEG_TS_INDEX_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcmp, memset */
+#include <bitstream/common.h>
+#include <bitstream/mpeg/ts.h>
+#include <bitstream/mpeg/pes.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define TSIDX_PTS_WRAP              (UINT64_C(1) << 33)
+#define TSIDX_PCR_WRAP              (TSIDX_PTS_WRAP * 300)
+
+/*****************************************************************************
+ * TS index header
+ *****************************************************************************/
+#define TSIDX_HEADER_SIZE           8
+#define TSIDX_VERSION               1
+#define TSIDXR_SIZE                 24
+
+static inline void tsidx_init(uint8_t *p_tsidx, uint16_t i_pid)
+{
+    p_tsidx[0] = 'M';
+    p_tsidx[1] = '2';
+    p_tsidx[2] = 'T';
+    p_tsidx[3] = 'I';
+    p_tsidx[4] = TSIDX_VERSION;
+    p_tsidx[5] = TSIDXR_SIZE;
+    p_tsidx[6] = (i_pid >> 8) & 0x1f;
+    p_tsidx[7] = i_pid & 0xff;
+}
+
+static inline uint8_t tsidx_get_version(const uint8_t *p_tsidx)
+{
+    return p_tsidx[4];
+}
+
+static inline uint8_t tsidx_get_recordsize(const uint8_t *p_tsidx)
+{
+    return p_tsidx[5];
+}
+
+static inline uint16_t tsidx_get_pid(const uint8_t *p_tsidx)
+{
+    return ((p_tsidx[6] & 0x1f) << 8) | p_tsidx[7];
+}
+
+/*****************************************************************************
+ * TS index record
+ *****************************************************************************/
+static inline void tsidxr_set_u64(uint8_t *p, uint64_t i_value)
+{
+    int i;
+    for (i = 7; i >= 0; i--) {
+        p[i] = i_value & 0xff;
+        i_value >>= 8;
+    }
+}
+
+static inline uint64_t tsidxr_get_u64(const uint8_t *p)
+{
+    uint64_t i_value = 0;
+    int i;
+    for (i = 0; i < 8; i++)
+        i_value = (i_value << 8) | p[i];
+    return i_value;
+}
+
+static inline void tsidxr_set_pos(uint8_t *p_tsidxr, uint64_t i_pos)
+{
+    tsidxr_set_u64(p_tsidxr, i_pos);
+}
+
+static inline uint64_t tsidxr_get_pos(const uint8_t *p_tsidxr)
+{
+    return tsidxr_get_u64(p_tsidxr);
+}
+
+/* extended PCR, in 27 MHz units */
+static inline void tsidxr_set_pcr(uint8_t *p_tsidxr, uint64_t i_pcr)
+{
+    tsidxr_set_u64(p_tsidxr + 8, i_pcr);
+}
+
+static inline uint64_t tsidxr_get_pcr(const uint8_t *p_tsidxr)
+{
+    return tsidxr_get_u64(p_tsidxr + 8);
+}
+
+/* extended PTS, in 90 kHz units */
+static inline void tsidxr_set_pts(uint8_t *p_tsidxr, uint64_t i_pts)
+{
+    tsidxr_set_u64(p_tsidxr + 16, i_pts);
+}
+
+static inline uint64_t tsidxr_get_pts(const uint8_t *p_tsidxr)
+{
+    return tsidxr_get_u64(p_tsidxr + 16);
+}
+
+/*****************************************************************************
+ * TS index lookup (on a mapped index file)
+ *****************************************************************************/
+static inline const uint8_t *tsidx_get_record(const uint8_t *p_tsidx,
+                                              uint64_t n)
+{
+    return p_tsidx + TSIDX_HEADER_SIZE + n * TSIDXR_SIZE;
+}
+
+static inline bool tsidx_validate(const uint8_t *p_tsidx, size_t i_size)
+{
+    return i_size >= TSIDX_HEADER_SIZE &&
+           !memcmp(p_tsidx, "M2TI", 4) &&
+           tsidx_get_version(p_tsidx) == TSIDX_VERSION &&
+           tsidx_get_recordsize(p_tsidx) == TSIDXR_SIZE &&
+           !((i_size - TSIDX_HEADER_SIZE) % TSIDXR_SIZE);
+}
+
+static inline uint64_t tsidx_get_count(size_t i_size)
+{
+    return (i_size - TSIDX_HEADER_SIZE) / TSIDXR_SIZE;
+}
+
+/* returns the last record whose extended PCR is at or before i_pcr */
+static inline const uint8_t *tsidx_find_pcr_ext(const uint8_t *p_tsidx,
+                                                uint64_t i_count,
+                                                uint64_t i_pcr)
+{
+    uint64_t i_low = 0, i_high = i_count;
+
+    while (i_low < i_high) {
+        uint64_t i_mid = i_low + (i_high - i_low) / 2;
+        if (tsidxr_get_pcr(tsidx_get_record(p_tsidx, i_mid)) <= i_pcr)
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low ? tsidx_get_record(p_tsidx, i_low - 1) : NULL;
+}
+
+/* returns the last record whose extended PTS is at or before i_pts */
+static inline const uint8_t *tsidx_find_pts_ext(const uint8_t *p_tsidx,
+                                                uint64_t i_count,
+                                                uint64_t i_pts)
+{
+    uint64_t i_low = 0, i_high = i_count;
+
+    while (i_low < i_high) {
+        uint64_t i_mid = i_low + (i_high - i_low) / 2;
+        if (tsidxr_get_pts(tsidx_get_record(p_tsidx, i_mid)) <= i_pts)
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low ? tsidx_get_record(p_tsidx, i_low - 1) : NULL;
+}
+
+/* i_pcr is a 27 MHz PCR as found in the stream, at or after the first one */
+static inline const uint8_t *tsidx_find_pcr(const uint8_t *p_tsidx,
+                                            uint64_t i_count, uint64_t i_pcr)
+{
+    uint64_t i_first;
+
+    if (!i_count)
+        return NULL;
+    i_first = tsidxr_get_pcr(tsidx_get_record(p_tsidx, 0));
+    return tsidx_find_pcr_ext(p_tsidx, i_count, i_first +
+            (i_pcr % TSIDX_PCR_WRAP + TSIDX_PCR_WRAP - i_first % TSIDX_PCR_WRAP)
+             % TSIDX_PCR_WRAP);
+}
+
+/* i_pts is a 33-bit PTS as found in the stream, at or after the first one */
+static inline const uint8_t *tsidx_find_pts(const uint8_t *p_tsidx,
+                                            uint64_t i_count, uint64_t i_pts)
+{
+    uint64_t i_first;
+
+    if (!i_count)
+        return NULL;
+    i_first = tsidxr_get_pts(tsidx_get_record(p_tsidx, 0));
+    return tsidx_find_pts_ext(p_tsidx, i_count, i_first +
+            (i_pts % TSIDX_PTS_WRAP + TSIDX_PTS_WRAP - i_first % TSIDX_PTS_WRAP)
+             % TSIDX_PTS_WRAP);
+}
+
+/*****************************************************************************
+ * TS indexer
+ *****************************************************************************/
+typedef struct tsidx_t {
+    uint16_t i_pid;
+    uint16_t i_pcr_pid;
+    bool b_pcr;
+    bool b_pts;
+    uint64_t i_pcr;
+    uint64_t i_pts;
+} tsidx_t;
+
+static inline void tsidx_reset(tsidx_t *p_idx, uint16_t i_pid,
+                               uint16_t i_pcr_pid)
+{
+    memset(p_idx, 0, sizeof(tsidx_t));
+    p_idx->i_pid = i_pid;
+    p_idx->i_pcr_pid = i_pcr_pid;
+}
+
+/*****************************************************************************
+ * tsidx_packet
+ *****************************************************************************
+ * Returns true and fills p_tsidxr if the TS packet at position i_pos is a
+ * random access point of the indexed PID. Random access points seen before
+ * the first PCR are not indexed.
+ *****************************************************************************/
+static inline bool tsidx_packet(tsidx_t *p_idx, const uint8_t *p_ts,
+                                uint64_t i_pos, uint8_t *p_tsidxr)
+{
+    uint16_t i_pid = ts_get_pid(p_ts);
+    const uint8_t *p_pes;
+    uint64_t i_pts;
+
+    if (!ts_validate(p_ts) || ts_get_transporterror(p_ts))
+        return false;
+
+    if (i_pid == p_idx->i_pcr_pid && ts_has_adaptation(p_ts) &&
+        ts_get_adaptation(p_ts) && tsaf_has_pcr(p_ts)) {
+        uint64_t i_pcr = tsaf_get_pcr(p_ts) * 300 + tsaf_get_pcrext(p_ts);
+        p_idx->i_pcr = p_idx->b_pcr ?
+            bitstream_extend(p_idx->i_pcr, i_pcr, TSIDX_PCR_WRAP) : i_pcr;
+        p_idx->b_pcr = true;
+    }
+
+    if (i_pid != p_idx->i_pid || !p_idx->b_pcr ||
+        !ts_get_unitstart(p_ts) || !ts_has_adaptation(p_ts) ||
+        !ts_get_adaptation(p_ts) || !tsaf_has_randomaccess(p_ts))
+        return false;
+
+    p_pes = ts_payload((uint8_t *)p_ts);
+    if (p_pes + PES_HEADER_SIZE_PTS > p_ts + TS_SIZE ||
+        !pes_validate(p_pes) || !pes_validate_header(p_pes) ||
+        !pes_has_pts(p_pes) || !pes_validate_pts(p_pes))
+        return false;
+
+    i_pts = pes_get_pts(p_pes);
+    p_idx->i_pts = p_idx->b_pts ?
+        bitstream_extend(p_idx->i_pts, i_pts, TSIDX_PTS_WRAP) : i_pts;
+    p_idx->b_pts = true;
+
+    tsidxr_set_pos(p_tsidxr, i_pos);
+    tsidxr_set_pcr(p_tsidxr, p_idx->i_pcr);
+    tsidxr_set_pts(p_tsidxr, p_idx->i_pts);
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,6 +35,7 @@
 
 #include <stdint.h>   /* uint8_t, uint16_t, etc... */
 #include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy */
 
 #ifdef __cplusplus
 extern "C"
@@ -42,6 +43,10 @@ extern "C"
 #endif
 
 #define SMPTE_2022_FEC_HEADER_SIZE 16
+#define SMPTE_FEC_MAX_L             20
+#define SMPTE_FEC_MAX_D             20
+#define SMPTE_FEC_MAX_SIZE          1500 /* whole RTP packet */
+#define SMPTE_FEC_RTP_TYPE          96
 
 /*
  * Reminder : FEC Header
@@ -160,7 +165,7 @@ static inline void smpte_fec_set_type(uint8_t *p_fec, uint8_t type)
     p_fec[12] = (p_fec[12] & 0xc7) | (type << 3);
 }
 
-static inline uint8_t smpte_fec_get_type(uint8_t *p_fec)
+static inline uint8_t smpte_fec_get_type(const uint8_t *p_fec)
 {
     return (p_fec[12] >> 3) & 0x7;
 }
@@ -171,7 +176,7 @@ static inline void smpte_fec_set_index(uint8_t *p_fec, uint8_t index)
     p_fec[12] = (p_fec[12] & 0xf8) | index;
 }
 
-static inline uint8_t smpte_fec_get_index(uint8_t *p_fec)
+static inline uint8_t smpte_fec_get_index(const uint8_t *p_fec)
 {
     return p_fec[12] & 0x7;
 }
@@ -206,6 +211,31 @@ static inline uint8_t smpte_fec_get_snbase_ext(const uint8_t *p_fec)
     return p_fec[15];
 }
 
+/*****************************************************************************
+ * FEC payload
+ *****************************************************************************
+ * XORs i_size bytes of p_src into p_dst, a word at a time so that compilers
+ * vectorize the main loop.
+ *****************************************************************************/
+static inline void smpte_fec_xor(uint8_t *p_dst, const uint8_t *p_src,
+                                 size_t i_size)
+{
+    size_t i = 0;
+
+    for ( ; i + 32 <= i_size; i += 32) {
+        uint64_t p_a[4], p_b[4];
+        memcpy(p_a, p_dst + i, 32);
+        memcpy(p_b, p_src + i, 32);
+        p_a[0] ^= p_b[0];
+        p_a[1] ^= p_b[1];
+        p_a[2] ^= p_b[2];
+        p_a[3] ^= p_b[3];
+        memcpy(p_dst + i, p_a, 32);
+    }
+    for ( ; i < i_size; i++)
+        p_dst[i] ^= p_src[i];
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,385 @@
+/*****************************************************************************
+ * 2022_1_fec_dec.h: SMPTE 2022-1 FEC receiver
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - SMPTE 2022-1
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The receiver keeps a copy of the last SMPTE_FECDEC_WINDOW media packets
+ * and of the column and row FEC packets protecting them. Whenever a FEC
+ * packet covers exactly one missing media packet, that packet is rebuilt
+ * from the XOR of the others and of the FEC payload, which may in turn
+ * unlock other FEC packets of the other dimension. FEC packets which cover
+ * several missing packets are kept pending, and tried again as the media
+ * packets arrive, in case they were only late. Media packets are not
+ * delayed: the caller forwards them as received, and fetches the recovered
+ * ones with smpte_fecdec_recovered(), typically into an RTP reordering
+ * buffer. Packets older than the window cannot be recovered, which bounds
+ * the latency.
+ *
+ * The structure is large (a few MB), allocate it on the heap.
+ */
+
+#ifndef __BITSTREAM_SMPTE_2022_1_FEC_DEC_H__
+#define __BITSTREAM_SMPTE_2022_1_FEC_DEC_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy, memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/smpte/2022_1_fec.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SMPTE_FECDEC_WINDOW         1024 /* >= 2 * L * D, power of two */
+#define SMPTE_FECDEC_FEC_WINDOW     128  /* >= 2 * (L + D), power of two */
+
+typedef struct smpte_fecdec_packet_t {
+    uint64_t i_seqnum; /* extended */
+    uint16_t i_size;
+    uint8_t p_buffer[SMPTE_FEC_MAX_SIZE];
+} smpte_fecdec_packet_t;
+
+typedef struct smpte_fecdec_t {
+    bool b_started;
+    uint64_t i_highest;
+    uint32_t i_ssrc;
+
+    smpte_fecdec_packet_t p_media[SMPTE_FECDEC_WINDOW];
+    /* FEC packets, indexed by the extended sequence number of the FEC
+     * stream; column and row streams are kept apart */
+    smpte_fecdec_packet_t p_fec[2][SMPTE_FECDEC_FEC_WINDOW];
+    uint64_t pi_fec_highest[2];
+    bool pb_fec_started[2];
+    /* FEC packets whose group misses several packets, same indexing */
+    bool pb_fec_pending[2][SMPTE_FECDEC_FEC_WINDOW];
+    unsigned int i_fec_pending;
+
+    /* recovered packets not yet fetched */
+    uint64_t p_recovered[SMPTE_FECDEC_WINDOW];
+    unsigned int i_recovered_start, i_recovered_count;
+
+    /* statistics */
+    uint64_t i_media_received;
+    uint64_t i_fec_received;
+    uint64_t i_fec_invalid;
+    uint64_t i_nb_recovered;
+} smpte_fecdec_t;
+
+static inline void smpte_fecdec_init(smpte_fecdec_t *p_dec)
+{
+    int i, j;
+
+    p_dec->b_started = false;
+    p_dec->i_highest = 0;
+    p_dec->i_ssrc = 0;
+    for (i = 0; i < SMPTE_FECDEC_WINDOW; i++)
+        p_dec->p_media[i].i_seqnum = UINT64_MAX;
+    for (i = 0; i < 2; i++) {
+        p_dec->pi_fec_highest[i] = 0;
+        p_dec->pb_fec_started[i] = false;
+        for (j = 0; j < SMPTE_FECDEC_FEC_WINDOW; j++) {
+            p_dec->p_fec[i][j].i_seqnum = UINT64_MAX;
+            p_dec->pb_fec_pending[i][j] = false;
+        }
+    }
+    p_dec->i_fec_pending = 0;
+    p_dec->i_recovered_start = p_dec->i_recovered_count = 0;
+    p_dec->i_media_received = p_dec->i_fec_received = 0;
+    p_dec->i_fec_invalid = p_dec->i_nb_recovered = 0;
+}
+
+static inline smpte_fecdec_packet_t *smpte_fecdec_get_media(
+        smpte_fecdec_t *p_dec, uint64_t i_seqnum)
+{
+    smpte_fecdec_packet_t *p_packet =
+        &p_dec->p_media[i_seqnum & (SMPTE_FECDEC_WINDOW - 1)];
+    return p_packet->i_seqnum == i_seqnum ? p_packet : NULL;
+}
+
+static inline bool smpte_fecdec_in_window(const smpte_fecdec_t *p_dec,
+                                          uint64_t i_seqnum)
+{
+    return i_seqnum + SMPTE_FECDEC_WINDOW > p_dec->i_highest &&
+           i_seqnum <= p_dec->i_highest + SMPTE_FECDEC_WINDOW / 2;
+}
+
+static inline void smpte_fecdec_store_media(smpte_fecdec_t *p_dec,
+                                            uint64_t i_seqnum,
+                                            const uint8_t *p_rtp,
+                                            uint16_t i_size)
+{
+    smpte_fecdec_packet_t *p_packet =
+        &p_dec->p_media[i_seqnum & (SMPTE_FECDEC_WINDOW - 1)];
+    p_packet->i_seqnum = i_seqnum;
+    p_packet->i_size = i_size;
+    if (p_rtp != NULL)
+        memcpy(p_packet->p_buffer, p_rtp, i_size);
+    if (i_seqnum > p_dec->i_highest)
+        p_dec->i_highest = i_seqnum;
+}
+
+static inline void smpte_fecdec_set_pending(smpte_fecdec_t *p_dec,
+                                            smpte_fecdec_packet_t *p_fec,
+                                            bool b_pending)
+{
+    unsigned int i_index = p_fec - p_dec->p_fec[0];
+    bool *pb_pending = &p_dec->pb_fec_pending[i_index /
+                                              SMPTE_FECDEC_FEC_WINDOW]
+                                             [i_index %
+                                              SMPTE_FECDEC_FEC_WINDOW];
+
+    if (*pb_pending == b_pending)
+        return;
+    *pb_pending = b_pending;
+    if (b_pending)
+        p_dec->i_fec_pending++;
+    else
+        p_dec->i_fec_pending--;
+}
+
+/*****************************************************************************
+ * smpte_fecdec_recover
+ *****************************************************************************
+ * Tries to rebuild the media packet missing from the group protected by a
+ * FEC packet. Returns true if a packet was recovered. The FEC packet is
+ * flagged pending if several packets of its group are still missing.
+ *****************************************************************************/
+static inline bool smpte_fecdec_recover(smpte_fecdec_t *p_dec,
+                                        smpte_fecdec_packet_t *p_fec)
+{
+    uint8_t *p_fec_hdr = rtp_payload(p_fec->p_buffer);
+    uint8_t *p_fec_payload = p_fec_hdr + SMPTE_2022_FEC_HEADER_SIZE;
+    size_t i_fec_payload_size = p_fec->i_size - (p_fec_payload - p_fec->p_buffer);
+    uint64_t i_snbase = rtp_seqnum_extend(p_dec->i_highest,
+                                          smpte_fec_get_snbase_low(p_fec_hdr));
+    uint8_t i_offset = smpte_fec_get_offset(p_fec_hdr);
+    uint8_t i_na = smpte_fec_get_na(p_fec_hdr);
+    uint64_t i_missing = UINT64_MAX;
+    uint16_t i_length = smpte_fec_get_length_rec(p_fec_hdr);
+    uint8_t i_pt = smpte_fec_get_pt_recovery(p_fec_hdr);
+    uint32_t i_timestamp = smpte_fec_get_ts_recovery(p_fec_hdr);
+    smpte_fecdec_packet_t *p_out;
+    uint8_t *p_payload;
+    unsigned int i;
+
+    smpte_fecdec_set_pending(p_dec, p_fec, false);
+    for (i = 0; i < i_na; i++) {
+        uint64_t i_seqnum = i_snbase + i * i_offset;
+        if (smpte_fecdec_get_media(p_dec, i_seqnum) != NULL)
+            continue;
+        if (!smpte_fecdec_in_window(p_dec, i_seqnum))
+            return false;
+        if (i_missing != UINT64_MAX) {
+            smpte_fecdec_set_pending(p_dec, p_fec, true);
+            return false;
+        }
+        i_missing = i_seqnum;
+    }
+    if (i_missing == UINT64_MAX)
+        return false;
+
+    /* rebuild the payload in place in the media window */
+    p_out = &p_dec->p_media[i_missing & (SMPTE_FECDEC_WINDOW - 1)];
+    p_payload = p_out->p_buffer + RTP_HEADER_SIZE;
+    memcpy(p_payload, p_fec_payload, i_fec_payload_size);
+
+    for (i = 0; i < i_na; i++) {
+        smpte_fecdec_packet_t *p_media;
+        uint8_t *p_media_payload;
+        size_t i_media_size;
+
+        if (i_snbase + i * i_offset == i_missing)
+            continue;
+        p_media = smpte_fecdec_get_media(p_dec, i_snbase + i * i_offset);
+        p_media_payload = rtp_payload(p_media->p_buffer);
+        i_media_size = rtp_payload_size(p_media->p_buffer, p_media->i_size);
+        if (i_media_size > i_fec_payload_size)
+            i_media_size = i_fec_payload_size;
+        smpte_fec_xor(p_payload, p_media_payload, i_media_size);
+        i_length ^= i_media_size;
+        i_pt ^= rtp_get_type(p_media->p_buffer);
+        i_timestamp ^= rtp_get_timestamp(p_media->p_buffer);
+    }
+
+    if (i_length > i_fec_payload_size) {
+        /* inconsistent FEC */
+        p_dec->i_fec_invalid++;
+        return false;
+    }
+
+    rtp_set_hdr(p_out->p_buffer);
+    p_out->p_buffer[1] = 0;
+    rtp_set_type(p_out->p_buffer, i_pt);
+    rtp_set_seqnum(p_out->p_buffer, i_missing & 0xffff);
+    rtp_set_timestamp(p_out->p_buffer, i_timestamp);
+    rtp_set_int_ssrc(p_out->p_buffer, p_dec->i_ssrc);
+    smpte_fecdec_store_media(p_dec, i_missing, NULL,
+                             RTP_HEADER_SIZE + i_length);
+
+    if (p_dec->i_recovered_count < SMPTE_FECDEC_WINDOW) {
+        p_dec->p_recovered[(p_dec->i_recovered_start +
+                            p_dec->i_recovered_count++) %
+                           SMPTE_FECDEC_WINDOW] = i_missing;
+    }
+    p_dec->i_nb_recovered++;
+    return true;
+}
+
+/* retries the pending FEC packets of both dimensions after a media packet
+ * was received or recovered */
+static inline void smpte_fecdec_retry(smpte_fecdec_t *p_dec)
+{
+    bool b_progress;
+
+    do {
+        unsigned int i, j;
+        b_progress = false;
+        for (i = 0; i < 2 && p_dec->i_fec_pending; i++)
+            for (j = 0; j < SMPTE_FECDEC_FEC_WINDOW; j++)
+                if (p_dec->pb_fec_pending[i][j] &&
+                    smpte_fecdec_recover(p_dec, &p_dec->p_fec[i][j]))
+                    b_progress = true;
+    } while (b_progress);
+}
+
+/*****************************************************************************
+ * smpte_fecdec_media: feeds a media RTP packet
+ *****************************************************************************/
+static inline void smpte_fecdec_media(smpte_fecdec_t *p_dec,
+                                      const uint8_t *p_rtp, size_t i_size)
+{
+    uint64_t i_seqnum;
+
+    if (i_size < RTP_HEADER_SIZE || i_size > SMPTE_FEC_MAX_SIZE ||
+        !rtp_check_hdr(p_rtp) || !rtp_check_size(p_rtp, i_size))
+        return;
+
+    if (!p_dec->b_started) {
+        p_dec->i_highest = rtp_seqnum_extend(0, rtp_get_seqnum(p_rtp));
+        p_dec->b_started = true;
+    }
+    i_seqnum = rtp_seqnum_extend(p_dec->i_highest, rtp_get_seqnum(p_rtp));
+    if (!smpte_fecdec_in_window(p_dec, i_seqnum))
+        return;
+
+    p_dec->i_media_received++;
+    p_dec->i_ssrc = rtp_get_int_ssrc(p_rtp);
+    smpte_fecdec_store_media(p_dec, i_seqnum, p_rtp, i_size);
+
+    /* a FEC packet received earlier may now miss only one packet */
+    if (p_dec->i_fec_pending)
+        smpte_fecdec_retry(p_dec);
+}
+
+/*****************************************************************************
+ * smpte_fecdec_fec: feeds a column (or row) FEC RTP packet
+ *****************************************************************************/
+static inline void smpte_fecdec_fec(smpte_fecdec_t *p_dec,
+                                    const uint8_t *p_rtp, size_t i_size)
+{
+    smpte_fecdec_packet_t *p_fec;
+    const uint8_t *p_fec_hdr;
+    uint64_t i_seqnum;
+    bool b_row;
+    uint8_t i_offset, i_na;
+
+    if (i_size < RTP_HEADER_SIZE || i_size > SMPTE_FEC_MAX_SIZE ||
+        !rtp_check_hdr(p_rtp) || !rtp_check_size(p_rtp, i_size) ||
+        !p_dec->b_started)
+        return;
+    p_fec_hdr = rtp_payload((uint8_t *)p_rtp);
+    if (p_fec_hdr + SMPTE_2022_FEC_HEADER_SIZE > p_rtp + i_size)
+        return;
+
+    p_dec->i_fec_received++;
+    b_row = smpte_fec_check_d(p_fec_hdr);
+    i_offset = smpte_fec_get_offset(p_fec_hdr);
+    i_na = smpte_fec_get_na(p_fec_hdr);
+    if (!i_na || !i_offset ||
+        (b_row && (i_offset != 1 || i_na > SMPTE_FEC_MAX_L)) ||
+        (!b_row && (i_offset > SMPTE_FEC_MAX_L || i_na > SMPTE_FEC_MAX_D)) ||
+        smpte_fec_get_type(p_fec_hdr) != 0) {
+        p_dec->i_fec_invalid++;
+        return;
+    }
+
+    if (!p_dec->pb_fec_started[b_row]) {
+        p_dec->pi_fec_highest[b_row] = rtp_seqnum_extend(0,
+                                           rtp_get_seqnum(p_rtp));
+        p_dec->pb_fec_started[b_row] = true;
+    }
+    i_seqnum = rtp_seqnum_extend(p_dec->pi_fec_highest[b_row],
+                                 rtp_get_seqnum(p_rtp));
+    if (i_seqnum + SMPTE_FECDEC_FEC_WINDOW <= p_dec->pi_fec_highest[b_row])
+        return;
+    if (i_seqnum > p_dec->pi_fec_highest[b_row])
+        p_dec->pi_fec_highest[b_row] = i_seqnum;
+
+    p_fec = &p_dec->p_fec[b_row][i_seqnum & (SMPTE_FECDEC_FEC_WINDOW - 1)];
+    p_fec->i_seqnum = i_seqnum;
+    p_fec->i_size = i_size;
+    memcpy(p_fec->p_buffer, p_rtp, i_size);
+
+    if (smpte_fecdec_recover(p_dec, p_fec))
+        smpte_fecdec_retry(p_dec);
+}
+
+/*****************************************************************************
+ * smpte_fecdec_recovered
+ *****************************************************************************
+ * Returns the next recovered media packet, or NULL. The packet remains valid
+ * until the next call to smpte_fecdec_media() or smpte_fecdec_fec().
+ *****************************************************************************/
+static inline const uint8_t *smpte_fecdec_recovered(smpte_fecdec_t *p_dec,
+                                                    size_t *pi_size)
+{
+    while (p_dec->i_recovered_count) {
+        uint64_t i_seqnum = p_dec->p_recovered[p_dec->i_recovered_start];
+        smpte_fecdec_packet_t *p_packet;
+
+        p_dec->i_recovered_start = (p_dec->i_recovered_start + 1) %
+                                   SMPTE_FECDEC_WINDOW;
+        p_dec->i_recovered_count--;
+        p_packet = smpte_fecdec_get_media(p_dec, i_seqnum);
+        if (p_packet != NULL) {
+            *pi_size = p_packet->i_size;
+            return p_packet->p_buffer;
+        }
+    }
+    return NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,285 @@
+/*****************************************************************************
+ * 2022_1_fec_enc.h: SMPTE 2022-1 FEC sender
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - SMPTE 2022-1
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The sender accumulates the media payloads of the current L x D matrix
+ * into one column FEC packet per column (and one row FEC packet), so that
+ * each media packet is XORed exactly once, when it is input. Column
+ * accumulators are double-buffered: while the columns of a matrix are
+ * being accumulated, those of the previous matrix are being sent. When
+ * staggering is enabled, the L column FEC packets of a matrix are spread
+ * over the next matrix, one every D media packets, instead of being sent
+ * in a burst during its last row.
+ *
+ * Typical use:
+ *
+ *   smpte_fecenc_input(&enc, p_rtp, i_size);
+ *   output(p_rtp, i_size);
+ *   while ((p = smpte_fecenc_column(&enc, &i_fsize)) != NULL)
+ *       output_column(p, i_fsize);
+ *   while ((p = smpte_fecenc_row(&enc, &i_fsize)) != NULL)
+ *       output_row(p, i_fsize);
+ */
+
+#ifndef __BITSTREAM_SMPTE_2022_1_FEC_ENC_H__
+#define __BITSTREAM_SMPTE_2022_1_FEC_ENC_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy, memset */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/smpte/2022_1_fec.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SMPTE_FECENC_PAYLOAD_MAX    (SMPTE_FEC_MAX_SIZE - RTP_HEADER_SIZE - \
+                                     SMPTE_2022_FEC_HEADER_SIZE)
+
+typedef struct smpte_fecenc_packet_t {
+    uint16_t i_snbase;
+    uint16_t i_length;
+    uint8_t i_pt;
+    uint32_t i_timestamp;
+    /* largest payload accumulated so far */
+    uint16_t i_payload_size;
+    /* number of media packets before which it must be sent */
+    uint64_t i_release;
+    uint8_t p_buffer[SMPTE_FEC_MAX_SIZE];
+} smpte_fecenc_packet_t;
+
+typedef struct smpte_fecenc_t {
+    uint8_t i_l, i_d;
+    bool b_row;
+    bool b_stagger;
+    uint32_t i_ssrc;
+
+    /* position of the next media packet in the matrix */
+    unsigned int i_index;
+    unsigned int i_matrix;
+    uint64_t i_packets;
+
+    uint16_t i_column_seqnum, i_row_seqnum;
+
+    smpte_fecenc_packet_t p_columns[2][SMPTE_FEC_MAX_L];
+    smpte_fecenc_packet_t p_rows[2];
+
+    /* column FEC packets waiting to be sent */
+    smpte_fecenc_packet_t *pp_pending[2 * SMPTE_FEC_MAX_L];
+    unsigned int i_pending_start, i_pending_count;
+    smpte_fecenc_packet_t *p_row_pending;
+} smpte_fecenc_t;
+
+/*****************************************************************************
+ * smpte_fecenc_init
+ *****************************************************************************
+ * Row FEC packets are only generated if b_row is true. Returns false if the
+ * matrix dimensions are not supported.
+ *****************************************************************************/
+static inline bool smpte_fecenc_init(smpte_fecenc_t *p_enc, uint8_t i_l,
+                                     uint8_t i_d, bool b_row, bool b_stagger)
+{
+    if (i_l < 1 || i_l > SMPTE_FEC_MAX_L || i_d < 1 || i_d > SMPTE_FEC_MAX_D ||
+        (i_l == 1 && b_row))
+        return false;
+
+    p_enc->i_l = i_l;
+    p_enc->i_d = i_d;
+    p_enc->b_row = b_row;
+    p_enc->b_stagger = b_stagger;
+    p_enc->i_ssrc = 0;
+    p_enc->i_index = p_enc->i_matrix = 0;
+    p_enc->i_packets = 0;
+    p_enc->i_column_seqnum = p_enc->i_row_seqnum = 0;
+    p_enc->i_pending_start = p_enc->i_pending_count = 0;
+    p_enc->p_row_pending = NULL;
+    return true;
+}
+
+/* adds a media packet to a FEC packet */
+static inline void smpte_fecenc_add(smpte_fecenc_packet_t *p_fec,
+                                    uint8_t *p_rtp, size_t i_size, bool b_first)
+{
+    uint8_t *p_payload = rtp_payload(p_rtp);
+    uint8_t *p_fec_payload = p_fec->p_buffer + RTP_HEADER_SIZE +
+                             SMPTE_2022_FEC_HEADER_SIZE;
+    size_t i_payload_size = rtp_payload_size(p_rtp, i_size);
+
+    if (i_payload_size > SMPTE_FECENC_PAYLOAD_MAX)
+        i_payload_size = SMPTE_FECENC_PAYLOAD_MAX;
+
+    if (b_first) {
+        p_fec->i_snbase = rtp_get_seqnum(p_rtp);
+        p_fec->i_length = i_payload_size;
+        p_fec->i_pt = rtp_get_type(p_rtp);
+        p_fec->i_timestamp = rtp_get_timestamp(p_rtp);
+        p_fec->i_payload_size = i_payload_size;
+        memcpy(p_fec_payload, p_payload, i_payload_size);
+        return;
+    }
+
+    p_fec->i_length ^= i_payload_size;
+    p_fec->i_pt ^= rtp_get_type(p_rtp);
+    p_fec->i_timestamp ^= rtp_get_timestamp(p_rtp);
+    if (i_payload_size > p_fec->i_payload_size) {
+        memset(p_fec_payload + p_fec->i_payload_size, 0,
+               i_payload_size - p_fec->i_payload_size);
+        p_fec->i_payload_size = i_payload_size;
+    }
+    smpte_fec_xor(p_fec_payload, p_payload, i_payload_size);
+}
+
+/* writes the RTP and FEC headers of a complete FEC packet */
+static inline void smpte_fecenc_finish(smpte_fecenc_t *p_enc,
+                                       smpte_fecenc_packet_t *p_fec,
+                                       bool b_row, uint32_t i_timestamp)
+{
+    uint8_t *p_rtp = p_fec->p_buffer;
+    uint8_t *p_fec_hdr = p_rtp + RTP_HEADER_SIZE;
+
+    memset(p_rtp, 0, RTP_HEADER_SIZE + SMPTE_2022_FEC_HEADER_SIZE);
+    rtp_set_hdr(p_rtp);
+    rtp_set_type(p_rtp, SMPTE_FEC_RTP_TYPE);
+    rtp_set_seqnum(p_rtp, b_row ? p_enc->i_row_seqnum++ :
+                                  p_enc->i_column_seqnum++);
+    rtp_set_timestamp(p_rtp, i_timestamp);
+    rtp_set_int_ssrc(p_rtp, p_enc->i_ssrc);
+
+    smpte_fec_set_snbase_low(p_fec_hdr, p_fec->i_snbase);
+    smpte_fec_set_length_rec(p_fec_hdr, p_fec->i_length);
+    smpte_fec_set_extension(p_fec_hdr);
+    smpte_fec_set_pt_recovery(p_fec_hdr, p_fec->i_pt);
+    smpte_fec_set_ts_recovery(p_fec_hdr, p_fec->i_timestamp);
+    if (b_row) {
+        smpte_fec_set_d(p_fec_hdr);
+        smpte_fec_set_offset(p_fec_hdr, 1);
+        smpte_fec_set_na(p_fec_hdr, p_enc->i_l);
+    } else {
+        smpte_fec_set_offset(p_fec_hdr, p_enc->i_l);
+        smpte_fec_set_na(p_fec_hdr, p_enc->i_d);
+    }
+}
+
+/*****************************************************************************
+ * smpte_fecenc_input: feeds an outgoing media RTP packet
+ *****************************************************************************/
+static inline void smpte_fecenc_input(smpte_fecenc_t *p_enc, uint8_t *p_rtp,
+                                      size_t i_size)
+{
+    unsigned int i_column = p_enc->i_index % p_enc->i_l;
+    unsigned int i_line = p_enc->i_index / p_enc->i_l;
+    smpte_fecenc_packet_t *p_column =
+        &p_enc->p_columns[p_enc->i_matrix & 1][i_column];
+    uint32_t i_timestamp = rtp_get_timestamp(p_rtp);
+
+    if (!p_enc->i_packets)
+        p_enc->i_ssrc = rtp_get_int_ssrc(p_rtp);
+    p_enc->i_packets++;
+
+    smpte_fecenc_add(p_column, p_rtp, i_size, !i_line);
+    if (i_line == p_enc->i_d - 1u) {
+        p_column->i_release = p_enc->i_packets;
+        if (p_enc->b_stagger)
+            /* after the (i_column * D)th packet of the next matrix */
+            p_column->i_release += p_enc->i_l + i_column * (p_enc->i_d - 1u);
+        smpte_fecenc_finish(p_enc, p_column, false, i_timestamp);
+        if (p_enc->i_pending_count < 2 * SMPTE_FEC_MAX_L)
+            p_enc->pp_pending[(p_enc->i_pending_start +
+                               p_enc->i_pending_count++) %
+                              (2 * SMPTE_FEC_MAX_L)] = p_column;
+    }
+
+    if (p_enc->b_row) {
+        smpte_fecenc_packet_t *p_row = &p_enc->p_rows[i_line & 1];
+        smpte_fecenc_add(p_row, p_rtp, i_size, !i_column);
+        if (i_column == p_enc->i_l - 1u) {
+            smpte_fecenc_finish(p_enc, p_row, true, i_timestamp);
+            p_enc->p_row_pending = p_row;
+        }
+    }
+
+    if (++p_enc->i_index == (unsigned int)p_enc->i_l * p_enc->i_d) {
+        p_enc->i_index = 0;
+        p_enc->i_matrix++;
+    }
+}
+
+/*****************************************************************************
+ * smpte_fecenc_column
+ *****************************************************************************
+ * Returns the next column FEC packet due to be sent, or NULL. The packet
+ * remains valid until the next call to smpte_fecenc_input().
+ *****************************************************************************/
+static inline const uint8_t *smpte_fecenc_column(smpte_fecenc_t *p_enc,
+                                                 size_t *pi_size)
+{
+    smpte_fecenc_packet_t *p_column;
+
+    if (!p_enc->i_pending_count)
+        return NULL;
+    p_column = p_enc->pp_pending[p_enc->i_pending_start];
+    if (p_column->i_release > p_enc->i_packets)
+        return NULL;
+
+    p_enc->i_pending_start = (p_enc->i_pending_start + 1) %
+                             (2 * SMPTE_FEC_MAX_L);
+    p_enc->i_pending_count--;
+    *pi_size = RTP_HEADER_SIZE + SMPTE_2022_FEC_HEADER_SIZE +
+               p_column->i_payload_size;
+    return p_column->p_buffer;
+}
+
+/*****************************************************************************
+ * smpte_fecenc_row
+ *****************************************************************************
+ * Returns the row FEC packet due to be sent, or NULL. The packet remains
+ * valid until the next call to smpte_fecenc_input().
+ *****************************************************************************/
+static inline const uint8_t *smpte_fecenc_row(smpte_fecenc_t *p_enc,
+                                              size_t *pi_size)
+{
+    smpte_fecenc_packet_t *p_row = p_enc->p_row_pending;
+
+    if (p_row == NULL)
+        return NULL;
+    p_enc->p_row_pending = NULL;
+    *pi_size = RTP_HEADER_SIZE + SMPTE_2022_FEC_HEADER_SIZE +
+               p_row->i_payload_size;
+    return p_row->p_buffer;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,275 @@
+/*****************************************************************************
+ * 2022_6_hbrmt_dec.h: SMPTE 2022-6 depacketizer
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - SMPTE 2022-6
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The depacketizer copies the HBRMT_DATA_SIZE bytes of each packet straight
+ * to their place in a caller-allocated frame buffer (which may be backed by
+ * huge pages), at an offset given by the distance between the RTP sequence
+ * number of the packet and that of the first packet of the frame. Frames
+ * are delimited by the RTP marker bit, which is set on the last packet of a
+ * frame; once the number of packets per frame is known, a lost marker is
+ * detected when a packet falls beyond the end of the current frame.
+ *
+ * Completed frames, including those with missing packets, are handed to
+ * the consumer through a ring of frame buffers, which may be read from
+ * another thread than the one feeding the packets. If the consumer does not
+ * release frames fast enough, incoming frames are dropped.
+ *
+ * Typical use:
+ *
+ *   smpte_hbrmtdec_input(&dec, p_rtp, i_size);
+ *   while ((p_frame = smpte_hbrmtdec_get_frame(&dec)) != NULL) {
+ *       output(p_frame->p_buffer, p_frame->i_size);
+ *       smpte_hbrmtdec_release_frame(&dec);
+ *   }
+ */
+
+#ifndef __BITSTREAM_SMPTE_2022_6_HBRMT_DEC_H__
+#define __BITSTREAM_SMPTE_2022_6_HBRMT_DEC_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy */
+#include <bitstream/ietf/rtp.h>
+#include <bitstream/smpte/2022_6_hbrmt.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if !defined(__GNUC__)
+#   error "smpte/2022_6_hbrmt_dec.h requires GCC-compatible atomic builtins"
+#endif
+
+typedef struct smpte_hbrmtdec_frame_t {
+    /* set by the caller */
+    uint8_t *p_buffer;
+
+    /* set by the depacketizer */
+    size_t i_size;
+    unsigned int i_nb_packets;
+    unsigned int i_nb_missing;
+    uint8_t i_frame_count;
+    uint32_t i_timestamp;
+    /* HBRMT header of the first packet received (MAP, FRAME, FRATE...) */
+    uint8_t p_hbrmt[HBRMT_HEADER_SIZE];
+} smpte_hbrmtdec_frame_t;
+
+typedef struct smpte_hbrmtdec_t {
+    smpte_hbrmtdec_frame_t *p_frames;
+    unsigned int i_nb_frames;
+    size_t i_frame_size;
+
+    /* ring indexes, written by the producer and the consumer respectively */
+    unsigned int i_write;
+    unsigned int i_read;
+
+    bool b_started;
+    bool b_synced;
+    uint64_t i_highest;
+    uint64_t i_first;
+    unsigned int i_packets_per_frame;
+    unsigned int i_received;
+    bool b_overrun;
+
+    /* statistics */
+    uint64_t i_frames;
+    uint64_t i_incomplete;
+    uint64_t i_dropped;
+    uint64_t i_late;
+    uint64_t i_invalid;
+} smpte_hbrmtdec_t;
+
+/*****************************************************************************
+ * smpte_hbrmtdec_init
+ *****************************************************************************
+ * p_frames[].p_buffer must point to i_nb_frames buffers of i_frame_size
+ * bytes, large enough for a whole frame rounded up to HBRMT_DATA_SIZE.
+ * i_nb_frames must be a power of two.
+ *****************************************************************************/
+static inline void smpte_hbrmtdec_init(smpte_hbrmtdec_t *p_dec,
+                                       smpte_hbrmtdec_frame_t *p_frames,
+                                       unsigned int i_nb_frames,
+                                       size_t i_frame_size)
+{
+    memset(p_dec, 0, sizeof(smpte_hbrmtdec_t));
+    p_dec->p_frames = p_frames;
+    p_dec->i_nb_frames = i_nb_frames;
+    p_dec->i_frame_size = i_frame_size - i_frame_size % HBRMT_DATA_SIZE;
+}
+
+/* returns the HBRMT data of a packet, or NULL if it is invalid */
+static inline uint8_t *smpte_hbrmtdec_data(uint8_t *p_rtp, size_t i_size)
+{
+    uint8_t *p_hbrmt, *p_data, *p_end;
+
+    if (!rtp_check_size(p_rtp, i_size) || !rtp_check_hdr(p_rtp))
+        return NULL;
+    p_hbrmt = rtp_payload(p_rtp);
+    p_end = p_hbrmt + rtp_payload_size(p_rtp, i_size);
+    if (p_hbrmt + HBRMT_HEADER_SIZE > p_end)
+        return NULL;
+    p_data = p_hbrmt + HBRMT_HEADER_SIZE +
+             4 * smpte_hbrmt_get_ext(p_hbrmt);
+    if (smpte_hbrmt_get_clock_frequency(p_hbrmt))
+        p_data += 4;
+    if (p_data + HBRMT_DATA_SIZE > p_end)
+        return NULL;
+    return p_data;
+}
+
+/* hands the current frame to the consumer and starts the next one */
+static inline void smpte_hbrmtdec_next(smpte_hbrmtdec_t *p_dec,
+                                       uint64_t i_first)
+{
+    unsigned int i_read = __atomic_load_n(&p_dec->i_read, __ATOMIC_ACQUIRE);
+
+    if (!p_dec->b_overrun) {
+        smpte_hbrmtdec_frame_t *p_frame =
+            &p_dec->p_frames[p_dec->i_write % p_dec->i_nb_frames];
+        unsigned int i_nb_packets = i_first - p_dec->i_first;
+
+        p_frame->i_nb_packets = i_nb_packets;
+        p_frame->i_nb_missing = i_nb_packets > p_dec->i_received ?
+                                i_nb_packets - p_dec->i_received : 0;
+        p_frame->i_size = (size_t)i_nb_packets * HBRMT_DATA_SIZE;
+        p_dec->i_frames++;
+        if (p_frame->i_nb_missing)
+            p_dec->i_incomplete++;
+        __atomic_store_n(&p_dec->i_write, p_dec->i_write + 1,
+                         __ATOMIC_RELEASE);
+    } else
+        p_dec->i_dropped++;
+
+    p_dec->b_overrun = p_dec->i_write - i_read >= p_dec->i_nb_frames;
+    p_dec->i_first = i_first;
+    p_dec->i_received = 0;
+}
+
+/*****************************************************************************
+ * smpte_hbrmtdec_input: feeds a 2022-6 RTP packet
+ *****************************************************************************/
+static inline void smpte_hbrmtdec_input(smpte_hbrmtdec_t *p_dec,
+                                        uint8_t *p_rtp, size_t i_size)
+{
+    uint8_t *p_data = smpte_hbrmtdec_data(p_rtp, i_size);
+    smpte_hbrmtdec_frame_t *p_frame;
+    uint64_t i_seqnum, i_offset;
+
+    if (p_data == NULL) {
+        p_dec->i_invalid++;
+        return;
+    }
+
+    if (!p_dec->b_started) {
+        p_dec->i_highest = rtp_seqnum_extend(0, rtp_get_seqnum(p_rtp));
+        p_dec->b_started = true;
+    }
+    i_seqnum = rtp_seqnum_extend(p_dec->i_highest, rtp_get_seqnum(p_rtp));
+    if (i_seqnum > p_dec->i_highest)
+        p_dec->i_highest = i_seqnum;
+
+    if (!p_dec->b_synced) {
+        /* wait for the end of a frame */
+        if (rtp_check_marker(p_rtp)) {
+            p_dec->b_synced = true;
+            p_dec->i_first = i_seqnum + 1;
+            p_dec->b_overrun = p_dec->i_write -
+                __atomic_load_n(&p_dec->i_read, __ATOMIC_ACQUIRE) >=
+                p_dec->i_nb_frames;
+        }
+        return;
+    }
+
+    if (i_seqnum < p_dec->i_first) {
+        p_dec->i_late++;
+        return;
+    }
+
+    /* lost marker(s) */
+    while (p_dec->i_packets_per_frame &&
+           i_seqnum >= p_dec->i_first + p_dec->i_packets_per_frame)
+        smpte_hbrmtdec_next(p_dec, p_dec->i_first +
+                                   p_dec->i_packets_per_frame);
+
+    i_offset = (i_seqnum - p_dec->i_first) * HBRMT_DATA_SIZE;
+    if (i_offset + HBRMT_DATA_SIZE > p_dec->i_frame_size) {
+        /* frame larger than the buffers, or lost marker before the number
+         * of packets per frame is known */
+        p_dec->i_invalid++;
+        p_dec->b_synced = false;
+        return;
+    }
+
+    if (!p_dec->b_overrun) {
+        p_frame = &p_dec->p_frames[p_dec->i_write % p_dec->i_nb_frames];
+        if (!p_dec->i_received) {
+            memcpy(p_frame->p_hbrmt, rtp_payload(p_rtp), HBRMT_HEADER_SIZE);
+            p_frame->i_frame_count = smpte_hbrmt_get_frame_count(p_frame->p_hbrmt);
+            p_frame->i_timestamp = rtp_get_timestamp(p_rtp);
+        }
+        memcpy(p_frame->p_buffer + i_offset, p_data, HBRMT_DATA_SIZE);
+    }
+    p_dec->i_received++;
+
+    if (rtp_check_marker(p_rtp)) {
+        p_dec->i_packets_per_frame = i_seqnum + 1 - p_dec->i_first;
+        smpte_hbrmtdec_next(p_dec, i_seqnum + 1);
+    }
+}
+
+/*****************************************************************************
+ * smpte_hbrmtdec_get_frame
+ *****************************************************************************
+ * Returns the oldest completed frame, or NULL. The frame must be released
+ * with smpte_hbrmtdec_release_frame() once consumed.
+ *****************************************************************************/
+static inline smpte_hbrmtdec_frame_t *
+    smpte_hbrmtdec_get_frame(smpte_hbrmtdec_t *p_dec)
+{
+    unsigned int i_write = __atomic_load_n(&p_dec->i_write, __ATOMIC_ACQUIRE);
+
+    if (i_write == p_dec->i_read)
+        return NULL;
+    return &p_dec->p_frames[p_dec->i_read % p_dec->i_nb_frames];
+}
+
+static inline void smpte_hbrmtdec_release_frame(smpte_hbrmtdec_t *p_dec)
+{
+    __atomic_store_n(&p_dec->i_read, p_dec->i_read + 1, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
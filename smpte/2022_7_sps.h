@@ -0,0 +1,230 @@
+/*****************************************************************************
+ * 2022_7_sps.h: SMPTE 2022-7 seamless protection switching
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - SMPTE 2022-7 Seamless Protection Switching of RTP Datagrams
+ *  - IETF RFC 3550 Real-Time Protocol (July 2003)
+ */
+
+/*
+ * The merger receives the same RTP stream on several legs (network paths),
+ * and lets through each sequence number only once, from whichever leg
+ * delivers it first. It is a ring of caller-allocated slots indexed by the
+ * extended sequence number; a slot holds the last sequence number let
+ * through, and is claimed with a compare-and-swap, so that each leg may be
+ * fed from its own thread without locking. Per-leg counters are only
+ * written by the thread feeding the leg.
+ *
+ * Packets older than i_window sequence numbers behind the most recent one
+ * received on any leg are dropped, which bounds the skew between legs that
+ * can be compensated; i_window must be smaller than the number of slots.
+ * Packets are let through as they arrive: use an RTP reordering buffer
+ * downstream if the legs are not in order.
+ *
+ * Typical use, in the thread receiving leg i:
+ *
+ *   if (smpte_sps_input(&p_legs[i], p_rtp, i_date) == SMPTE_SPS_FIRST)
+ *       output(p_rtp, i_size);
+ */
+
+#ifndef __BITSTREAM_SMPTE_2022_7_SPS_H__
+#define __BITSTREAM_SMPTE_2022_7_SPS_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <string.h>   /* memset */
+#include <bitstream/ietf/rtp.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if !defined(__GNUC__)
+#   error "smpte/2022_7_sps.h requires GCC-compatible atomic builtins"
+#endif
+
+#define SMPTE_SPS_FIRST         0
+#define SMPTE_SPS_DUPLICATE     1
+#define SMPTE_SPS_LATE          2
+
+typedef struct smpte_sps_t {
+    /* extended sequence number and reception date of the first copy */
+    uint64_t *pi_seqnums;
+    uint64_t *pi_dates;
+    uint64_t i_mask;
+    uint64_t i_window;
+
+    /* highest extended sequence number received on any leg (shared) */
+    uint64_t i_highest;
+} smpte_sps_t;
+
+typedef struct smpte_sps_leg_t {
+    smpte_sps_t *p_sps;
+    bool b_started;
+    uint64_t i_highest;
+
+    /* statistics */
+    uint64_t i_received;
+    uint64_t i_first;
+    uint64_t i_duplicate;
+    uint64_t i_late;
+    uint64_t i_base;
+    /* delay behind the leg which delivered first, for duplicate packets */
+    uint64_t i_delay_sum;
+    uint64_t i_delay_max;
+    uint64_t i_delay_count;
+} smpte_sps_leg_t;
+
+/*****************************************************************************
+ * smpte_sps_init
+ *****************************************************************************
+ * i_nb_slots must be a power of two, larger than i_window.
+ *****************************************************************************/
+static inline void smpte_sps_init(smpte_sps_t *p_sps, uint64_t *pi_seqnums,
+                                  uint64_t *pi_dates, uint64_t i_nb_slots,
+                                  uint64_t i_window)
+{
+    memset(pi_seqnums, 0, i_nb_slots * sizeof(uint64_t));
+    memset(pi_dates, 0, i_nb_slots * sizeof(uint64_t));
+    p_sps->pi_seqnums = pi_seqnums;
+    p_sps->pi_dates = pi_dates;
+    p_sps->i_mask = i_nb_slots - 1;
+    p_sps->i_window = i_window < i_nb_slots ? i_window : i_nb_slots - 1;
+    p_sps->i_highest = 0;
+}
+
+static inline void smpte_sps_leg_init(smpte_sps_leg_t *p_leg,
+                                      smpte_sps_t *p_sps)
+{
+    memset(p_leg, 0, sizeof(smpte_sps_leg_t));
+    p_leg->p_sps = p_sps;
+}
+
+/* number of packets missing on the leg, as in RFC 3550 */
+static inline uint64_t smpte_sps_leg_get_lost(const smpte_sps_leg_t *p_leg)
+{
+    uint64_t i_expected = p_leg->b_started ?
+                          p_leg->i_highest - p_leg->i_base + 1 : 0;
+    return i_expected > p_leg->i_received ? i_expected - p_leg->i_received : 0;
+}
+
+/* average delay of the leg behind the first one, in the caller's units */
+static inline uint64_t smpte_sps_leg_get_delay(const smpte_sps_leg_t *p_leg)
+{
+    return p_leg->i_delay_count ? p_leg->i_delay_sum / p_leg->i_delay_count : 0;
+}
+
+/*****************************************************************************
+ * smpte_sps_input
+ *****************************************************************************
+ * Returns SMPTE_SPS_FIRST if the packet must be let through, otherwise it
+ * was already received on another leg, or it is outside the skew window.
+ *****************************************************************************/
+static inline int smpte_sps_input(smpte_sps_leg_t *p_leg,
+                                  const uint8_t *p_rtp, uint64_t i_date)
+{
+    smpte_sps_t *p_sps = p_leg->p_sps;
+    uint16_t i_seqnum = rtp_get_seqnum(p_rtp);
+    uint64_t i_highest = __atomic_load_n(&p_sps->i_highest, __ATOMIC_ACQUIRE);
+    uint64_t *pi_slot;
+    uint64_t i_ext, i_old;
+
+    p_leg->i_received++;
+
+    if (!p_leg->b_started) {
+        /* join the other legs */
+        if (!i_highest) {
+            uint64_t i_zero = 0;
+            i_highest = rtp_seqnum_extend(0, i_seqnum);
+            if (!__atomic_compare_exchange_n(&p_sps->i_highest, &i_zero,
+                                             i_highest, false,
+                                             __ATOMIC_ACQ_REL,
+                                             __ATOMIC_ACQUIRE))
+                i_highest = i_zero;
+        }
+        p_leg->i_highest = p_leg->i_base =
+            rtp_seqnum_extend(i_highest, i_seqnum);
+        p_leg->b_started = true;
+    }
+
+    i_ext = rtp_seqnum_extend(p_leg->i_highest, i_seqnum);
+    if (i_ext > p_leg->i_highest)
+        p_leg->i_highest = i_ext;
+    else if (i_ext < p_leg->i_base)
+        p_leg->i_base = i_ext;
+
+    /* i_highest = max(i_highest, i_ext) */
+    while (i_ext > i_highest &&
+           !__atomic_compare_exchange_n(&p_sps->i_highest, &i_highest, i_ext,
+                                        true, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE));
+    if (i_ext > i_highest)
+        i_highest = i_ext;
+
+    if (i_ext + p_sps->i_window < i_highest) {
+        p_leg->i_late++;
+        return SMPTE_SPS_LATE;
+    }
+
+    pi_slot = &p_sps->pi_seqnums[i_ext & p_sps->i_mask];
+    i_old = __atomic_load_n(pi_slot, __ATOMIC_ACQUIRE);
+    do {
+        if (i_old == i_ext) {
+            uint64_t i_first_date =
+                __atomic_load_n(&p_sps->pi_dates[i_ext & p_sps->i_mask],
+                                __ATOMIC_ACQUIRE);
+            p_leg->i_duplicate++;
+            if (i_first_date && i_date >= i_first_date) {
+                uint64_t i_delay = i_date - i_first_date;
+                p_leg->i_delay_sum += i_delay;
+                p_leg->i_delay_count++;
+                if (i_delay > p_leg->i_delay_max)
+                    p_leg->i_delay_max = i_delay;
+            }
+            return SMPTE_SPS_DUPLICATE;
+        }
+        if (i_old > i_ext) {
+            /* slot already reused by a more recent packet */
+            p_leg->i_late++;
+            return SMPTE_SPS_LATE;
+        }
+    } while (!__atomic_compare_exchange_n(pi_slot, &i_old, i_ext, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    /* another leg may still read the date of the previous packet in this
+     * slot in between, which only affects the delay statistics */
+    __atomic_store_n(&p_sps->pi_dates[i_ext & p_sps->i_mask], i_date,
+                     __ATOMIC_RELEASE);
+    p_leg->i_first++;
+    return SMPTE_SPS_FIRST;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -36,6 +36,7 @@
 
 #include <stdint.h>   /* uint8_t, uint16_t, etc... */
 #include <stdbool.h>  /* bool */
+#include <string.h>   /* memcpy */
 
 #ifdef __cplusplus
 extern "C"
@@ -118,11 +119,49 @@ extern "C"
 #define S291_SD_AUDIOCONTROL_GROUP3_DID  0xed
 #define S291_SD_AUDIOCONTROL_GROUP4_DID  0xec
 
+/*****************************************************************************
+ * s291_parity_table
+ *****************************************************************************
+ * Bits 8 (even parity of bits 0-7) and 9 (not bit 8) of each 8-bit value.
+ *****************************************************************************/
+static const uint16_t s291_parity_table[256] = {
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x200, 0x100, 0x100, 0x200, 0x100, 0x200, 0x200, 0x100,
+    0x100, 0x200, 0x200, 0x100, 0x200, 0x100, 0x100, 0x200
+};
+
 static inline uint16_t s291_parity(uint8_t i_val)
 {
-    uint8_t i_parity =
-        (((i_val * 0x0101010101010101ULL) & 0x8040201008040201ULL) % 0x1FF) & 1;
-    return (uint16_t)i_parity << 8 | ((uint16_t)(i_parity ^ 1) << 9);
+    return s291_parity_table[i_val];
 }
 
 static inline void s291_set_did(uint16_t *p_s291, uint8_t i_did)
@@ -163,15 +202,35 @@ static inline uint16_t *s291_get_udw(const uint16_t *p_s291)
     return (uint16_t *)&p_s291[6];
 }
 
-static inline uint16_t s291_compute_cs(const uint16_t *p_s291)
+/* sets the parity bits of all UDWs carrying 8-bit data */
+static inline void s291_set_udw_parity(uint16_t *p_s291)
 {
-    uint16_t i_cs = 0;
+    uint16_t *p_udw = s291_get_udw(p_s291);
     uint8_t i_dc = s291_get_dc(p_s291);
     unsigned int i;
-    for (i = 3; i < i_dc + S291_HEADER_SIZE; i++) {
-        i_cs += p_s291[i] & 0x1ff;
-        i_cs &= 0x1ff;
+    for (i = 0; i < i_dc; i++)
+        p_udw[i] = (p_udw[i] & 0xff) | s291_parity(p_udw[i] & 0xff);
+}
+
+static inline uint16_t s291_compute_cs(const uint16_t *p_s291)
+{
+    /* the sum is modulo 512, so it is truncated once at the end; 4 words
+     * are added at once in 16-bit lanes, which cannot overflow with at
+     * most 65 9-bit words per lane */
+    unsigned int i = 3, i_end = S291_HEADER_SIZE + s291_get_dc(p_s291);
+    uint64_t i_lanes = 0;
+    uint32_t i_sum;
+    uint16_t i_cs;
+    for ( ; i + 4 <= i_end; i += 4) {
+        uint64_t i_words;
+        memcpy(&i_words, p_s291 + i, sizeof(i_words));
+        i_lanes += i_words & UINT64_C(0x01ff01ff01ff01ff);
     }
+    i_sum = (i_lanes & 0xffff) + ((i_lanes >> 16) & 0xffff) +
+            ((i_lanes >> 32) & 0xffff) + (i_lanes >> 48);
+    for ( ; i < i_end; i++)
+        i_sum += p_s291[i] & 0x1ff;
+    i_cs = i_sum & 0x1ff;
     return i_cs | (~i_cs & 0x100) << 1;
 }
 
@@ -186,6 +245,31 @@ static inline bool s291_check_cs(const uint16_t *p_s291)
            s291_compute_cs(p_s291);
 }
 
+/*****************************************************************************
+ * s291_finalize
+ *****************************************************************************
+ * Completes a packet whose DID, SDID (or DBN), DC and UDW only carry 8-bit
+ * values: sets the ADF, the parity bits of all these words and the checksum.
+ *****************************************************************************/
+static inline void s291_finalize(uint16_t *p_s291)
+{
+    unsigned int i, i_end = S291_HEADER_SIZE + (p_s291[5] & 0xff);
+    uint32_t i_sum = 0;
+    uint16_t i_cs;
+
+    p_s291[0] = S291_ADF1;
+    p_s291[1] = S291_ADF2;
+    p_s291[2] = S291_ADF3;
+    for (i = 3; i < i_end; i++) {
+        uint16_t i_word = (p_s291[i] & 0xff) |
+                          s291_parity_table[p_s291[i] & 0xff];
+        p_s291[i] = i_word;
+        i_sum += i_word & 0x1ff;
+    }
+    i_cs = i_sum & 0x1ff;
+    p_s291[i_end] = i_cs | (~i_cs & 0x100) << 1;
+}
+
 #ifdef __cplusplus
 }
 #endif
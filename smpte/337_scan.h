@@ -0,0 +1,286 @@
+/*****************************************************************************
+ * 337_scan.h: SMPTE 337 burst detection in PCM
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+ * Normative references:
+ *  - SMPTE 337
+ *  - SMPTE 338
+ */
+
+/*
+ * The scanner looks for the Pa/Pb sync words of 16, 20 and 24-bit SMPTE 337
+ * bursts in one stereo pair of interleaved PCM, either 32-bit native-endian
+ * left-justified samples (as de-embedded from SDI) or big-endian packed L16
+ * or L24 samples (as carried in AES67 RTP payloads). Pa is expected on the
+ * first channel of the pair and Pb on the second one of the same frame,
+ * followed by Pc and Pd on the next frame, which may be in the next buffer.
+ *
+ * The scanner also follows the interval between bursts, so that the caller
+ * can tell whether a pair currently carries non-PCM data with a stable
+ * cadence, and how many bursts went missing.
+ */
+
+#ifndef __BITSTREAM_SMPTE_337_SCAN_H__
+#define __BITSTREAM_SMPTE_337_SCAN_H__
+
+#include <stdint.h>   /* uint8_t, uint16_t, etc... */
+#include <stdbool.h>  /* bool */
+#include <stddef.h>   /* size_t */
+#include <string.h>   /* memset */
+#include <bitstream/smpte/337.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define S337_SCAN_S32               0
+#define S337_SCAN_L16               2
+#define S337_SCAN_L24               3
+
+/* left-justified sync words */
+#define S337_SCAN_PA_16             UINT32_C(0xf8720000)
+#define S337_SCAN_PB_16             UINT32_C(0x4e1f0000)
+#define S337_SCAN_PA_20             UINT32_C(0x6f872000)
+#define S337_SCAN_PB_20             UINT32_C(0x54e1f000)
+#define S337_SCAN_PA_24             UINT32_C(0x96f87200)
+#define S337_SCAN_PB_24             UINT32_C(0xa54e1f00)
+
+/* frames without burst after which a pair is considered PCM again, when
+ * no cadence has been established */
+#define S337_SCAN_TIMEOUT           8192
+
+typedef struct s337_burst_t {
+    /* position of the frame carrying Pa and Pb, since the beginning */
+    uint64_t i_frame;
+    uint8_t i_mode;
+    uint8_t i_data_type;
+    uint8_t i_data_type_dep;
+    uint8_t i_data_stream;
+    bool b_error;
+    /* Pd, in bits (bytes for some data types) */
+    uint32_t i_length;
+} s337_burst_t;
+
+typedef struct s337_scan_t {
+    /* number of frames already scanned */
+    uint64_t i_frames;
+
+    /* Pa/Pb found on the last frame of the previous buffer */
+    bool b_pending;
+    uint8_t i_pending_mode;
+
+    /* cadence */
+    bool b_seen;
+    uint64_t i_last;
+    uint64_t i_period;
+    unsigned int i_stable;
+    uint8_t i_data_type;
+
+    /* statistics */
+    uint64_t i_bursts;
+    uint64_t i_missed;
+} s337_scan_t;
+
+static inline void s337_scan_init(s337_scan_t *p_scan)
+{
+    memset(p_scan, 0, sizeof(s337_scan_t));
+}
+
+/* returns the sample at position i_index, left-justified */
+static inline uint32_t s337_scan_sample(const uint8_t *p_buffer, size_t i_index,
+                                        int i_format)
+{
+    const uint8_t *p;
+    switch (i_format) {
+        case S337_SCAN_L16:
+            p = p_buffer + 2 * i_index;
+            return ((uint32_t)p[0] << 24) | (p[1] << 16);
+        case S337_SCAN_L24:
+            p = p_buffer + 3 * i_index;
+            return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8);
+        default:
+            return ((const uint32_t *)p_buffer)[i_index];
+    }
+}
+
+/* returns the mode of the sync words, or -1 */
+static inline int s337_scan_sync(uint32_t i_left, uint32_t i_right)
+{
+    if ((i_left & UINT32_C(0xffff0000)) == S337_SCAN_PA_16 &&
+        (i_right & UINT32_C(0xffff0000)) == S337_SCAN_PB_16)
+        return S337_MODE_16;
+    if ((i_left & UINT32_C(0xfffff000)) == S337_SCAN_PA_20 &&
+        (i_right & UINT32_C(0xfffff000)) == S337_SCAN_PB_20)
+        return S337_MODE_20;
+    if ((i_left & UINT32_C(0xffffff00)) == S337_SCAN_PA_24 &&
+        (i_right & UINT32_C(0xffffff00)) == S337_SCAN_PB_24)
+        return S337_MODE_24;
+    return -1;
+}
+
+/* parses Pc/Pd and updates the cadence, returns false if the data mode of
+ * Pc does not match the sync words */
+static inline bool s337_scan_burst(s337_scan_t *p_scan, s337_burst_t *p_burst,
+                                   uint64_t i_frame, uint8_t i_mode,
+                                   uint32_t i_pc, uint32_t i_pd)
+{
+    /* burst_info is the 16 most significant bits of Pc in every mode */
+    uint32_t i_info = i_pc >> 16;
+
+    if (((i_info >> 5) & 0x3) != i_mode)
+        return false;
+
+    p_burst->i_frame = i_frame;
+    p_burst->i_mode = i_mode;
+    p_burst->i_data_type = i_info & 0x1f;
+    p_burst->b_error = !!(i_info & 0x80);
+    p_burst->i_data_type_dep = (i_info >> 8) & 0x1f;
+    p_burst->i_data_stream = (i_info >> 13) & 0x7;
+    p_burst->i_length = i_pd >> (16 - 4 * i_mode);
+
+    if (p_scan->b_seen && p_burst->i_data_type == p_scan->i_data_type) {
+        uint64_t i_period = i_frame - p_scan->i_last;
+        if (p_scan->i_stable && p_scan->i_period &&
+            i_period > p_scan->i_period + p_scan->i_period / 2)
+            p_scan->i_missed += (i_period + p_scan->i_period / 2) /
+                                p_scan->i_period - 1;
+        if (i_period + 1 >= p_scan->i_period && i_period <= p_scan->i_period + 1)
+            /* allow for 1601/1602 sequences at 29.97 Hz */
+            p_scan->i_stable++;
+        else if (!p_scan->i_stable || i_period < p_scan->i_period) {
+            p_scan->i_period = i_period;
+            p_scan->i_stable = 0;
+        }
+    } else {
+        p_scan->i_period = 0;
+        p_scan->i_stable = 0;
+    }
+    p_scan->b_seen = true;
+    p_scan->i_last = i_frame;
+    p_scan->i_data_type = p_burst->i_data_type;
+    p_scan->i_bursts++;
+    return true;
+}
+
+/*****************************************************************************
+ * s337_scan
+ *****************************************************************************
+ * Scans i_nb_frames frames of i_channels interleaved samples in format
+ * i_format, looking at the pair starting at channel i_channel. Stores at
+ * most i_max bursts to p_bursts (further bursts are only accounted for in
+ * the cadence), and returns the number of bursts stored.
+ *****************************************************************************/
+static inline unsigned int s337_scan(s337_scan_t *p_scan,
+                                     const uint8_t *p_buffer,
+                                     size_t i_nb_frames, int i_format,
+                                     unsigned int i_channels,
+                                     unsigned int i_channel,
+                                     s337_burst_t *p_bursts, unsigned int i_max)
+{
+    s337_burst_t burst;
+    unsigned int i_nb = 0;
+    size_t i = 0;
+
+    if (p_scan->b_pending && i_nb_frames) {
+        p_scan->b_pending = false;
+        if (s337_scan_burst(p_scan, &burst, p_scan->i_frames - 1,
+                            p_scan->i_pending_mode,
+                            s337_scan_sample(p_buffer, i_channel, i_format),
+                            s337_scan_sample(p_buffer, i_channel + 1,
+                                             i_format))) {
+            if (i_nb < i_max)
+                p_bursts[i_nb++] = burst;
+            i = 1;
+        }
+    }
+
+    for ( ; i < i_nb_frames; i++) {
+        size_t i_index = i * i_channels + i_channel;
+        uint32_t i_left = s337_scan_sample(p_buffer, i_index, i_format);
+        uint32_t i_right;
+        int i_mode;
+
+        /* the first 16 bits of Pa are never 0, so silence and low-level
+         * audio are rejected by the first comparison */
+        if ((i_left >> 16) != (S337_SCAN_PA_16 >> 16) &&
+            (i_left >> 16) != (S337_SCAN_PA_20 >> 16) &&
+            (i_left >> 16) != (S337_SCAN_PA_24 >> 16))
+            continue;
+        i_right = s337_scan_sample(p_buffer, i_index + 1, i_format);
+        if ((i_mode = s337_scan_sync(i_left, i_right)) < 0)
+            continue;
+
+        if (i + 1 == i_nb_frames) {
+            p_scan->b_pending = true;
+            p_scan->i_pending_mode = i_mode;
+            break;
+        }
+        if (!s337_scan_burst(p_scan, &burst, p_scan->i_frames + i, i_mode,
+                             s337_scan_sample(p_buffer, i_index + i_channels,
+                                              i_format),
+                             s337_scan_sample(p_buffer,
+                                              i_index + i_channels + 1,
+                                              i_format)))
+            continue;
+        if (i_nb < i_max)
+            p_bursts[i_nb++] = burst;
+        i++;
+    }
+
+    p_scan->i_frames += i_nb_frames;
+    return i_nb;
+}
+
+/*****************************************************************************
+ * s337_scan_check_active
+ *****************************************************************************
+ * Returns true if the pair currently carries SMPTE 337 data, that is if a
+ * burst was found within two cadence periods (or S337_SCAN_TIMEOUT frames
+ * before a cadence is established).
+ *****************************************************************************/
+static inline bool s337_scan_check_active(const s337_scan_t *p_scan)
+{
+    uint64_t i_timeout = p_scan->i_stable ? 2 * p_scan->i_period :
+                         S337_SCAN_TIMEOUT;
+    return p_scan->b_seen && p_scan->i_frames - p_scan->i_last <= i_timeout;
+}
+
+/* returns true if bursts come with a constant period (in frames) */
+static inline bool s337_scan_check_locked(const s337_scan_t *p_scan,
+                                          uint64_t *pi_period)
+{
+    if (p_scan->i_stable < 2)
+        return false;
+    if (pi_period != NULL)
+        *pi_period = p_scan->i_period;
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif